@@ -0,0 +1,134 @@
+/*
+ * AckBenchmark.c
+ *
+ * a burst of commands arrives in the simulated receiver and every command is
+ * executed and saves its ACK. runs the receive ACKs and save_ACK as they were
+ * before the ACK pipeline and with the ACK pipeline, and reports the time the
+ * Rx ingest and the commands were held in ACK I/O, the time of the ACK task
+ * and when the last receive ACK left the air. the ACK task runs when the
+ * TRXVU task goes to sleep after the burst, and after the commands.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "../src/sub-systemCode/TRXVU.h"
+#include "../src/sub-systemCode/Global/TLM_management.h"
+#include "../src/sub-systemCode/COMM/Rx_engine.h"
+#include "../src/sub-systemCode/COMM/Tx_scheduler.h"
+#include "../src/sub-systemCode/COMM/Ack_pipeline.h"
+#include "HostStandIns.h"
+
+#define BENCH_FRAME_LENGTH		40		// bytes of a command frame
+#define BENCH_ACK_FILE_NAME		"ACKf"	// ACK_FILE_NAME
+
+xSemaphoreHandle xIsTransmitting;
+
+static const int bursts[] = { 1, 5, 20, 40 };
+
+static Boolean pipeline;
+static command_id next_id;
+
+//the receive ACK part of handle_Rx_frame
+static void handle_frame(byte *frame, unsigned int length)
+{
+	(void)frame;
+	(void)length;
+	if (pipeline)
+	{
+		post_ACK(ACK_RECEIVE_COMM, ERR_SUCCESS, next_id++, ACK_SEND);
+		return;
+	}
+	byte rawACK[ACK_RAW_SIZE];
+	build_raw_ACK(ACK_RECEIVE_COMM, ERR_SUCCESS, next_id++, rawACK);
+	Tx_schedule_frame(rawACK, ACK_RAW_SIZE, trxvu_bitrate_9600, tx_priority_ACK);
+}
+
+//save_ACK as it was before the ACK pipeline
+static void legacy_save_ACK(Ack_type type, ERR_type err, command_id id)
+{
+	byte raw_ACK[ACK_DATA_LENGTH];
+	build_data_field_ACK(type, err, id, raw_ACK);
+	c_fileWrite(BENCH_ACK_FILE_NAME, raw_ACK);
+}
+
+static void run(int commands)
+{
+	HostTx_Stats tx;
+	HostFS_Stats fs;
+	unsigned long long arrival, start, rx_ms, cmd_ms, task_ms = 0;
+	int handled;
+	int flushed = 0;
+
+	HostClock_Advance(60 * 1000);
+	HostTx_Reset();
+	HostRx_Reset();
+	HostFS_Reset();
+	arrival = HostClock_Now();
+	for (int i = 0; i < commands; i++)
+		HostRx_Schedule(arrival, BENCH_FRAME_LENGTH);
+
+	//1. Rx_logic
+	start = HostClock_Now();
+	handled = drain_Rx_frames(handle_frame);
+	if (!pipeline && handled > 0)
+		Tx_flush_frames();
+	rx_ms = HostClock_Now() - start;
+	if (pipeline)
+	{
+		start = HostClock_Now();
+		flushed += flush_ACKs();
+		task_ms += HostClock_Now() - start;
+	}
+
+	//2. the commands, each ends in save_ACK
+	start = HostClock_Now();
+	for (int i = 0; i < commands; i++)
+	{
+		if (pipeline)
+			post_ACK(ACK_THE_MIGHTY_DUMMY_FUNC, ERR_SUCCESS, i, ACK_SAVE);
+		else
+			legacy_save_ACK(ACK_THE_MIGHTY_DUMMY_FUNC, ERR_SUCCESS, i);
+	}
+	cmd_ms = HostClock_Now() - start;
+
+	//3. the ACK task, after the commands
+	if (pipeline)
+	{
+		start = HostClock_Now();
+		flushed += flush_ACKs();
+		task_ms += HostClock_Now() - start;
+		if (flushed != 2 * commands)
+			printf("flush_ACKs took %d of %d ACKs\n", flushed, 2 * commands);
+	}
+
+	HostTx_GetStats(&tx);
+	HostFS_GetStats(&fs);
+	printf("%-12d %-9s %9llu %9.1f %9llu %9u %9llu %11llu\n", commands, pipeline ? "pipeline" : "before",
+			rx_ms, (double)cmd_ms / commands, task_ms, fs.files_opened, fs.ms, tx.last_end - arrival);
+}
+
+int main()
+{
+	vSemaphoreCreateBinary(xIsTransmitting);
+	init_Tx_scheduler();
+	init_Ack_pipeline();
+
+	printf("%-12s %-9s %9s %9s %9s %9s %9s %11s\n", "commands", "", "Rx [ms]", "cmd [ms]", "task [ms]",
+			"SD opens", "SD [ms]", "ACK air [ms]");
+	for (unsigned int i = 0; i < sizeof(bursts) / sizeof(bursts[0]); i++)
+	{
+		pipeline = FALSE;
+		run(bursts[i]);
+		pipeline = TRUE;
+		run(bursts[i]);
+	}
+	printf("\nRx: Rx_logic of the burst, cmd: save_ACK of a command, task: the ACK task,\n"
+			"SD opens and SD: files opened and time of the ACK writes, FRAM included,\n"
+			"ACK air: from the arrival of the burst until the last receive ACK left the air\n");
+	return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * AprsBenchmark.c
+ *
+ * runs the flight APRS.c on the FRAM stand-in of HostGlobal.c. receives APRS
+ * packets until the list is full and one more, reboots, and dumps the list
+ * through the simulated transmitter. reports the FRAM bytes and the estimated
+ * FRAM time of every packet stored and of the dump, and checks every packet
+ * was kept, sent twice with its own data, and the list was empty after.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "../src/sub-systemCode/TRXVU.h"
+#include "../src/sub-systemCode/Global/sizes.h"
+#include "../src/sub-systemCode/COMM/APRS.h"
+#include "../src/sub-systemCode/COMM/GSC.h"
+#include "../src/sub-systemCode/COMM/Tx_scheduler.h"
+#include "HostStandIns.h"
+
+#define BENCH_PACKET_MS		2000	// between two APRS packets from the ground
+
+xSemaphoreHandle xIsTransmitting;
+
+//packets sent of every slot of the list, and sent with data of no slot
+static unsigned int sent[MAX_NAMBER_OF_APRS_PACKETS];
+static unsigned int sent_wrong;
+
+static void make_packet(unsigned int i, byte* packet)
+{
+	memset(packet, 0, APRS_SIZE_WITH_TIME);
+	packet[0] = '!';
+	snprintf((char*)packet + 1, APRS_SIZE_WITHOUT_TIME - 1, "4XZ-%02u", i);
+}
+
+static void capture(unsigned char* data, unsigned char length)
+{
+	byte packet[APRS_SIZE_WITH_TIME];
+	if (length != SPL_TM_HEADER_SIZE + APRS_SIZE_WITH_TIME)
+	{
+		sent_wrong++;
+		return;
+	}
+	for (unsigned int i = 0; i < MAX_NAMBER_OF_APRS_PACKETS; i++)
+	{
+		make_packet(i, packet);
+		//the time stamp of check_APRS is after the packet
+		if (memcmp(SPL_TM_DATA(data), packet, APRS_SIZE_WITHOUT_TIME) == 0)
+		{
+			sent[i]++;
+			return;
+		}
+	}
+	sent_wrong++;
+}
+
+static void print_result(const char* title, unsigned int count, const HostFRAM_Stats* stats)
+{
+	printf("%-24s %6u %10.1f %10.1f %10.1f %8.1f\n", title, count,
+			count > 0 ? (double)stats->bytes_written / count : 0,
+			count > 0 ? (double)stats->bytes_read / count : 0,
+			count > 0 ? HostFRAM_EstimateLatency(stats) / count : 0,
+			count > 0 ? (double)(stats->reads + stats->writes) / count : 0);
+}
+
+int main()
+{
+	byte packet[APRS_SIZE_WITH_TIME];
+	HostFRAM_Stats stats;
+	HostTx_Stats tx_stats;
+	unsigned int not_aprs = 0;
+
+	vSemaphoreCreateBinary(xIsTransmitting);
+	init_Tx_scheduler();
+	HostTx_SetCapture(capture);
+
+	printf("%-24s %6s %10s %10s %10s %8s\n", "", "count", "FRAM W B", "FRAM R B", "FRAM us", "access");
+	HostFRAM_ResetStats();
+	reset_APRS_list(TRUE);
+	HostFRAM_GetStats(&stats);
+	print_result("reset", 1, &stats);
+
+	//data that isn't APRS costs nothing
+	HostFRAM_ResetStats();
+	memset(packet, 'x', sizeof(packet));
+	not_aprs = check_APRS(packet) == 0;
+	HostFRAM_GetStats(&stats);
+	print_result("ordinary data", 1, &stats);
+
+	HostFRAM_ResetStats();
+	for (unsigned int i = 0; i < MAX_NAMBER_OF_APRS_PACKETS; i++)
+	{
+		make_packet(i, packet);
+		check_APRS(packet);
+		HostClock_Advance(BENCH_PACKET_MS);
+	}
+	HostFRAM_GetStats(&stats);
+	print_result("store", MAX_NAMBER_OF_APRS_PACKETS, &stats);
+
+	HostFRAM_ResetStats();
+	make_packet(MAX_NAMBER_OF_APRS_PACKETS, packet);
+	check_APRS(packet);
+	HostFRAM_GetStats(&stats);
+	print_result("store to a full list", 1, &stats);
+
+	//after a reboot the count comes back from the FRAM
+	set_numOfAPRS(0);
+	HostFRAM_ResetStats();
+	get_APRS_list();
+	HostFRAM_GetStats(&stats);
+	print_result("boot", 1, &stats);
+	unsigned int kept = get_numOfAPRS();
+
+	HostTx_Reset();
+	HostFRAM_ResetStats();
+	send_APRS_Dump();
+	HostFRAM_GetStats(&stats);
+	print_result("dump", 1, &stats);
+	HostTx_GetStats(&tx_stats);
+
+	unsigned int sent_twice = 0;
+	for (unsigned int i = 0; i < MAX_NAMBER_OF_APRS_PACKETS; i++)
+		sent_twice += sent[i] == 2;
+	printf("\nordinary data %s, %u of %d packets kept after the reboot, %u frames sent, %u packets\n"
+			"sent twice, %u frames of no packet, %u packets in the list after the dump\n",
+			not_aprs ? "passed on" : "NOT passed on", kept, MAX_NAMBER_OF_APRS_PACKETS, tx_stats.frames,
+			sent_twice, sent_wrong, get_numOfAPRS());
+	printf("\nFRAM W B, R B, us and access: per packet, or per reset, boot and dump.\n"
+			"FRAM us: estimate at %d Hz SPI, %d us and %d command bytes for every access\n",
+			HOST_FRAM_SPI_CLOCK, HOST_FRAM_TRANSACTION_US, HOST_FRAM_COMMAND_SIZE);
+	return not_aprs && kept == MAX_NAMBER_OF_APRS_PACKETS && sent_twice == MAX_NAMBER_OF_APRS_PACKETS
+			&& sent_wrong == 0 && get_numOfAPRS() == 0 ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+/*
+ * ArbiterBenchmark.c
+ *
+ * a dump through the pipeline while Beacon_task sends a beacon every 20
+ * seconds, every third in 1200, and the ACK task a burst of receive ACKs every
+ * 7 seconds, with or without APRS frames in 1200, and reports how long the
+ * beacons and ACKs waited from the time they were scheduled until they went on
+ * the air, the link use of the dump and the bitrate changes.
+ * the host runs one task, the beacons and ACKs are posted from the frame source
+ * of the dump at their time and the Tx task is woken by Tx_arbitrate.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "../src/sub-systemCode/TRXVU.h"
+#include "../src/sub-systemCode/COMM/Dump_pipeline.h"
+#include "../src/sub-systemCode/COMM/Tx_scheduler.h"
+#include "HostStandIns.h"
+
+#define BENCH_DUMP_FRAMES		1500
+#define BENCH_BEACON_PERIOD_MS	(20 * 1000)		// DEFULT_BEACON_DELAY
+#define BENCH_ACK_PERIOD_MS		(7 * 1000)
+#define BENCH_ACKS_IN_BURST		5
+#define BENCH_APRS_SIZE			60
+#define BENCH_BEACON_SIZE		(BEACON_LENGTH + SPL_TM_HEADER_SIZE)
+#define BENCH_MAX_POSTED		1024			// beacons or ACKs of a dump
+
+xSemaphoreHandle xIsTransmitting;
+
+typedef struct
+{
+	const char* title;
+	uint8_t dump_length;	// of every frame of the dump
+	unsigned int APRS_period_ms;	// of the APRS frames in 1200, 0 for none
+} bench_scenario;
+
+static const bench_scenario scenarios[] =
+{
+	{ "dump of 70 B frames", 70, 0 },
+	{ "dump of 235 B frames", SIZE_TXFRAME, 0 },
+	{ "70 B frames + APRS", 70, 2000 },
+};
+
+//the frames are told apart by their first byte, the frames of the beacons and ACKs are numbered after it
+enum { BENCH_ACK, BENCH_BEACON, BENCH_APRS, BENCH_NUM_OF_POSTED };
+static const byte tags[BENCH_NUM_OF_POSTED] = { 'A', 'B', 'P' };
+
+typedef struct
+{
+	unsigned int count;
+	unsigned long long sum;
+	unsigned long long max;
+} bench_latency;
+
+static unsigned long long posted_at[BENCH_NUM_OF_POSTED][BENCH_MAX_POSTED];
+static bench_latency latency[BENCH_NUM_OF_POSTED];
+
+typedef struct
+{
+	const bench_scenario* scenario;
+	unsigned int next;
+	unsigned int posted[BENCH_NUM_OF_POSTED];
+	unsigned long long next_beacon;
+	unsigned long long next_ACKs;
+	unsigned long long next_APRS;
+} bench_source;
+
+static void capture(unsigned char* data, unsigned char length)
+{
+	HostTx_Stats stats;
+	int kind;
+	for (kind = 0; kind < BENCH_NUM_OF_POSTED && data[0] != tags[kind]; kind++);
+	if (kind == BENCH_NUM_OF_POSTED)
+		return;
+	unsigned int number = ((unsigned int)data[1] << 8) | data[2];
+	if (number >= BENCH_MAX_POSTED)
+		return;
+	//the frame starts after the frames before it in the buffer, it ends at the last end
+	HostTx_GetStats(&stats);
+	unsigned long long start = stats.last_end - IsisTrxvu_tcEstimateTransmissionTime(0, length);
+	unsigned long long waited = start - posted_at[kind][number];
+	latency[kind].count++;
+	latency[kind].sum += waited;
+	if (waited > latency[kind].max)
+		latency[kind].max = waited;
+}
+
+static void post(bench_source* source, int kind, uint8_t length, ISIStrxvuBitrate bitrate, tx_priority priority)
+{
+	byte frame[SIZE_TXFRAME];
+	unsigned int number = source->posted[kind]++;
+	memset(frame, 0, sizeof(frame));
+	frame[0] = tags[kind];
+	frame[1] = (byte)(number >> 8);
+	frame[2] = (byte)number;
+	if (number < BENCH_MAX_POSTED)
+		posted_at[kind][number] = HostClock_Now();
+	Tx_schedule_frame(frame, length, bitrate, priority);
+}
+
+//the beacons, ACKs and APRS frames that are due, as Beacon_task, the ACK task and APRS send them
+static void post_due(bench_source* source)
+{
+	unsigned long long now = HostClock_Now();
+	if (now >= source->next_beacon)
+	{
+		post(source, BENCH_BEACON, BENCH_BEACON_SIZE,
+				source->posted[BENCH_BEACON] % 3 == 0 ? trxvu_bitrate_1200 : trxvu_bitrate_9600, tx_priority_beacon);
+		Tx_arbitrate();
+		source->next_beacon += BENCH_BEACON_PERIOD_MS;
+	}
+	if (now >= source->next_ACKs)
+	{
+		for (int i = 0; i < BENCH_ACKS_IN_BURST; i++)
+			post(source, BENCH_ACK, ACK_RAW_SIZE, trxvu_bitrate_9600, tx_priority_ACK);
+		Tx_arbitrate();
+		source->next_ACKs += BENCH_ACK_PERIOD_MS;
+	}
+	if (source->scenario->APRS_period_ms > 0 && now >= source->next_APRS)
+	{
+		post(source, BENCH_APRS, BENCH_APRS_SIZE, trxvu_bitrate_1200, tx_priority_APRS);
+		Tx_arbitrate();
+		source->next_APRS += source->scenario->APRS_period_ms;
+	}
+}
+
+static int bench_frame_source(void *context, byte *frame, uint8_t *length)
+{
+	bench_source* source = (bench_source*)context;
+	post_due(source);
+	if (source->next >= BENCH_DUMP_FRAMES)
+		return 0;
+	memset(frame, 0, source->scenario->dump_length);
+	frame[0] = 'D';
+	*length = source->scenario->dump_length;
+	source->next++;
+	return 1;
+}
+
+static void run(const bench_scenario* scenario)
+{
+	static dump_pipeline pipe;
+	bench_source source;
+	HostTx_Stats stats;
+
+	memset(latency, 0, sizeof(latency));
+	memset(&source, 0, sizeof(source));
+	source.scenario = scenario;
+	unsigned long long start = HostClock_Now();
+	source.next_beacon = start + BENCH_BEACON_PERIOD_MS / 2;
+	source.next_ACKs = start + BENCH_ACK_PERIOD_MS / 2;
+	source.next_APRS = start + scenario->APRS_period_ms / 2;
+
+	init_dump_pipeline(&pipe, bench_frame_source, &source, NULL);
+	int result = run_dump_pipeline(&pipe);
+	if (result != 0)
+		printf("run_dump_pipeline returned %d\n", result);
+
+	HostTx_GetStats(&stats);
+	unsigned long long on_air = stats.last_end - stats.first_start;
+	printf("%-22s %7u %8.1f %8.1f%% %9u %8.0f %8llu %9u %8.0f %8llu %6u\n", scenario->title,
+			BENCH_DUMP_FRAMES, (stats.last_end - start) / 1000.0,
+			on_air > 0 ? 100.0 * stats.busy_ms / on_air : 0,
+			latency[BENCH_BEACON].count,
+			latency[BENCH_BEACON].count > 0 ? (double)latency[BENCH_BEACON].sum / latency[BENCH_BEACON].count : 0,
+			latency[BENCH_BEACON].max,
+			latency[BENCH_ACK].count,
+			latency[BENCH_ACK].count > 0 ? (double)latency[BENCH_ACK].sum / latency[BENCH_ACK].count : 0,
+			latency[BENCH_ACK].max, stats.bitrate_sets);
+}
+
+int main()
+{
+	vSemaphoreCreateBinary(xIsTransmitting);
+	init_Tx_scheduler();
+	HostTx_SetCapture(capture);
+
+	printf("%-22s %7s %8s %9s %9s %8s %8s %9s %8s %8s %6s\n", "", "dump", "time [s]", "link use",
+			"beacons", "mean", "max [ms]", "ACKs", "mean", "max [ms]", "rates");
+	for (unsigned int i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+	{
+		HostClock_Advance(60 * 1000);
+		Tx_set_bitrate(trxvu_bitrate_9600);
+		HostTx_Reset();
+		run(&scenarios[i]);
+	}
+	printf("\ndump: data frames of the dump, time: from the dump start to the last frame, link use: time\n"
+			"on the air over the time from the first frame to the last, mean and max: ms from the time a\n"
+			"beacon or ACK was scheduled until it went on the air, rates: IsisTrxvu_tcSetAx25Bitrate calls\n");
+	return 0;
+}
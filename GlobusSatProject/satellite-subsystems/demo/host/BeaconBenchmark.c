@@ -0,0 +1,168 @@
+/*
+ * BeaconBenchmark.c
+ *
+ * a day of orbits with a simulated battery, charging in the sun and
+ * discharging in the eclipse, and four passes above ground. runs the delay of
+ * Beacon_task as it was before the beacon scheduler and Beacon_next_delay,
+ * and reports the beacons in the passes, the beacons and the air time below
+ * the low voltage, and the FRAM reads.
+ */
+
+#include <stdio.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <hal/Storage/FRAM.h>
+
+#include "../src/sub-systemCode/TRXVU.h"
+#include "../src/sub-systemCode/Global/FRAMadress.h"
+#include "../src/sub-systemCode/Global/GlobalParam.h"
+#include "../src/sub-systemCode/COMM/Beacon_scheduler.h"
+#include "HostStandIns.h"
+
+#define BENCH_DAY_MS			(24 * 60 * 60 * 1000ULL)
+#define BENCH_ORBIT_MS			(95 * 60 * 1000ULL)
+#define BENCH_SUN_MS			(60 * 60 * 1000ULL)		// the rest of the orbit is eclipse
+#define BENCH_PASS_MS			(10 * 60 * 1000ULL)
+#define BENCH_PASS_OFFSET_MS	(20 * 60 * 1000ULL)		// from the start of the orbit
+#define BENCH_FIRST_CMD_MS		(60 * 1000ULL)			// from the start of the pass until the ground station is heard
+#define BENCH_NOISE_MV			30						// Vbatt samples are off by up to this
+#define BENCH_LOW_V				7250					// DEFULT_COMM_VOL
+#define BENCH_LOW_DELAY			GET_BEACON_DELAY_LOW_VOLTAGE(CONVERT_SECONDS_TO_MS(DEFULT_BEACON_DELAY))
+#define BENCH_BEACON_BYTES		(BEACON_LENGTH + SPL_TM_HEADER_SIZE + 20)	// frame, AX.25 included
+
+typedef struct
+{
+	const char* title;
+	voltage_t min_v;		// Vbatt at the end of the eclipse
+	voltage_t max_v;		// Vbatt at the end of the sun
+} bench_scenario;
+
+static const bench_scenario scenarios[] =
+{
+	{ "healthy battery", 7600, 8100 },
+	{ "degraded battery", 7150, 7700 },
+};
+
+static const int pass_orbits[] = { 1, 2, 8, 9 };
+
+typedef struct
+{
+	unsigned int beacons;
+	unsigned int in_pass;
+	unsigned int below_low;		// beacons sent while the battery was below the low voltage
+	double air_s;
+	double air_below_low_s;
+	unsigned int delay_changes;	// changes between the low voltage delay and the others
+} bench_stats;
+
+static unsigned int noise_state = 1;
+
+static int noise()
+{
+	noise_state = noise_state * 1103515245 + 12345;
+	return (int)((noise_state >> 16) % (2 * BENCH_NOISE_MV + 1)) - BENCH_NOISE_MV;
+}
+
+static voltage_t battery(const bench_scenario* scenario, unsigned long long t)
+{
+	unsigned long long in_orbit = t % BENCH_ORBIT_MS;
+	int range = scenario->max_v - scenario->min_v;
+	if (in_orbit < BENCH_SUN_MS)
+		return (voltage_t)(scenario->min_v + range * in_orbit / BENCH_SUN_MS);
+	return (voltage_t)(scenario->max_v - range * (in_orbit - BENCH_SUN_MS) / (BENCH_ORBIT_MS - BENCH_SUN_MS));
+}
+
+//the ground station is heard from its first command to the end of the pass
+static Boolean in_pass(unsigned long long t, Boolean heard)
+{
+	for (unsigned int i = 0; i < sizeof(pass_orbits) / sizeof(pass_orbits[0]); i++)
+	{
+		unsigned long long start = pass_orbits[i] * BENCH_ORBIT_MS + BENCH_PASS_OFFSET_MS + (heard ? BENCH_FIRST_CMD_MS : 0);
+		unsigned long long end = pass_orbits[i] * BENCH_ORBIT_MS + BENCH_PASS_OFFSET_MS + BENCH_PASS_MS;
+		if (start <= t && t < end)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+//the delay of Beacon_task as it was before the beacon scheduler
+static portTickType legacy_delay()
+{
+	uint8_t delayBaecon = DEFULT_BEACON_DELAY;
+	voltage_t low_v_beacon;
+	FRAM_read(&delayBaecon, BEACON_TIME_ADDR, 1);
+	if (!(10 <= delayBaecon || delayBaecon <= 40))
+	{
+		delayBaecon = DEFULT_BEACON_DELAY;
+	}
+	FRAM_read((byte*)&low_v_beacon, BEACON_LOW_BATTERY_STATE_ADDR, 2);
+	portTickType delay = CONVERT_SECONDS_TO_MS(delayBaecon);
+	if (low_v_beacon > get_Vbatt())
+	{
+		delay = GET_BEACON_DELAY_LOW_VOLTAGE(delay);
+	}
+	return delay;
+}
+
+static void run(const bench_scenario* scenario, Boolean scheduler)
+{
+	bench_stats stats = { 0 };
+	unsigned long long start = HostClock_Now();
+	unsigned int reads = HostFRAM_Reads();
+	int beacon_count = 0;
+	portTickType last_delay = 0;
+
+	noise_state = 1;
+	Beacon_params_changed();
+	while (HostClock_Now() - start < BENCH_DAY_MS)
+	{
+		unsigned long long t = HostClock_Now() - start;
+		voltage_t vbatt = battery(scenario, t);
+		HostVbatt_Set((unsigned short)(vbatt + noise()));
+		set_ground_conn(in_pass(t, TRUE));
+
+		//the beacon, every third in 1200
+		double air = BENCH_BEACON_BYTES * 8.0 / (beacon_count % 3 == 0 ? 1200 : 9600);
+		stats.beacons++;
+		stats.air_s += air;
+		if (in_pass(t, FALSE))
+			stats.in_pass++;
+		if (vbatt < BENCH_LOW_V)
+		{
+			stats.below_low++;
+			stats.air_below_low_s += air;
+		}
+		beacon_count++;
+
+		portTickType delay = scheduler ? Beacon_next_delay() : legacy_delay();
+		if (last_delay != 0 && (delay >= BENCH_LOW_DELAY) != (last_delay >= BENCH_LOW_DELAY))
+			stats.delay_changes++;
+		last_delay = delay;
+		vTaskDelay(delay);
+	}
+	printf("%-18s %-9s %8u %8u %9u %8.1f %10.1f %9u %8u\n", scenario->title, scheduler ? "scheduler" : "before",
+			stats.beacons, stats.in_pass, stats.below_low, stats.air_s, stats.air_below_low_s,
+			stats.delay_changes, HostFRAM_Reads() - reads);
+}
+
+int main()
+{
+	uint8_t delay = DEFULT_BEACON_DELAY;
+	voltage_t low_v = BENCH_LOW_V;
+	FRAM_write(&delay, BEACON_TIME_ADDR, 1);
+	FRAM_write((byte*)&low_v, BEACON_LOW_BATTERY_STATE_ADDR, 2);
+
+	printf("%-18s %-9s %8s %8s %9s %8s %10s %9s %8s\n", "", "", "beacons", "in pass", "below low",
+			"air [s]", "air low [s]", "low flips", "FRAM rd");
+	for (unsigned int i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+	{
+		run(&scenarios[i], FALSE);
+		run(&scenarios[i], TRUE);
+	}
+	printf("\nin pass: beacons sent in the passes above ground, below low: beacons sent with Vbatt below\n"
+			"the low voltage, air: time on the air of the beacons, air low: of them below the low voltage,\n"
+			"low flips: changes between the low voltage delay and the others\n");
+	return 0;
+}
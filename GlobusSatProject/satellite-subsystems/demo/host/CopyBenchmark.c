@@ -0,0 +1,173 @@
+/*
+ * CopyBenchmark.c
+ *
+ * counts the bytes memcpy moves to build a frame, with the TM_spl packets
+ * passed by value as the dumps, ACKs and beacons did before the in place spl
+ * headers, and with the headers written in the frame. built with block moves
+ * as library calls and memcpy wrapped, so copies of structs count too.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/sub-systemCode/COMM/GSC.h"
+#include "../src/sub-systemCode/COMM/splTypes.h"
+#include "HostStandIns.h"
+
+#define BENCH_FRAMES	100000
+
+void* __real_memcpy(void* dest, const void* src, size_t n);
+
+static unsigned long long copied = 0;
+
+void* __wrap_memcpy(void* dest, const void* src, size_t n)
+{
+	copied += n;
+	return __real_memcpy(dest, src, n);
+}
+
+typedef struct
+{
+	const char* title;
+	unsigned short record_size;
+	int packed;			// records in a packed frame, 0 for a packet of every record
+} bench_scenario;
+
+static const bench_scenario scenarios[] =
+{
+	{ "COMM HK dump", 12, 0 },
+	{ "EPS HK dump", 49, 0 },
+	{ "CAM HK dump", 62, 0 },
+	{ "COMM HK packed", 12, 15 },
+	{ "ACK", ACK_DATA_LENGTH, 0 },
+};
+
+static byte raw_record[SIZE_TXFRAME];
+
+//the byte order conversion of an HK element, the same before and after
+static void convert(const byte* raw_in, byte* raw_out, unsigned short length)
+{
+	for (int i = 0; i < length; i++)
+		raw_out[i] = raw_in[length - 1 - i];
+}
+
+//build_HK_spl_packet and encode_TMpacket as they were before
+static int legacy_frame(const bench_scenario* scenario, unsigned int time, byte* frame)
+{
+	TM_spl packet;
+	int size;
+	packet.type = DUMP_T;
+	packet.subType = COMM_DUMP_ST;
+	packet.length = scenario->record_size;
+	packet.time = time;
+	convert(raw_record, packet.data, packet.length);
+	encode_TMpacket(frame, &size, packet);
+	return size;
+}
+
+//init_packed_TMpacket and add_to_packed_TMpacket as they were before the in place packed frames
+static int legacy_packed_frame(const bench_scenario* scenario, unsigned int time, byte* frame)
+{
+	TM_spl packed, record;
+	int size;
+	packed.type = DUMP_T;
+	packed.subType = PACKED_DUMP_ST;
+	packed.time = time;
+	packed.length = PACKED_TM_HEADER_SIZE;
+	packed.data[0] = DUMP_T;
+	packed.data[1] = COMM_DUMP_ST;
+	packed.data[2] = (byte)scenario->record_size;
+	packed.data[3] = 0;
+	for (int i = 0; i < scenario->packed; i++)
+	{
+		record.type = DUMP_T;
+		record.subType = COMM_DUMP_ST;
+		record.length = scenario->record_size;
+		record.time = time + i;
+		convert(raw_record, record.data, record.length);
+		unsigned short offset = (unsigned short)(record.time - packed.time);
+		packed.data[packed.length] = (byte)(offset >> 8);
+		packed.data[packed.length + 1] = (byte)offset;
+		memcpy(packed.data + packed.length + PACKED_TM_OFFSET_SIZE, record.data, record.length);
+		packed.length += PACKED_TM_OFFSET_SIZE + record.length;
+		packed.data[3]++;
+	}
+	encode_TMpacket(frame, &size, packed);
+	return size;
+}
+
+//build_raw_ACK as it was before
+static int legacy_ACK(unsigned int time, byte* frame)
+{
+	TM_spl spl;
+	int size;
+	spl.type = ACK_TYPE;
+	spl.subType = ACK_ST;
+	spl.length = ACK_DATA_LENGTH;
+	spl.time = time;
+	build_data_field_ACK(ACK_DUMP, ERR_SUCCESS, time, spl.data);
+	encode_TMpacket(frame, &size, spl);
+	return size;
+}
+
+static int in_place_frame(const bench_scenario* scenario, unsigned int time, byte* frame)
+{
+	TM_spl_header header = { DUMP_T, COMM_DUMP_ST, scenario->record_size, time };
+	int size;
+	if (scenario->packed == 0)
+	{
+		write_TM_header(frame, &header, &size);
+		convert(raw_record, SPL_TM_DATA(frame), header.length);
+		return size;
+	}
+	init_packed_TMframe(frame, &header);
+	for (int i = 0; i < scenario->packed; i++)
+	{
+		header.time = time + i;
+		convert(raw_record, add_to_packed_TMframe(frame, &header), header.length);
+	}
+	read_TM_header(frame, &header);
+	return header.length + SPL_TM_HEADER_SIZE;
+}
+
+static void run(const bench_scenario* scenario, int in_place)
+{
+	static byte frames[16][SIZE_TXFRAME];
+	struct timespec start, end;
+	unsigned long long bytes = 0;
+	copied = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (unsigned int i = 0; i < BENCH_FRAMES; i++)
+	{
+		byte* frame = frames[i % 16];
+		if (scenario->record_size == ACK_DATA_LENGTH && scenario->packed == 0 && scenario == &scenarios[4])
+			bytes += in_place ? (build_raw_ACK(ACK_DUMP, ERR_SUCCESS, i, frame), ACK_RAW_SIZE) : legacy_ACK(i, frame);
+		else if (in_place)
+			bytes += in_place_frame(scenario, i, frame);
+		else if (scenario->packed > 0)
+			bytes += legacy_packed_frame(scenario, i, frame);
+		else
+			bytes += legacy_frame(scenario, i, frame);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+	printf("%-16s %-9s %9.1f %11.1f %9.2f %9.1f\n", scenario->title, in_place ? "in place" : "before",
+			(double)bytes / BENCH_FRAMES, (double)copied / BENCH_FRAMES, (double)copied / bytes, ns / BENCH_FRAMES);
+}
+
+int main()
+{
+	for (unsigned int i = 0; i < sizeof(raw_record); i++)
+		raw_record[i] = (byte)i;
+
+	printf("%-16s %-9s %9s %11s %9s %9s\n", "", "", "frame [B]", "copied [B]", "copy/B", "ns/frame");
+	for (unsigned int i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+	{
+		run(&scenarios[i], 0);
+		run(&scenarios[i], 1);
+	}
+	printf("\ncopied: bytes memcpy moved for a frame, struct copies included,\n"
+			"besides the byte order conversion and the header, which are the same\n");
+	return 0;
+}
@@ -0,0 +1,300 @@
+/*
+ * DelayBenchmark.c
+ *
+ * fills the delayed command list with commands at random times of the next
+ * day, then runs the check of the TRXVU task every RX_POLL_DELAY_IDLE for the
+ * day and reports the time and FRAM reads of a check, the FRAM bytes written
+ * for every command added and executed, and checks the commands were executed
+ * in the order of their times, each at its time. then cuts the power of the
+ * FRAM after every byte of a change of the list, and checks the list after the
+ * reset is the list before the change or after it. last, adds commands of a
+ * data length until the list is full, and reports how many it holds.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/sub-systemCode/COMM/DelayedCommand_list.h"
+#include "../src/sub-systemCode/COMM/Rx_engine.h"
+#include "../src/sub-systemCode/Main/commands.h"
+#include "HostStandIns.h"
+
+#define BENCH_DAY_S			(24 * 60 * 60)
+#define BENCH_DATA_LENGTH	8		// data bytes of a command
+
+#define BENCH_MAX_CUTS		256		// resets in a change of the list, spread over its bytes
+#define BENCH_CRASH_COMMANDS	20		// in the list when the power is cut
+
+static const int scenarios[] = { 10, 50, MAX_NUMBER_OF_DELAY_COMMAND };
+static const int data_lengths[] = { 0, BENCH_DATA_LENGTH, 64, SIZE_OF_DELAYED_COMMAND - SPL_TC_HEADER_SIZE };
+
+typedef enum
+{
+	CHANGE_ADD,
+	CHANGE_ADD_FULL,	// the latest command is deleted for the new one
+	CHANGE_EXECUTE
+} bench_change;
+
+typedef struct
+{
+	const char* title;
+	bench_change change;
+	int num_of_commands;
+} crash_scenario;
+
+static const crash_scenario crash_scenarios[] =
+{
+	{ "add", CHANGE_ADD, BENCH_CRASH_COMMANDS },
+	{ "add to a full list", CHANGE_ADD_FULL, MAX_NUMBER_OF_DELAY_COMMAND },
+	{ "execute", CHANGE_EXECUTE, BENCH_CRASH_COMMANDS },
+};
+
+//the command queue of the main task, every command is taken out when it is added
+static TC_spl executed;
+static unsigned int num_executed;
+static unsigned int wrong;		// executed before the command before it, or not at its time
+static time_unix last_time;
+
+//while recording, the ids of the executed commands after a reset
+static Boolean recording = FALSE;
+static command_id recorded[MAX_NUMBER_OF_DELAY_COMMAND + 1];
+static int num_recorded;
+static Boolean corrupted;		// a command with data that isn't its own
+
+static unsigned int random_state = 1;
+
+static unsigned int next_random()
+{
+	random_state = random_state * 1103515245 + 12345;
+	return random_state >> 16;
+}
+
+static double now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+TC_spl* reserve_command()
+{
+	return &executed;
+}
+
+void commit_command()
+{
+	time_unix time_now;
+	if (recording)
+	{
+		for (int i = 0; i < executed.length; i++)
+			if (executed.data[i] != (byte)(executed.id + i))
+				corrupted = TRUE;
+		if (num_recorded <= MAX_NUMBER_OF_DELAY_COMMAND)
+			recorded[num_recorded++] = executed.id;
+		return;
+	}
+	Time_getUnixEpoch(&time_now);
+	//the id of a command is its time
+	if (executed.time < last_time || executed.time > time_now || time_now - executed.time > 1 || executed.id != executed.time)
+		wrong++;
+	last_time = executed.time;
+	num_executed++;
+}
+
+//a command with its time as its id, and data of its id
+static void add(time_unix time, int length)
+{
+	TC_spl command;
+	memset(&command, 0, sizeof(command));
+	command.time = time;
+	command.id = time;
+	command.type = 1;
+	command.subType = 1;
+	command.length = length;
+	for (int i = 0; i < length; i++)
+		command.data[i] = (byte)(command.id + i);
+	add_delayCommand(command);
+}
+
+static void run(int num_of_commands)
+{
+	time_unix start;
+	double ns = 0;
+	unsigned int checks = 0;
+
+	reset_delayCommand(TRUE);
+	get_delayCommand_list();
+	num_executed = 0;
+	wrong = 0;
+	last_time = 0;
+	Time_getUnixEpoch(&start);
+
+	// 1. the commands, at random times of the next day
+	unsigned int written = HostFRAM_Written();
+	for (int i = 0; i < num_of_commands; i++)
+		add(start + 60 + next_random() % (BENCH_DAY_S - 120), BENCH_DATA_LENGTH);
+	unsigned int add_written = HostFRAM_Written() - written;
+
+	// 2. the day of the TRXVU task
+	written = HostFRAM_Written();
+	unsigned int reads = HostFRAM_Reads();
+	for (unsigned long long t = 0; t < BENCH_DAY_S * 1000ULL; t += RX_POLL_DELAY_IDLE)
+	{
+		double before = now_ns();
+		check_delaycommand();
+		ns += now_ns() - before;
+		checks++;
+		HostClock_Advance(RX_POLL_DELAY_IDLE);
+	}
+
+	printf("%8d %10.0f %9.3f %12u %12u %9u %6u\n", num_of_commands, ns / checks,
+			(double)(HostFRAM_Reads() - reads) / checks,
+			add_written / num_of_commands,
+			num_executed > 0 ? (HostFRAM_Written() - written) / num_executed : 0,
+			num_executed, wrong);
+}
+
+static int compare_ids(const void* a, const void* b)
+{
+	command_id x = *(const command_id*)a, y = *(const command_id*)b;
+	return x < y ? -1 : x > y;
+}
+
+//a list of commands 2 seconds apart from a minute from now, returns the time of the first.
+//the ids are the seconds of the commands after the first
+static time_unix fill_list(int num_of_commands, command_id ids[])
+{
+	time_unix start;
+	reset_delayCommand(TRUE);
+	get_delayCommand_list();
+	Time_getUnixEpoch(&start);
+	for (int i = 0; i < num_of_commands; i++)
+	{
+		ids[i] = 2 * i;
+		add(start + 60 + ids[i], BENCH_DATA_LENGTH);
+	}
+	return start + 60;
+}
+
+//the change, the power of the FRAM may be cut in it
+static void make_change(const crash_scenario* scenario, time_unix first)
+{
+	if (scenario->change == CHANGE_EXECUTE)
+	{
+		time_unix now;
+		Time_getUnixEpoch(&now);
+		HostClock_Advance((first - now) * 1000ULL);
+		check_delaycommand();
+	}
+	else
+	{
+		add(first + 1, BENCH_DATA_LENGTH);
+	}
+}
+
+//the ids of the list after a reset, sorted, in seconds after the first command. 'last' is the time of the last
+static int list_after_reset(time_unix first, time_unix last)
+{
+	time_unix now;
+	get_delayCommand_list();
+	Time_getUnixEpoch(&now);
+	HostClock_Advance((last - now) * 1000ULL);
+	recording = TRUE;
+	num_recorded = 0;
+	check_delaycommand();
+	recording = FALSE;
+	for (int i = 0; i < num_recorded; i++)
+		recorded[i] -= first;
+	qsort(recorded, num_recorded, sizeof(command_id), compare_ids);
+	return num_recorded;
+}
+
+static Boolean same_list(const command_id ids[], int count, int num_recorded)
+{
+	return count == num_recorded && memcmp(ids, recorded, count * sizeof(command_id)) == 0;
+}
+
+static void run_crash(const crash_scenario* scenario)
+{
+	command_id before[MAX_NUMBER_OF_DELAY_COMMAND + 1];
+	command_id after[MAX_NUMBER_OF_DELAY_COMMAND + 1];
+	unsigned int resets = 0, as_before = 0, as_after = 0, broken = 0;
+	int num = scenario->num_of_commands;
+
+	// 1. the change without a reset, its bytes and the list after it
+	time_unix first = fill_list(num, before);
+	unsigned int written = HostFRAM_Written();
+	make_change(scenario, first);
+	unsigned int change_bytes = HostFRAM_Written() - written;
+	int num_after = list_after_reset(first, first + 2 * num);
+	memcpy(after, recorded, num_after * sizeof(command_id));
+
+	// 2. the power is cut after a byte of the change, until after its last byte
+	unsigned int step = change_bytes / BENCH_MAX_CUTS + 1;
+	for (unsigned int cut = 0; cut <= change_bytes; cut = cut < change_bytes && cut + step > change_bytes ? change_bytes : cut + step)
+	{
+		first = fill_list(num, before);
+		HostFRAM_Cut(cut);
+		make_change(scenario, first);
+		HostFRAM_Cut(-1);
+		int count = list_after_reset(first, first + 2 * num);
+		resets++;
+		if (corrupted)
+			broken++;
+		else if (same_list(before, num, count))
+			as_before++;
+		else if (same_list(after, num_after, count))
+			as_after++;
+		else
+			broken++;
+		corrupted = FALSE;
+	}
+
+	printf("%-20s %9u %8u %8u %8u %8u\n", scenario->title, change_bytes, resets, as_before, as_after, broken);
+}
+
+//commands of a data length a second apart, twice as many as the list holds
+static void run_capacity(int length)
+{
+	time_unix start;
+	reset_delayCommand(TRUE);
+	get_delayCommand_list();
+	Time_getUnixEpoch(&start);
+	for (int i = 0; i < 2 * MAX_NUMBER_OF_DELAY_COMMAND; i++)
+		add(start + 60 + i, length);
+	int held = list_after_reset(start + 60, start + 60 + 2 * MAX_NUMBER_OF_DELAY_COMMAND);
+	//a full list deletes its latest command for a new one, it keeps the earliest and the last added
+	Boolean kept = !corrupted && held > 0 && recorded[held - 1] == 2 * MAX_NUMBER_OF_DELAY_COMMAND - 1;
+	for (int i = 0; i < held - 1; i++)
+		if (recorded[i] != (command_id)i)
+			kept = FALSE;
+	corrupted = FALSE;
+	printf("%11d %8d %8s\n", length, held, kept ? "yes" : "no");
+}
+
+int main()
+{
+	printf("%8s %10s %9s %12s %12s %9s %6s\n", "commands", "check [ns]", "FRAM rd", "add FRAM [B]", "exec FRAM [B]",
+			"executed", "wrong");
+	for (unsigned int i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+		run(scenarios[i]);
+	printf("\ncheck: time of a check_delaycommand, FRAM rd: FRAM reads of a check, add and exec FRAM:\n"
+			"bytes written to the FRAM for every command added and executed, wrong: commands executed out\n"
+			"of the order of their times or not in the second of their time\n");
+
+	printf("\n%-20s %9s %8s %8s %8s %8s\n", "change", "bytes", "resets", "before", "after", "broken");
+	for (unsigned int i = 0; i < sizeof(crash_scenarios) / sizeof(crash_scenarios[0]); i++)
+		run_crash(&crash_scenarios[i]);
+	printf("\nbytes: written to the FRAM for the change, resets: the power cut after a byte of the change,\n"
+			"before and after: the list after the reset is the list before the change or after it, broken:\n"
+			"any other list, or a command with data that isn't its own\n");
+
+	printf("\n%11s %8s %8s\n", "data [B]", "held", "kept");
+	for (unsigned int i = 0; i < sizeof(data_lengths) / sizeof(data_lengths[0]); i++)
+		run_capacity(data_lengths[i]);
+	printf("\ndata: bytes of data of every command, held: commands in the list after adding twice as many\n"
+			"as it holds, kept: the list kept the earliest commands and the last one added\n");
+	return 0;
+}
@@ -0,0 +1,266 @@
+/*
+ * DumpBenchmark.c
+ *
+ * dumps synthetic HK through the simulated transmitter, once with the loop
+ * dump_logic had before the dump pipeline, once with the pipeline and once
+ * with the pipeline and the records packed in PACKED_DUMP_ST packets, and
+ * reports how much of the 9600 bps link every dump used.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "../src/sub-systemCode/TRXVU.h"
+#include "../src/sub-systemCode/COMM/Dump_pipeline.h"
+#include "../src/sub-systemCode/COMM/Tx_scheduler.h"
+#include "HostStandIns.h"
+
+#define BENCH_SD_MS_PER_KB		2		// c_fileCursorNext of a window, f_read of every element included
+#define BENCH_HK_PERIOD			1		// seconds between two records
+
+xSemaphoreHandle xIsTransmitting;
+
+typedef struct
+{
+	const char* title;
+	unsigned int record_size;		// data bytes of a record
+	unsigned int num_of_records;
+	unsigned int resolution;		// seconds, like the resolution of the dump command
+} bench_scenario;
+
+typedef struct
+{
+	const bench_scenario* scenario;
+	unsigned int record;			// next record
+	unsigned int records_in_chunk;	// records the cursor returns in one DUMP_WINDOW_SIZE window
+	unsigned int last_send;
+	Boolean packed;
+	Boolean pending;				// next_packed did not fit in the last packed packet
+	TM_spl_header next_packed;
+	unsigned int records_sent;
+	unsigned int unpack_errors;		// packed records that did not come back as they were sent
+} bench_source;
+
+static const bench_scenario scenarios[] =
+{
+	{ "EPS HK, every record", 49, 2000, 0 },
+	{ "COMM HK, every record", 12, 5000, 0 },
+	{ "COMM HK, resolution 10s", 12, 20000, 10 },
+	{ "ADCS SC, every record", 6, 5000, 0 },
+};
+
+static void init_source(bench_source* source, const bench_scenario* scenario, Boolean packed)
+{
+	memset(source, 0, sizeof(bench_source));
+	source->scenario = scenario;
+	source->packed = packed;
+	source->records_in_chunk = DUMP_WINDOW_SIZE / (scenario->record_size + TIME_SIZE);
+}
+
+//the next record that passes the resolution, charging the SD time of every chunk read.
+//returns 0 at the end of the dump
+static int next_record(bench_source* source, unsigned int* time)
+{
+	while (source->record < source->scenario->num_of_records)
+	{
+		if (source->record % source->records_in_chunk == 0)
+		{
+			unsigned int chunk = source->records_in_chunk * (source->scenario->record_size + TIME_SIZE);
+			HostClock_Advance(chunk * BENCH_SD_MS_PER_KB / 1024);
+		}
+		*time = source->record * BENCH_HK_PERIOD;
+		source->record++;
+		if (source->last_send + source->scenario->resolution <= *time || source->record == 1)
+		{
+			source->last_send = *time;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void build_record(const bench_source* source, unsigned int time, TM_spl* packet)
+{
+	packet->type = DUMP_T;
+	packet->subType = COMM_DUMP_ST;
+	packet->length = source->scenario->record_size;
+	packet->time = time;
+	memset(packet->data, (byte)time, packet->length);
+}
+
+static uint8_t encode_record(const bench_source* source, unsigned int time, byte* frame)
+{
+	TM_spl packet;
+	int length = 0;
+	build_record(source, time, &packet);
+	encode_TMpacket(frame, &length, packet);
+	return (uint8_t)length;
+}
+
+//decodes a packed frame, like the ground station does, and checks its records
+static void check_packed_frame(bench_source* source, byte* frame)
+{
+	TM_spl_header record;
+	TM_spl expected;
+	byte* data;
+	for (int i = 0; unpack_TMframe(frame, i, &record, &data) == 0; i++)
+	{
+		build_record(source, record.time, &expected);
+		if (record.type != expected.type || record.subType != expected.subType || record.length != expected.length
+				|| memcmp(data, expected.data, record.length) != 0)
+			source->unpack_errors++;
+		source->records_sent++;
+	}
+}
+
+static void build_record_header(const bench_source* source, unsigned int time, TM_spl_header* header)
+{
+	header->type = DUMP_T;
+	header->subType = COMM_DUMP_ST;
+	header->length = source->scenario->record_size;
+	header->time = time;
+}
+
+static int bench_frame_source(void* context, byte* frame, uint8_t* length)
+{
+	bench_source* source = context;
+	unsigned int time;
+	if (!source->packed)
+	{
+		if (!next_record(source, &time))
+			return 0;
+		*length = encode_record(source, time, frame);
+		source->records_sent++;
+		return 1;
+	}
+
+	TM_spl_header packed;
+	byte* data;
+	if (!source->pending)
+	{
+		if (!next_record(source, &time))
+			return 0;
+		build_record_header(source, time, &source->next_packed);
+	}
+	source->pending = FALSE;
+	init_packed_TMframe(frame, &source->next_packed);
+	data = add_to_packed_TMframe(frame, &source->next_packed);
+	memset(data, (byte)source->next_packed.time, source->next_packed.length);
+	while (next_record(source, &time))
+	{
+		build_record_header(source, time, &source->next_packed);
+		data = add_to_packed_TMframe(frame, &source->next_packed);
+		if (data == NULL)
+		{
+			source->pending = TRUE;
+			break;
+		}
+		memset(data, (byte)time, source->next_packed.length);
+	}
+	read_TM_header(frame, &packed);
+	*length = (uint8_t)(packed.length + SPL_TM_HEADER_SIZE);
+	check_packed_frame(source, frame);
+	return 1;
+}
+
+//dump_logic and TRX_sendFrame as they were before the pipeline
+static void legacy_dump(const bench_scenario* scenario)
+{
+	bench_source source;
+	byte frame[SIZE_TXFRAME];
+	queueRequest request;
+	init_source(&source, scenario, FALSE);
+	for (unsigned int i = 0; i < scenario->num_of_records; i++)
+	{
+		unsigned int time = i * BENCH_HK_PERIOD;
+		if (i % source.records_in_chunk == 0)
+			HostClock_Advance(source.records_in_chunk * (scenario->record_size + TIME_SIZE) * BENCH_SD_MS_PER_KB / 1024);
+		if (source.last_send + scenario->resolution <= time || i == 0)
+		{
+			source.last_send = time;
+			uint8_t length = encode_record(&source, time, frame);
+			unsigned char avalFrames = VALUE_TX_BUFFER_FULL;
+			int count = 0;
+			xSemaphoreTake(xIsTransmitting, MAX_DELAY);
+			do
+			{
+				IsisTrxvu_tcSendAX25DefClSign(0, frame, length, &avalFrames);
+				if (count % 10 == 1)
+					vTaskDelay((portTickType)(length * 20));
+				count++;
+			}
+			while (avalFrames == VALUE_TX_BUFFER_FULL);
+			IsisTrxvu_tcSetAx25Bitrate(0, trxvu_bitrate_9600);
+			xSemaphoreGive(xIsTransmitting);
+			vTaskDelay(SYSTEM_DEALY);
+		}
+		xQueueReceive(xDumpQueue, &request, SYSTEM_DEALY);
+	}
+}
+
+static void pipeline_dump(const bench_scenario* scenario, Boolean packed)
+{
+	static dump_pipeline pipe;
+	bench_source source;
+	init_source(&source, scenario, packed);
+	init_dump_pipeline(&pipe, bench_frame_source, &source, xDumpQueue);
+	int result = run_dump_pipeline(&pipe);
+	if (result != 0)
+		printf("run_dump_pipeline returned %d\n", result);
+	if (packed && (source.unpack_errors != 0 || source.records_sent != (scenario->num_of_records + 
+			(scenario->resolution > 0 ? scenario->resolution - 1 : 0)) / (scenario->resolution > 0 ? scenario->resolution : 1)))
+		printf("packed dump sent %u records, %u of them wrong\n", source.records_sent, source.unpack_errors);
+}
+
+static void print_result(const char* title, const char* version, unsigned long long start)
+{
+	HostTx_Stats stats;
+	HostTx_GetStats(&stats);
+	unsigned long long elapsed = stats.last_end - start;
+	unsigned long long on_air = stats.last_end - stats.first_start;
+	printf("%-26s %-9s %7u %10.1f %8.1f%% %9.0f %9.2f %8u\n", title, version, stats.frames,
+			elapsed / 1000.0,
+			on_air > 0 ? 100.0 * stats.busy_ms / on_air : 0,
+			elapsed > 0 ? stats.bytes * 8 * 1000.0 / elapsed : 0,
+			stats.frames > 0 ? (double)stats.i2c_transactions / stats.frames : 0,
+			stats.refused);
+}
+
+int main()
+{
+	vSemaphoreCreateBinary(xIsTransmitting);
+	xDumpQueue = xQueueCreate(1, sizeof(queueRequest));
+	init_Tx_scheduler();
+
+	printf("%-26s %-9s %7s %10s %9s %9s %9s %8s\n", "", "", "frames", "time [s]",
+			"link use", "data bps", "I2C/frm", "refused");
+	for (unsigned int i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+	{
+		unsigned long long start;
+
+		HostTx_Reset();
+		HostClock_Advance(60 * 1000);
+		start = HostClock_Now();
+		legacy_dump(&scenarios[i]);
+		print_result(scenarios[i].title, "before", start);
+
+		HostTx_Reset();
+		HostClock_Advance(60 * 1000);
+		start = HostClock_Now();
+		pipeline_dump(&scenarios[i], FALSE);
+		print_result(scenarios[i].title, "pipeline", start);
+
+		HostTx_Reset();
+		HostClock_Advance(60 * 1000);
+		start = HostClock_Now();
+		pipeline_dump(&scenarios[i], TRUE);
+		print_result(scenarios[i].title, "packed", start);
+	}
+	printf("\nlink use: time on the air over the time from the first frame to the last,\n"
+			"data bps: SPL bytes over the time from the dump start to the last frame\n");
+	return 0;
+}
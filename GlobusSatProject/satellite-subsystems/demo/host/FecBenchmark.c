@@ -0,0 +1,356 @@
+/*
+ * FecBenchmark.c
+ *
+ * the repair frames of the dump pipeline. first the CPU cost of the encoder
+ * and of the ground decoder for every data frame, then dumps through the
+ * pipeline and the simulated transmitter to a ground station that loses
+ * frames at random, rebuilds the windows it can and checks every frame it
+ * rebuilt against the frame that was sent.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "../src/sub-systemCode/TRXVU.h"
+#include "../src/sub-systemCode/COMM/Dump_pipeline.h"
+#include "../src/sub-systemCode/COMM/Dump_fec.h"
+#include "../src/sub-systemCode/COMM/Tx_scheduler.h"
+#include "../src/sub-systemCode/COMM/splTypes.h"
+#include "HostStandIns.h"
+
+#define BENCH_FRAMES			4000	// data frames of a dump
+#define BENCH_CPU_FRAMES		200000	// data frames of the CPU measure
+#define BENCH_MAX_RECENT		(2 * FEC_WINDOW_SIZE)	// data frames the ground keeps to match to a window
+
+xSemaphoreHandle xIsTransmitting;
+
+typedef struct
+{
+	int loss;			// frames lost in every 1000
+	int num_of_repair;	// 0 for no repair frames
+} bench_scenario;
+
+static const bench_scenario scenarios[] =
+{
+	{ 10, 0 }, { 10, 1 }, { 10, 2 },
+	{ 50, 0 }, { 50, 1 }, { 50, 2 }, { 50, 4 },
+	{ 100, 0 }, { 100, 2 }, { 100, 4 },
+};
+
+static unsigned int random_state;
+
+static unsigned int next_random()
+{
+	random_state = random_state * 1103515245 + 12345;
+	return random_state >> 16;
+}
+
+static double now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+//data frame 'index' of the dump: a packet of COMM_DUMP_ST with the index as its time
+static uint8_t build_data_frame(unsigned int index, uint8_t length, byte *frame)
+{
+	TM_spl_header header = { DUMP_T, COMM_DUMP_ST, (unsigned short)(length - SPL_TM_HEADER_SIZE), index };
+	write_TM_header(frame, &header, NULL);
+	unsigned int x = index * 2654435761u;
+	for (int b = SPL_TM_HEADER_SIZE; b < length; b++)
+	{
+		x = x * 1103515245 + 12345;
+		frame[b] = (byte)(x >> 16);
+	}
+	return length;
+}
+
+static uint8_t data_frame_length(unsigned int index)
+{
+	return (uint8_t)(60 + (index * 37) % (FEC_MAX_DATA_FRAME - 60 + 1));
+}
+
+//the ground station
+
+typedef struct
+{
+	byte frame[SIZE_TXFRAME];
+	uint8_t length;
+} ground_frame;
+
+static ground_frame recent[BENCH_MAX_RECENT];	// the last data frames received
+static int num_of_recent;
+static ground_frame repairs[FEC_MAX_REPAIR];
+static int repair_index[FEC_MAX_REPAIR];
+static int num_of_repairs;
+static int repair_window = -1;
+static Boolean received[BENCH_FRAMES];
+static unsigned int rebuilt, rebuild_errors;
+static double decode_ns;
+
+//solves a * x = s in GF(256), a is n x n, s and x are n rows of 'length' bytes
+static int gf_solve(byte a[FEC_MAX_REPAIR][FEC_MAX_REPAIR], byte s[FEC_MAX_REPAIR][SIZE_TXFRAME], int n, int length)
+{
+	for (int col = 0; col < n; col++)
+	{
+		int pivot = col;
+		while (pivot < n && a[pivot][col] == 0)
+			pivot++;
+		if (pivot == n)
+			return -1;
+		if (pivot != col)
+		{
+			byte row[FEC_MAX_REPAIR];
+			byte data[SIZE_TXFRAME];
+			memcpy(row, a[col], sizeof(row));
+			memcpy(a[col], a[pivot], sizeof(row));
+			memcpy(a[pivot], row, sizeof(row));
+			memcpy(data, s[col], length);
+			memcpy(s[col], s[pivot], length);
+			memcpy(s[pivot], data, length);
+		}
+		byte inv = dump_fec_gf_inv(a[col][col]);
+		for (int k = 0; k < n; k++)
+			a[col][k] = dump_fec_gf_mul(a[col][k], inv);
+		for (int b = 0; b < length; b++)
+			s[col][b] = dump_fec_gf_mul(s[col][b], inv);
+		for (int r = 0; r < n; r++)
+		{
+			byte f = a[r][col];
+			if (r == col || f == 0)
+				continue;
+			for (int k = 0; k < n; k++)
+				a[r][k] ^= dump_fec_gf_mul(f, a[col][k]);
+			for (int b = 0; b < length; b++)
+				s[r][b] ^= dump_fec_gf_mul(f, s[col][b]);
+		}
+	}
+	return 0;
+}
+
+static void check_rebuilt(byte *frame, uint8_t length)
+{
+	TM_spl_header header;
+	byte expected[SIZE_TXFRAME];
+	if (read_TM_header(frame, &header) != 0 || header.time >= BENCH_FRAMES
+			|| build_data_frame(header.time, data_frame_length(header.time), expected) != length
+			|| memcmp(frame, expected, length) != 0)
+	{
+		rebuild_errors++;
+		return;
+	}
+	received[header.time] = TRUE;
+	rebuilt++;
+}
+
+//rebuilds the lost data frames of the window of the repair frames received
+static void decode_window()
+{
+	if (num_of_repairs == 0)
+		return;
+	double start = now_ns();
+	byte *info = SPL_TM_DATA(repairs[0].frame);
+	int count = info[2];
+	uint8_t max_length = 0;
+	int lost[FEC_WINDOW_SIZE];
+	int num_of_lost = 0;
+	ground_frame *found[FEC_WINDOW_SIZE];
+
+	// 1. the data frames of the window, by their CRC16
+	for (int i = 0; i < count; i++)
+	{
+		byte *frame_info = info + FEC_HEADER_SIZE + i * FEC_FRAME_INFO_SIZE;
+		uint8_t length = frame_info[0];
+		unsigned short crc = (unsigned short)((frame_info[1] << 8) | frame_info[2]);
+		if (length > max_length)
+			max_length = length;
+		found[i] = NULL;
+		for (int k = 0; k < num_of_recent && found[i] == NULL; k++)
+			if (recent[k].length == length && dump_fec_crc(recent[k].frame, length) == crc)
+				found[i] = &recent[k];
+		if (found[i] == NULL)
+			lost[num_of_lost++] = i;
+	}
+	if (num_of_lost == 0 || num_of_lost > num_of_repairs)
+	{
+		num_of_repairs = 0;
+		return;
+	}
+
+	// 2. the repair symbols without the data frames received
+	byte a[FEC_MAX_REPAIR][FEC_MAX_REPAIR];
+	byte s[FEC_MAX_REPAIR][SIZE_TXFRAME];
+	int symbols = FEC_HEADER_SIZE + count * FEC_FRAME_INFO_SIZE;
+	for (int r = 0; r < num_of_lost; r++)
+	{
+		memcpy(s[r], SPL_TM_DATA(repairs[r].frame) + symbols, max_length);
+		for (int i = 0; i < count; i++)
+		{
+			byte c = dump_fec_coefficient(repair_index[r], i);
+			if (found[i] != NULL)
+			{
+				for (int b = 0; b < found[i]->length; b++)
+					s[r][b] ^= dump_fec_gf_mul(c, found[i]->frame[b]);
+			}
+		}
+		for (int e = 0; e < num_of_lost; e++)
+			a[r][e] = dump_fec_coefficient(repair_index[r], lost[e]);
+	}
+
+	// 3. the lost data frames
+	if (gf_solve(a, s, num_of_lost, max_length) == 0)
+	{
+		decode_ns += now_ns() - start;
+		for (int e = 0; e < num_of_lost; e++)
+			check_rebuilt(s[e], info[FEC_HEADER_SIZE + lost[e] * FEC_FRAME_INFO_SIZE]);
+	}
+	num_of_repairs = 0;
+}
+
+static int loss;	// frames lost in every 1000
+
+static void ground_capture(unsigned char *data, unsigned char length)
+{
+	TM_spl_header header;
+	if ((int)(next_random() % 1000) < loss)
+		return;
+	if (read_TM_header(data, &header) != 0)
+		return;
+	if (header.subType == FEC_DUMP_ST)
+	{
+		byte *info = SPL_TM_DATA(data);
+		int window = (info[0] << 8) | info[1];
+		if (window != repair_window)
+		{
+			decode_window();
+			repair_window = window;
+		}
+		memcpy(repairs[num_of_repairs].frame, data, length);
+		repairs[num_of_repairs].length = length;
+		repair_index[num_of_repairs] = info[4];
+		num_of_repairs++;
+		return;
+	}
+	//a data frame ends the repair frames of the last window
+	decode_window();
+	if (header.time < BENCH_FRAMES)
+		received[header.time] = TRUE;
+	if (num_of_recent == BENCH_MAX_RECENT)
+	{
+		memmove(recent, recent + 1, sizeof(ground_frame) * (BENCH_MAX_RECENT - 1));
+		num_of_recent--;
+	}
+	memcpy(recent[num_of_recent].frame, data, length);
+	recent[num_of_recent].length = length;
+	num_of_recent++;
+}
+
+//the dump
+
+static unsigned int next_frame;
+
+static int bench_frame_source(void *context, byte *frame, uint8_t *length)
+{
+	(void)context;
+	if (next_frame >= BENCH_FRAMES)
+		return 0;
+	*length = build_data_frame(next_frame, data_frame_length(next_frame), frame);
+	next_frame++;
+	return 1;
+}
+
+static void run_dump(const bench_scenario *scenario)
+{
+	static dump_pipeline pipe;
+	static dump_fec fec;
+	HostTx_Stats stats;
+	unsigned int delivered = 0;
+
+	memset(received, 0, sizeof(received));
+	num_of_recent = 0;
+	num_of_repairs = 0;
+	repair_window = -1;
+	rebuilt = rebuild_errors = 0;
+	decode_ns = 0;
+	next_frame = 0;
+	random_state = 12345;
+	loss = scenario->loss;
+
+	HostClock_Advance(60 * 1000);
+	HostTx_Reset();
+	HostTx_SetCapture(ground_capture);
+	init_dump_pipeline(&pipe, bench_frame_source, NULL, NULL);
+	if (scenario->num_of_repair > 0)
+	{
+		init_dump_fec(&fec, scenario->num_of_repair);
+		pipe.fec = &fec;
+	}
+	int result = run_dump_pipeline(&pipe);
+	if (result != 0)
+		printf("run_dump_pipeline returned %d\n", result);
+	decode_window();
+	HostTx_SetCapture(NULL);
+	HostTx_GetStats(&stats);
+
+	for (int i = 0; i < BENCH_FRAMES; i++)
+		if (received[i])
+			delivered++;
+	printf("%5.1f%% %7d %8u %10.1f%% %11.2f%% %9u %8u %10.0f\n", scenario->loss / 10.0, scenario->num_of_repair,
+			stats.frames, 100.0 * (stats.frames - BENCH_FRAMES) / BENCH_FRAMES,
+			100.0 * delivered / BENCH_FRAMES, rebuilt, rebuild_errors,
+			rebuilt > 0 ? decode_ns / rebuilt : 0);
+}
+
+//the encoder alone, the frames of the dump and their repair frames
+static void run_cpu(int num_of_repair, uint8_t length)
+{
+	static dump_fec fec;
+	static byte frames[FEC_WINDOW_SIZE][SIZE_TXFRAME];
+	byte repair[SIZE_TXFRAME];
+	uint8_t repair_length;
+	volatile unsigned int sink = 0;
+
+	for (int i = 0; i < FEC_WINDOW_SIZE; i++)
+		build_data_frame(i, length, frames[i]);
+	init_dump_fec(&fec, num_of_repair);
+	double start = now_ns();
+	for (int n = 0; n < BENCH_CPU_FRAMES; n++)
+	{
+		dump_fec_add(&fec, frames[n % FEC_WINDOW_SIZE], length);
+		while (dump_fec_next_repair(&fec, repair, &repair_length))
+			sink += repair[repair_length - 1];
+	}
+	double ns = (now_ns() - start) / BENCH_CPU_FRAMES;
+	printf("%7d %8u %10.0f %11d %13.1f%%\n", num_of_repair, length, ns, num_of_repair * length,
+			100.0 * num_of_repair * (SPL_TM_HEADER_SIZE + FEC_HEADER_SIZE + FEC_WINDOW_SIZE * FEC_FRAME_INFO_SIZE + length)
+			/ (FEC_WINDOW_SIZE * length));
+}
+
+int main()
+{
+	vSemaphoreCreateBinary(xIsTransmitting);
+	init_Tx_scheduler();
+
+	printf("encoder, %d data frames a window\n", FEC_WINDOW_SIZE);
+	printf("%7s %8s %10s %11s %14s\n", "repair", "length", "ns/frame", "GF mul/frm", "link overhead");
+	const int repairs_cpu[] = { 1, 2, 4 };
+	const uint8_t lengths[] = { 60, FEC_MAX_DATA_FRAME };
+	for (unsigned int r = 0; r < sizeof(repairs_cpu) / sizeof(repairs_cpu[0]); r++)
+		for (unsigned int l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+			run_cpu(repairs_cpu[r], lengths[l]);
+
+	printf("\ndump of %d data frames, %d to %d bytes\n", BENCH_FRAMES, 60, FEC_MAX_DATA_FRAME);
+	printf("%6s %7s %8s %11s %12s %9s %8s %10s\n", "loss", "repair", "frames", "overhead", "delivered",
+			"rebuilt", "wrong", "ns/rebuilt");
+	for (unsigned int i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+		run_dump(&scenarios[i]);
+	printf("\nGF mul/frm: GF(256) multiplications of the encoder for every data frame, one table lookup each,\n"
+			"delivered: data frames the ground has, received or rebuilt, wrong: rebuilt frames not like the sent frame,\n"
+			"ns/rebuilt: ground decoder time for every rebuilt frame\n");
+	return 0;
+}
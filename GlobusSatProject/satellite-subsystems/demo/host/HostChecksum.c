@@ -0,0 +1,46 @@
+/*
+ * HostChecksum.c
+ *
+ * stand-in for the CRC16 and CRC32 of hal/checksum.h, MSB first, no final XOR.
+ */
+
+#include <hal/checksum.h>
+
+void checksum_prepareLUTCRC16(unsigned short polynomial, unsigned short* LUT)
+{
+	for (int i = 0; i < 256; i++)
+	{
+		unsigned short crc = (unsigned short)(i << 8);
+		for (int bit = 0; bit < 8; bit++)
+			crc = (unsigned short)(crc & 0x8000 ? (crc << 1) ^ polynomial : crc << 1);
+		LUT[i] = crc;
+	}
+}
+
+unsigned short checksum_calculateCRC16LUT(unsigned char* data, unsigned int length, unsigned short* LUT, unsigned short start_remainder, Boolean endofdata)
+{
+	(void)endofdata;
+	unsigned short crc = start_remainder;
+	for (unsigned int i = 0; i < length; i++)
+		crc = (unsigned short)((crc << 8) ^ LUT[((crc >> 8) ^ data[i]) & 0xff]);
+	return crc;
+}
+
+void checksum_prepareLUTCRC32(unsigned int polynomial, unsigned int* LUT)
+{
+	for (unsigned int i = 0; i < 256; i++)
+	{
+		unsigned int crc = i << 24;
+		for (int bit = 0; bit < 8; bit++)
+			crc = crc & 0x80000000 ? (crc << 1) ^ polynomial : crc << 1;
+		LUT[i] = crc;
+	}
+}
+
+unsigned int checksum_calculateCRC32LUT(unsigned char* data, unsigned int length, unsigned int* LUT, unsigned int start_remainder)
+{
+	unsigned int crc = start_remainder;
+	for (unsigned int i = 0; i < length; i++)
+		crc = (crc << 8) ^ LUT[((crc >> 24) ^ data[i]) & 0xff];
+	return crc;
+}
@@ -0,0 +1,305 @@
+/*
+ * HostFAT.c
+ *
+ * stand-in for the HCC FAT. every file of the SD is a file in the directory
+ * given to HostSD_Init, every call is counted and holds the task for the time
+ * the SD takes on the target.
+ */
+
+#include "HostStandIns.h"
+
+#include <hcc/api_fat.h>
+#include <hcc/api_hcc_mem.h>
+#include <hcc/api_mdriver_atmel_mcipdc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define SD_PATH_SIZE (HOST_SD_ROOT_MAX_LENGTH + F_MAXPATHNAME)
+
+static char sd_root[HOST_SD_ROOT_MAX_LENGTH] = ".";
+static HostSD_Stats sd_stats;
+static DIR *find_dir = NULL;//the directory f_findfirst and f_findnext go over
+
+//path of a file of the SD in the root directory, NULL if it doesn't fit
+static const char* getPath(const char *filename, char path[SD_PATH_SIZE])
+{
+	// the drive of the target, "A:/", is the root directory
+	if (strncmp(filename, "A:/", 3) == 0)
+		filename += 3;
+	int length = snprintf(path, SD_PATH_SIZE, "%s/%s", sd_root, filename);
+	if (length < 0 || length >= SD_PATH_SIZE)
+		return NULL;
+	return path;
+}
+
+static void sdTime(unsigned long long ms)
+{
+	HostClock_Advance(ms);
+	sd_stats.ms += ms;
+}
+
+int HostSD_Init(const char *root, int clear)
+{
+	if (strlen(root) >= sizeof(sd_root))
+		return -1;
+	DIR *dir = opendir(root);
+	if (dir == NULL)
+		return -1;
+	strcpy(sd_root, root);
+	struct dirent *entry;
+	while (clear && (entry = readdir(dir)) != NULL)
+	{
+		char path[SD_PATH_SIZE];
+		struct stat st;
+		if (getPath(entry->d_name, path) != NULL && stat(path, &st) == 0 && S_ISREG(st.st_mode))
+			remove(path);
+	}
+	closedir(dir);
+	return 0;
+}
+
+void HostSD_GetStats(HostSD_Stats *stats)
+{
+	*stats = sd_stats;
+}
+
+void HostSD_ResetStats()
+{
+	memset(&sd_stats, 0, sizeof(sd_stats));
+}
+
+int hcc_mem_init(void)
+{
+	return 0;
+}
+
+int hcc_mem_delete(void)
+{
+	return 0;
+}
+
+int fn_init(void)
+{
+	return F_NO_ERROR;
+}
+
+int fsn_delete(void)
+{
+	return F_NO_ERROR;
+}
+
+int f_enterFS(void)
+{
+	return F_NO_ERROR;
+}
+
+void f_releaseFS(void)
+{
+}
+
+F_DRIVER* atmel_mcipdc_initfunc(unsigned long driver_param)
+{
+	(void)driver_param;
+	return NULL;
+}
+
+int fm_initvolume(int drvnumber, F_DRIVERINIT driver_init, unsigned long driver_param)
+{
+	(void)drvnumber;
+	(void)driver_init;
+	(void)driver_param;
+	return F_NO_ERROR;
+}
+
+int fm_delvolume(int drvnumber)
+{
+	(void)drvnumber;
+	return F_NO_ERROR;
+}
+
+int fm_getdrive(void)
+{
+	return 0;
+}
+
+int fm_getfreespace(int drivenum, FN_SPACE *pspace)
+{
+	(void)drivenum;
+	unsigned long used = 0;
+	DIR *dir = opendir(sd_root);
+	if (dir == NULL)
+		return F_ERR_NOTFOUND;
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL)
+	{
+		char path[SD_PATH_SIZE];
+		struct stat st;
+		if (getPath(entry->d_name, path) != NULL && stat(path, &st) == 0 && S_ISREG(st.st_mode))
+			used += st.st_size;
+	}
+	closedir(dir);
+	sdTime(HOST_SD_FREESPACE_MS);
+	memset(pspace, 0, sizeof(*pspace));
+	pspace->total = HOST_SD_CAPACITY;
+	pspace->used = used < HOST_SD_CAPACITY ? used : HOST_SD_CAPACITY;
+	pspace->free = HOST_SD_CAPACITY - pspace->used;
+	return F_NO_ERROR;
+}
+
+long fm_filelength(const char *filename)
+{
+	char path[SD_PATH_SIZE];
+	struct stat st;
+	sd_stats.file_lengths++;
+	if (getPath(filename, path) == NULL || stat(path, &st) != 0)
+		return 0;
+	return st.st_size;
+}
+
+FN_FILE* fm_open(const char *filename, const char *mode)
+{
+	char path[SD_PATH_SIZE];
+	char host_mode[4];
+	if (getPath(filename, path) == NULL || strlen(mode) > 2)
+		return NULL;
+	// stdio modes match the HCC ones, "a+" reads anywhere and writes at the end in both
+	snprintf(host_mode, sizeof(host_mode), "%c%s%s", mode[0], "b", mode + 1);
+	FILE *file = fopen(path, host_mode);
+	if (file == NULL)
+		return NULL;
+	FN_FILE *handle = malloc(sizeof(*handle));
+	if (handle == NULL)
+	{
+		fclose(file);
+		return NULL;
+	}
+	handle->reference = file;
+	sd_stats.opens++;
+	sdTime(HOST_SD_OPEN_MS);
+	return handle;
+}
+
+int fm_close(FN_FILE *filehandle)
+{
+	if (filehandle == NULL)
+		return F_ERR_NOTOPEN;
+	int err = fclose(filehandle->reference);
+	free(filehandle);
+	sd_stats.closes++;
+	sdTime(HOST_SD_CLOSE_MS);
+	return err == 0 ? F_NO_ERROR : F_ERR_WRITE;
+}
+
+int fm_flush(FN_FILE *filehandle)
+{
+	return fflush(filehandle->reference) == 0 ? F_NO_ERROR : F_ERR_WRITE;
+}
+
+long fm_read(void *buf, long size, long size_st, FN_FILE *filehandle)
+{
+	long read = fread(buf, size, size_st, filehandle->reference);
+	sd_stats.reads++;
+	sd_stats.bytes_read += read * size;
+	sdTime(HOST_SD_WRITE_MS);
+	return read;
+}
+
+long fm_write(const void *buf, long size, long size_st, FN_FILE *filehandle)
+{
+	long written = fwrite(buf, size, size_st, filehandle->reference);
+	sd_stats.writes++;
+	sd_stats.bytes_written += written * size;
+	sdTime(HOST_SD_WRITE_MS);
+	return written;
+}
+
+int fm_seek(FN_FILE *filehandle, long offset, long whence)
+{
+	sd_stats.seeks++;
+	return fseek(filehandle->reference, offset, whence) == 0 ? F_NO_ERROR : F_ERR_NOTAVAILABLE;
+}
+
+long fm_tell(FN_FILE *filehandle)
+{
+	return ftell(filehandle->reference);
+}
+
+int fm_eof(FN_FILE *filehandle)
+{
+	return feof(filehandle->reference);
+}
+
+int fm_delete(const char *filename)
+{
+	char path[SD_PATH_SIZE];
+	sd_stats.deletes++;
+	if (getPath(filename, path) == NULL || remove(path) != 0)
+		return F_ERR_NOTFOUND;
+	sdTime(HOST_SD_CLOSE_MS);
+	return F_NO_ERROR;
+}
+
+int fm_rename(const char *oldname, const char *newname)
+{
+	char old_path[SD_PATH_SIZE];
+	char new_path[SD_PATH_SIZE];
+	sd_stats.renames++;
+	if (getPath(oldname, old_path) == NULL || getPath(newname, new_path) == NULL
+			|| rename(old_path, new_path) != 0)
+		return F_ERR_NOTFOUND;
+	sdTime(HOST_SD_CLOSE_MS);
+	return F_NO_ERROR;
+}
+
+FN_FILE* fm_truncate(const char *filename, unsigned long length)
+{
+	char path[SD_PATH_SIZE];
+	sd_stats.truncates++;
+	if (getPath(filename, path) == NULL || truncate(path, length) != 0)
+		return NULL;
+	// f_truncate leaves the file open for writing at its new end
+	FN_FILE *handle = fm_open(filename, "r+");
+	if (handle != NULL)
+		fseek(handle->reference, 0, SEEK_END);
+	return handle;
+}
+
+//the next regular file of the directory of find_dir, every pattern matches every file
+static int findNext(FN_FIND *find)
+{
+	struct dirent *entry;
+	while (find_dir != NULL && (entry = readdir(find_dir)) != NULL)
+	{
+		char path[SD_PATH_SIZE];
+		struct stat st;
+		if (getPath(entry->d_name, path) == NULL || stat(path, &st) != 0 || !S_ISREG(st.st_mode)
+				|| strlen(entry->d_name) >= sizeof(find->filename))
+			continue;
+		memset(find, 0, sizeof(*find));
+		strcpy(find->filename, entry->d_name);
+		find->filesize = st.st_size;
+		return F_NO_ERROR;
+	}
+	if (find_dir != NULL)
+		closedir(find_dir);
+	find_dir = NULL;
+	return F_ERR_NOTFOUND;
+}
+
+int fm_findfirst(const char *filename, FN_FIND *find)
+{
+	(void)filename;
+	if (find_dir != NULL)
+		closedir(find_dir);
+	find_dir = opendir(sd_root);
+	return findNext(find);
+}
+
+int fm_findnext(FN_FIND *find)
+{
+	return findNext(find);
+}
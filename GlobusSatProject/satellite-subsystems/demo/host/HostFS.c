@@ -0,0 +1,52 @@
+/*
+ * HostFS.c
+ *
+ * stand-in for the chain file writes of TLM_management.c. nothing is stored,
+ * every call holds the task for the FRAM and SD work the real one does.
+ */
+
+#include <string.h>
+
+#include "../src/sub-systemCode/Global/TLM_management.h"
+#include "HostStandIns.h"
+
+static HostFS_Stats fs_stats;
+
+static void fsTime(unsigned long long ms)
+{
+	HostClock_Advance(ms);
+	fs_stats.ms += ms;
+}
+
+void HostFS_Reset()
+{
+	memset(&fs_stats, 0, sizeof(fs_stats));
+}
+
+void HostFS_GetStats(HostFS_Stats* stats)
+{
+	*stats = fs_stats;
+}
+
+FileSystemResult c_fileWrite(char* c_file_name, void* element)
+{
+	(void)c_file_name;
+	(void)element;
+	fsTime(HOST_FRAM_MS + HOST_SD_OPEN_MS + HOST_SD_WRITE_MS + HOST_SD_CLOSE_MS + HOST_FRAM_MS);
+	fs_stats.files_opened++;
+	fs_stats.elements++;
+	return FS_SUCCSESS;
+}
+
+FileSystemResult c_fileWriteElements(char* c_file_name, void* elements, unsigned int* times, int num_of_elements)
+{
+	(void)c_file_name;
+	(void)elements;
+	(void)times;
+	if (num_of_elements <= 0)
+		return FS_SUCCSESS;
+	fsTime(HOST_FRAM_MS + HOST_SD_OPEN_MS + num_of_elements * HOST_SD_WRITE_MS + HOST_SD_CLOSE_MS + HOST_FRAM_MS);
+	fs_stats.files_opened++;
+	fs_stats.elements += num_of_elements;
+	return FS_SUCCSESS;
+}
@@ -0,0 +1,114 @@
+/*
+ * HostFreeRTOS.c
+ *
+ * single task FreeRTOS stand-in on a virtual clock. a queue or semaphore that
+ * would block advances the clock by the timeout and fails.
+ */
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <string.h>
+
+#include "HostStandIns.h"
+
+typedef struct
+{
+	unsigned int length;
+	unsigned int item_size;
+	unsigned int count;
+	unsigned int first;
+	unsigned char* items;
+} host_queue;
+
+static unsigned long long host_now = 0;
+static host_queue queues[HOST_MAX_NUM_OF_QUEUES];
+static unsigned char queue_items[HOST_MAX_NUM_OF_QUEUES][HOST_QUEUE_BYTES];
+static int num_of_queues = 0;
+
+unsigned long long HostClock_Now()
+{
+	return host_now;
+}
+
+void HostClock_Advance(unsigned long long ms)
+{
+	host_now += ms;
+}
+
+void vTaskDelay(portTickType xTicksToDelay)
+{
+	host_now += xTicksToDelay * portTICK_RATE_MS;
+}
+
+void vTaskDelayUntil(portTickType * const pxPreviousWakeTime, portTickType xTimeIncrement)
+{
+	*pxPreviousWakeTime += xTimeIncrement;
+	if (*pxPreviousWakeTime > host_now)
+		host_now = *pxPreviousWakeTime;
+}
+
+portTickType xTaskGetTickCount(void)
+{
+	return (portTickType)(host_now / portTICK_RATE_MS);
+}
+
+void vTaskDelete(xTaskHandle xTaskToDelete)
+{
+	(void)xTaskToDelete;
+}
+
+xQueueHandle xQueueGenericCreate(unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char ucQueueType)
+{
+	(void)ucQueueType;
+	if (num_of_queues >= HOST_MAX_NUM_OF_QUEUES || uxQueueLength * uxItemSize > sizeof(queue_items[0]))
+		return NULL;
+	host_queue* queue = &queues[num_of_queues];
+	queue->length = uxQueueLength;
+	queue->item_size = uxItemSize;
+	queue->items = queue_items[num_of_queues];
+	num_of_queues++;
+	return queue;
+}
+
+portBASE_TYPE xQueueGenericReset(xQueueHandle xQueue, portBASE_TYPE xNewQueue)
+{
+	(void)xNewQueue;
+	host_queue* queue = xQueue;
+	queue->count = 0;
+	queue->first = 0;
+	return pdPASS;
+}
+
+signed portBASE_TYPE xQueueGenericSend(xQueueHandle xQueue, const void * const pvItemToQueue, portTickType xTicksToWait, portBASE_TYPE xCopyPosition)
+{
+	(void)xCopyPosition;
+	host_queue* queue = xQueue;
+	if (queue->count >= queue->length)
+	{
+		host_now += xTicksToWait * portTICK_RATE_MS;
+		return errQUEUE_FULL;
+	}
+	if (queue->item_size > 0)
+		memcpy(queue->items + ((queue->first + queue->count) % queue->length) * queue->item_size, pvItemToQueue, queue->item_size);
+	queue->count++;
+	return pdPASS;
+}
+
+signed portBASE_TYPE xQueueGenericReceive(xQueueHandle xQueue, const void * const pvBuffer, portTickType xTicksToWait, portBASE_TYPE xJustPeek)
+{
+	host_queue* queue = xQueue;
+	if (queue->count == 0)
+	{
+		host_now += xTicksToWait * portTICK_RATE_MS;
+		return pdFALSE;
+	}
+	if (queue->item_size > 0)
+		memcpy((void*)pvBuffer, queue->items + queue->first * queue->item_size, queue->item_size);
+	if (!xJustPeek)
+	{
+		queue->first = (queue->first + 1) % queue->length;
+		queue->count--;
+	}
+	return pdTRUE;
+}
@@ -0,0 +1,192 @@
+/*
+ * HostGlobal.c
+ *
+ * stand-ins for the parts of Global.c and GlobalParam.c the COMM code uses,
+ * for the RTC and for the FRAM.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <hal/Storage/FRAM.h>
+
+#include "../src/sub-systemCode/Global/Global.h"
+#include "../src/sub-systemCode/Global/GlobalParam.h"
+#include "HostStandIns.h"
+
+#define NUM_OF_SYSTEM_STATES 8
+#define HOST_FRAM_SIZE 0x40000//FM25V20, 256KB
+
+static Boolean system_states[NUM_OF_SYSTEM_STATES] = { [Tx_param] = TRUE };
+static Boolean ground_conn = FALSE;
+static voltage_t vbatt = 7600;
+static uint8_t num_of_APRS = 0;
+static unsigned char fram[HOST_FRAM_SIZE];
+static unsigned int fram_reads = 0;
+static unsigned int fram_writes = 0;
+static unsigned int fram_written = 0;
+static HostFRAM_Stats fram_stats;
+static long fram_cut = -1;			// bytes written before the power is cut, -1 for no cut
+
+void check_int(char *string_output, int error)
+{
+	if (error != 0)
+	{
+		printf("%s.\nresult: %d\n", string_output, error);
+	}
+}
+
+void check_portBASE_TYPE(char *string_output, long error)
+{
+	if (error != 1)
+	{
+		printf("%s.\nresult: %lu\n", string_output, error);
+	}
+}
+
+unsigned int BigEnE_raw_to_uInt(unsigned char raw[4])
+{
+	return ((unsigned int)raw[0] << 24) | ((unsigned int)raw[1] << 16) | ((unsigned int)raw[2] << 8) | raw[3];
+}
+
+unsigned short BigEnE_raw_to_uShort(unsigned char raw[2])
+{
+	return (unsigned short)((raw[0] << 8) | raw[1]);
+}
+
+void BigEnE_uInt_to_raw(unsigned int uInt, unsigned char raw[4])
+{
+	raw[0] = uInt >> 24;
+	raw[1] = uInt >> 16;
+	raw[2] = uInt >> 8;
+	raw[3] = uInt;
+}
+
+Boolean get_system_state(systems_state_parameters param)
+{
+	return param < NUM_OF_SYSTEM_STATES ? system_states[param] : FALSE;
+}
+
+void set_system_state(systems_state_parameters param, Boolean set_state)
+{
+	if (param < NUM_OF_SYSTEM_STATES)
+		system_states[param] = set_state;
+}
+
+void set_ground_conn(Boolean param)
+{
+	ground_conn = param;
+}
+
+Boolean get_ground_conn()
+{
+	return ground_conn;
+}
+
+void HostState_Set(int param, Boolean state)
+{
+	set_system_state((systems_state_parameters)param, state);
+}
+
+int Time_getUnixEpoch(unsigned int *epochTime)
+{
+	*epochTime = 1600000000 + (unsigned int)(HostClock_Now() / 1000);
+	return 0;
+}
+
+voltage_t get_Vbatt()
+{
+	return vbatt;
+}
+
+void HostVbatt_Set(unsigned short mV)
+{
+	vbatt = mV;
+}
+
+int FRAM_read(unsigned char *data, unsigned int address, unsigned int size)
+{
+	if (address + size > HOST_FRAM_SIZE)
+		return -2;
+	fram_reads++;
+	fram_stats.reads++;
+	fram_stats.bytes_read += size;
+	memcpy(data, fram + address, size);
+	return 0;
+}
+
+int FRAM_write(unsigned char *data, unsigned int address, unsigned int size)
+{
+	if (address + size > HOST_FRAM_SIZE)
+		return -2;
+	fram_writes++;
+	fram_written += size;
+	fram_stats.writes++;
+	fram_stats.bytes_written += size;
+	if (fram_cut >= 0)
+	{
+		//no power, the bytes after the cut are not written and the caller doesn't know
+		if ((long)size > fram_cut)
+			size = (unsigned int)fram_cut;
+		fram_cut -= size;
+	}
+	memcpy(fram + address, data, size);
+	return 0;
+}
+
+void HostFRAM_GetStats(HostFRAM_Stats* stats)
+{
+	*stats = fram_stats;
+}
+
+void HostFRAM_ResetStats()
+{
+	memset(&fram_stats, 0, sizeof(fram_stats));
+}
+
+double HostFRAM_EstimateLatency(const HostFRAM_Stats* stats)
+{
+	unsigned int accesses = stats->reads + stats->writes;
+	double bus_bytes = (double)stats->bytes_read + stats->bytes_written + (double)accesses * HOST_FRAM_COMMAND_SIZE;
+	return accesses * (double)HOST_FRAM_TRANSACTION_US + bus_bytes * 8 * 1e6 / HOST_FRAM_SPI_CLOCK;
+}
+
+void HostFRAM_Erase()
+{
+	memset(fram, 0, sizeof(fram));
+}
+
+void HostFRAM_Cut(long bytes)
+{
+	fram_cut = bytes;
+}
+
+unsigned int HostFRAM_Reads()
+{
+	return fram_reads;
+}
+
+unsigned int HostFRAM_Writes()
+{
+	return fram_writes;
+}
+
+unsigned int HostFRAM_Written()
+{
+	return fram_written;
+}
+
+void set_numOfDelayedCommand(uint8_t param)
+{
+	(void)param;
+}
+
+void set_numOfAPRS(uint8_t param)
+{
+	num_of_APRS = param;
+}
+
+uint8_t get_numOfAPRS()
+{
+	return num_of_APRS;
+}
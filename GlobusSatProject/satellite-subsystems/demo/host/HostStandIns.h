@@ -0,0 +1,224 @@
+/*
+ * HostStandIns.h
+ *
+ * stand-ins for FreeRTOS, the TRXVU driver, the global parameters, the FRAM
+ * and the HCC FAT, so the COMM code and the c_files can run on a Linux host
+ * against a simulated transceiver, a RAM FRAM and a directory as the SD.
+ * time is virtual, one tick is one millisecond, and moves only when a task
+ * sleeps, blocks or waits for the I2C bus.
+ */
+
+#ifndef HOSTSTANDINS_H_
+#define HOSTSTANDINS_H_
+
+#include <hal/boolean.h>
+
+#define HOST_TX_SLOTS				40		// frames the transmitter buffer holds
+#define HOST_RX_SLOTS				40		// frames the receiver buffer holds
+#define HOST_RX_MAX_FRAMES			4096	// frames a benchmark can schedule
+#define HOST_TX_BITRATE				9600
+#define HOST_AX25_OVERHEAD			20		// flags, addresses, control, PID and FCS of a frame
+#define HOST_I2C_CLOCK				100000	// Hz
+#define HOST_I2C_OVERHEAD			3		// address and command bytes of a transaction
+#define HOST_MAX_NUM_OF_QUEUES		16
+#define HOST_QUEUE_BYTES			1024		// items of a queue
+#define HOST_FRAM_MS				1		// FRAM read or write of a C_FILE
+#define HOST_FRAM_SPI_CLOCK			10000000	// Hz, used for the FRAM latency estimate
+#define HOST_FRAM_TRANSACTION_US	15		// driver and bus overhead of every FRAM access
+#define HOST_FRAM_COMMAND_SIZE		4		// opcode and 3 address bytes sent with every access
+#define HOST_SD_OPEN_MS				10		// f_open of a file of a chain, in "a+"
+#define HOST_SD_WRITE_MS			1		// f_write of an element to the cache of the file system
+#define HOST_SD_CLOSE_MS			20		// f_flush and f_close, the cached sectors and the FAT go to the SD
+#define HOST_SD_FREESPACE_MS		200		// f_getfreespace, a scan of the FAT
+#ifndef HOST_SD_CAPACITY
+#define HOST_SD_CAPACITY			(2UL * 1024 * 1024 * 1024)	// bytes of the SD card the FAT stand-in reports
+#endif
+#define HOST_SD_ROOT_MAX_LENGTH		256
+
+//counters of the simulated transmitter
+typedef struct
+{
+	unsigned int frames;			// frames accepted into the buffer
+	unsigned int refused;			// sends refused with a full buffer
+	unsigned int bytes;				// data bytes of the accepted frames
+	unsigned int i2c_transactions;
+	unsigned long long i2c_ms;		// time the I2C bus was busy
+	unsigned long long first_start;	// time the first frame went on the air
+	unsigned long long last_end;	// time the last frame left the air
+	unsigned long long busy_ms;		// time on the air
+	unsigned int bitrate_sets;		// IsisTrxvu_tcSetAx25Bitrate calls
+	unsigned int bitrate_changes_on_air;	// bitrate changes while frames of the other bitrate were in the buffer
+} HostTx_Stats;
+
+//gets every frame the simulated transmitter accepts
+typedef void (*HostTx_Capture)(unsigned char* data, unsigned char length);
+
+//counters of the simulated receiver
+typedef struct
+{
+	unsigned int frames;			// frames taken out of the buffer
+	unsigned int count_reads;		// frame count reads
+	unsigned int i2c_transactions;
+	unsigned long long latency_sum;	// ms from the arrival of every frame until it was taken out
+	unsigned long long latency_max;
+} HostRx_Stats;
+
+//counters of the simulated file system
+typedef struct
+{
+	unsigned int files_opened;
+	unsigned int elements;			// elements written
+	unsigned long long ms;			// time the file system took, FRAM included
+} HostFS_Stats;
+
+//counters of the FAT stand-in, every call is counted
+typedef struct
+{
+	unsigned int opens;
+	unsigned int closes;
+	unsigned int reads;
+	unsigned int writes;
+	unsigned int bytes_read;
+	unsigned int bytes_written;
+	unsigned int seeks;
+	unsigned int file_lengths;		// f_filelength calls
+	unsigned int deletes;
+	unsigned int renames;
+	unsigned int truncates;
+	unsigned long long ms;			// time the SD took
+} HostSD_Stats;
+
+//FRAM access counters, since the last HostFRAM_ResetStats
+typedef struct
+{
+	unsigned int reads;				// FRAM_read calls
+	unsigned int writes;			// FRAM_write calls
+	unsigned int bytes_read;
+	unsigned int bytes_written;
+} HostFRAM_Stats;
+
+/*!
+ * @return the virtual time in ms.
+ */
+unsigned long long HostClock_Now();
+
+/*!
+ * Move the virtual time forward, for work a task does without sleeping.
+ * @param ms time to add.
+ */
+void HostClock_Advance(unsigned long long ms);
+
+/*!
+ * Empty the simulated transmitter buffer and reset its counters.
+ */
+void HostTx_Reset();
+
+/*!
+ * Get the counters of the simulated transmitter, after it sent every frame in its buffer.
+ */
+void HostTx_GetStats(HostTx_Stats* stats);
+
+/*!
+ * Hand every frame the simulated transmitter accepts to a function, NULL for none.
+ */
+void HostTx_SetCapture(HostTx_Capture capture);
+
+/*!
+ * Empty the simulated receiver, its schedule and its counters.
+ */
+void HostRx_Reset();
+
+/*!
+ * Schedule a frame to arrive in the simulated receiver buffer.
+ * @param at time the frame arrives, after the frames scheduled before it.
+ * @param length length of the frame.
+ */
+void HostRx_Schedule(unsigned long long at, unsigned short length);
+
+/*!
+ * Get the counters of the simulated receiver.
+ */
+void HostRx_GetStats(HostRx_Stats* stats);
+
+/*!
+ * Reset the counters of the simulated file system.
+ */
+void HostFS_Reset();
+
+/*!
+ * Get the counters of the simulated file system.
+ */
+void HostFS_GetStats(HostFS_Stats* stats);
+
+/*!
+ * Point the FAT stand-in at a directory, every file of the SD is a file in it.
+ * @param root an existing directory.
+ * @param clear delete the files already in the directory.
+ * @return 0 on success, -1 if the path is too long or the directory can't be opened.
+ */
+int HostSD_Init(const char* root, int clear);
+
+/*!
+ * Get the counters of the FAT stand-in.
+ */
+void HostSD_GetStats(HostSD_Stats* stats);
+
+/*!
+ * Reset the counters of the FAT stand-in.
+ */
+void HostSD_ResetStats();
+
+/*!
+ * Set the Vbatt of the global parameters stand-in.
+ * @param mV the voltage of the batteries.
+ */
+void HostVbatt_Set(unsigned short mV);
+
+/*!
+ * @return the number of FRAM_read calls.
+ */
+unsigned int HostFRAM_Reads();
+
+/*!
+ * @return the number of FRAM_write calls.
+ */
+unsigned int HostFRAM_Writes();
+
+/*!
+ * @return the number of bytes FRAM_write wrote.
+ */
+unsigned int HostFRAM_Written();
+
+/*!
+ * Get the FRAM access counters.
+ */
+void HostFRAM_GetStats(HostFRAM_Stats* stats);
+
+/*!
+ * Reset the FRAM access counters, the counters of HostFRAM_Reads, HostFRAM_Writes and HostFRAM_Written go on.
+ */
+void HostFRAM_ResetStats();
+
+/*!
+ * Estimate the time the accesses of the counters took on the SPI bus.
+ * @return the time in us, at HOST_FRAM_SPI_CLOCK with HOST_FRAM_TRANSACTION_US for every access.
+ */
+double HostFRAM_EstimateLatency(const HostFRAM_Stats* stats);
+
+/*!
+ * Fill the FRAM with zeros, as a FRAM that was never written.
+ */
+void HostFRAM_Erase();
+
+/*!
+ * Cut the power of the FRAM after a number of bytes, FRAM_write drops the bytes after it.
+ * @param bytes still written, -1 to write every byte again.
+ */
+void HostFRAM_Cut(long bytes);
+
+/*!
+ * Set a state of the global parameters stand-in.
+ */
+void HostState_Set(int param, Boolean state);
+
+#endif /* HOSTSTANDINS_H_ */
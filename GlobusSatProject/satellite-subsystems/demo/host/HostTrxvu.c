@@ -0,0 +1,189 @@
+/*
+ * HostTrxvu.c
+ *
+ * TRXVU driver stand-in. the transmitter is a buffer of HOST_TX_SLOTS frames
+ * that go on the air one after the other at HOST_TX_BITRATE, the receiver
+ * gets the frames a benchmark scheduled, every driver call holds the task
+ * for the time its I2C transaction takes.
+ */
+
+#include <satellite-subsystems/IsisTRXVU.h>
+#include <string.h>
+
+#include "HostStandIns.h"
+
+static unsigned long long frame_ends[HOST_TX_SLOTS];	// time every buffered frame leaves the air, in order
+static int first_frame = 0;
+static int num_of_frames = 0;
+static ISIStrxvuBitrate tx_bitrate = trxvu_bitrate_9600;
+static HostTx_Stats tx_stats;
+static HostTx_Capture tx_capture = NULL;
+
+static unsigned long long rx_arrivals[HOST_RX_MAX_FRAMES];	// time every scheduled frame arrives, in order
+static unsigned short rx_lengths[HOST_RX_MAX_FRAMES];
+static int rx_scheduled = 0;
+static int rx_next = 0;		// next frame to take out of the buffer
+static HostRx_Stats rx_stats;
+
+static unsigned long long airTime(unsigned int length)
+{
+	unsigned int bitrate = tx_bitrate == trxvu_bitrate_1200 ? 1200 : HOST_TX_BITRATE;
+	return ((unsigned long long)(length + HOST_AX25_OVERHEAD) * 8 * 1000 + bitrate - 1) / bitrate;
+}
+
+//holds the task for an I2C transaction of 'length' bytes
+static unsigned long long i2cTime(unsigned int length)
+{
+	unsigned long long ms = ((unsigned long long)(length + HOST_I2C_OVERHEAD) * 9 * 1000 + HOST_I2C_CLOCK - 1) / HOST_I2C_CLOCK;
+	HostClock_Advance(ms);
+	return ms;
+}
+
+static void i2cTransaction(unsigned int length)
+{
+	tx_stats.i2c_transactions++;
+	tx_stats.i2c_ms += i2cTime(length);
+}
+
+//frames that arrived by now and were not taken out, up to the depth of the buffer
+static unsigned short rxFramesInBuffer()
+{
+	unsigned long long now = HostClock_Now();
+	int count = 0;
+	while (rx_next + count < rx_scheduled && rx_arrivals[rx_next + count] <= now && count < HOST_RX_SLOTS)
+		count++;
+	return (unsigned short)count;
+}
+
+//drops the frames that left the air by now
+static void updateBuffer()
+{
+	unsigned long long now = HostClock_Now();
+	while (num_of_frames > 0 && frame_ends[first_frame] <= now)
+	{
+		first_frame = (first_frame + 1) % HOST_TX_SLOTS;
+		num_of_frames--;
+	}
+}
+
+void HostTx_Reset()
+{
+	first_frame = 0;
+	num_of_frames = 0;
+	tx_bitrate = trxvu_bitrate_9600;
+	memset(&tx_stats, 0, sizeof(tx_stats));
+}
+
+void HostTx_GetStats(HostTx_Stats* stats)
+{
+	*stats = tx_stats;
+}
+
+void HostTx_SetCapture(HostTx_Capture capture)
+{
+	tx_capture = capture;
+}
+
+int IsisTrxvu_tcSendAX25DefClSign(unsigned char index, unsigned char *data, unsigned char length, unsigned char *avail)
+{
+	(void)index;
+	i2cTransaction(length);
+	updateBuffer();
+	if (num_of_frames >= HOST_TX_SLOTS)
+	{
+		tx_stats.refused++;
+		if (avail != NULL)
+			*avail = 0xFF;
+		return 0;
+	}
+	unsigned long long now = HostClock_Now();
+	unsigned long long start = num_of_frames > 0 ? frame_ends[(first_frame + num_of_frames - 1) % HOST_TX_SLOTS] : now;
+	if (start < now)
+		start = now;
+	if (tx_stats.frames == 0)
+		tx_stats.first_start = start;
+	unsigned long long end = start + airTime(length);
+	frame_ends[(first_frame + num_of_frames) % HOST_TX_SLOTS] = end;
+	num_of_frames++;
+	tx_stats.frames++;
+	tx_stats.bytes += length;
+	tx_stats.busy_ms += end - start;
+	tx_stats.last_end = end;
+	if (tx_capture != NULL)
+		tx_capture(data, length);
+	if (avail != NULL)
+		*avail = (unsigned char)(HOST_TX_SLOTS - num_of_frames);
+	return 0;
+}
+
+int IsisTrxvu_tcSetAx25Bitrate(unsigned char index, ISIStrxvuBitrate bitrate)
+{
+	(void)index;
+	i2cTransaction(1);
+	updateBuffer();
+	tx_stats.bitrate_sets++;
+	if (bitrate != tx_bitrate && num_of_frames > 0)
+		tx_stats.bitrate_changes_on_air++;
+	tx_bitrate = bitrate;
+	return 0;
+}
+
+unsigned short IsisTrxvu_tcEstimateTransmissionTime(unsigned char index, unsigned char length)
+{
+	(void)index;
+	return (unsigned short)airTime(length);
+}
+
+void HostRx_Reset()
+{
+	rx_scheduled = 0;
+	rx_next = 0;
+	memset(&rx_stats, 0, sizeof(rx_stats));
+}
+
+void HostRx_Schedule(unsigned long long at, unsigned short length)
+{
+	if (rx_scheduled >= HOST_RX_MAX_FRAMES)
+		return;
+	rx_arrivals[rx_scheduled] = at;
+	rx_lengths[rx_scheduled] = length;
+	rx_scheduled++;
+}
+
+void HostRx_GetStats(HostRx_Stats* stats)
+{
+	*stats = rx_stats;
+}
+
+int IsisTrxvu_rcGetFrameCount(unsigned char index, unsigned short *frameCount)
+{
+	(void)index;
+	rx_stats.count_reads++;
+	rx_stats.i2c_transactions++;
+	i2cTime(2);
+	*frameCount = rxFramesInBuffer();
+	return 0;
+}
+
+int IsisTrxvu_rcGetCommandFrame(unsigned char index, ISIStrxvuRxFrame *rx_frame)
+{
+	(void)index;
+	rx_stats.i2c_transactions++;
+	if (rxFramesInBuffer() == 0)
+	{
+		i2cTime(6);
+		rx_frame->rx_length = 0;
+		return 0;
+	}
+	unsigned short length = rx_lengths[rx_next];
+	i2cTime(6 + length);
+	unsigned long long latency = HostClock_Now() - rx_arrivals[rx_next];
+	rx_stats.latency_sum += latency;
+	if (latency > rx_stats.latency_max)
+		rx_stats.latency_max = latency;
+	rx_stats.frames++;
+	rx_frame->rx_length = length;
+	memset(rx_frame->rx_framedata, (unsigned char)rx_next, length);
+	rx_next++;
+	return 0;
+}
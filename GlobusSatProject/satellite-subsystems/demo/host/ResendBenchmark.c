@@ -0,0 +1,352 @@
+/*
+ * ResendBenchmark.c
+ *
+ * recovery of the frames a ground station missed in a dump. the dump goes
+ * through the sequencer of the dump manifest, the pipeline and the simulated
+ * transmitter to a ground station that loses frames at random and places the
+ * frames it got by the index frames. then the missing frames are asked for
+ * again, once with a new dump of the time range from the first missing record
+ * to the last, as before, and once with resend commands that carry a bitmap
+ * of the missing frames, until the ground has every frame.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "../src/sub-systemCode/TRXVU.h"
+#include "../src/sub-systemCode/COMM/Dump_pipeline.h"
+#include "../src/sub-systemCode/COMM/Dump_manifest.h"
+#include "../src/sub-systemCode/COMM/Tx_scheduler.h"
+#include "../src/sub-systemCode/COMM/splTypes.h"
+#include "HostStandIns.h"
+
+#define BENCH_RECORDS			4000	// records of the dumped file, one data frame each
+#define BENCH_RECORD_SIZE		49
+#define BENCH_SD_MS_PER_KB		2		// c_fileCursorNext of a window, like DumpBenchmark
+#define BENCH_RECORDS_IN_CHUNK	(DUMP_WINDOW_SIZE / (BENCH_RECORD_SIZE + TIME_SIZE))
+#define BENCH_MAX_ROUNDS		10
+#define BENCH_MAX_PENDING		(2 * DUMP_RANGE_SIZE)	// data frames the ground keeps until their index frame
+
+xSemaphoreHandle xIsTransmitting;
+
+static unsigned int random_state;
+
+static unsigned int next_random()
+{
+	random_state = random_state * 1103515245 + 12345;
+	return random_state >> 16;
+}
+
+//the file, every record a data frame, read in chunks from the time of a record
+
+typedef struct
+{
+	unsigned int end_record;
+	unsigned int record;		// next record
+	unsigned int chunk_start;	// first record of the chunk read
+	Boolean loaded;
+	unsigned int chunk_reads;
+} bench_source;
+
+static void read_chunk(bench_source *source, unsigned int from)
+{
+	source->chunk_start = from;
+	source->loaded = TRUE;
+	source->chunk_reads++;
+	HostClock_Advance(BENCH_RECORDS_IN_CHUNK * (BENCH_RECORD_SIZE + TIME_SIZE) * BENCH_SD_MS_PER_KB / 1024);
+}
+
+static uint8_t build_data_frame(unsigned int record, byte *frame)
+{
+	TM_spl_header header = { DUMP_T, EPS_DUMP_ST, BENCH_RECORD_SIZE, record };
+	write_TM_header(frame, &header, NULL);
+	unsigned int x = record * 2654435761u;
+	for (int b = 0; b < BENCH_RECORD_SIZE; b++)
+	{
+		x = x * 1103515245 + 12345;
+		SPL_TM_DATA(frame)[b] = (byte)(x >> 16);
+	}
+	return SPL_TM_HEADER_SIZE + BENCH_RECORD_SIZE;
+}
+
+static int bench_frame_source(void *context, byte *frame, uint8_t *length)
+{
+	bench_source *source = context;
+	if (source->record >= source->end_record)
+		return 0;
+	if (!source->loaded || source->record >= source->chunk_start + BENCH_RECORDS_IN_CHUNK)
+		read_chunk(source, source->record);
+	*length = build_data_frame(source->record, frame);
+	source->record++;
+	return 1;
+}
+
+static void bench_get_position(void *context, dump_position *position)
+{
+	bench_source *source = context;
+	position->file = 0;
+	position->parameter = (unsigned short)(source->loaded ? source->record - source->chunk_start : 0);
+	position->chunk_time = source->loaded ? source->chunk_start : source->record;
+	position->last_send = 0;
+}
+
+static int bench_set_position(void *context, const dump_position *position)
+{
+	bench_source *source = context;
+	read_chunk(source, position->chunk_time);
+	source->record = position->chunk_time + position->parameter;
+	return 0;
+}
+
+//the ground station
+
+typedef struct
+{
+	int loss;									// frames lost in every 1000
+	Boolean have[BENCH_RECORDS];
+	unsigned int received;						// frames that passed the loss, index frames included
+	byte pending[BENCH_MAX_PENDING][SIZE_TXFRAME];	// data frames since the last index frame
+	uint8_t pending_lengths[BENCH_MAX_PENDING];
+	int num_of_pending;
+	unsigned int wrong;							// frames placed that are not the frame of their place
+	Boolean by_time;							// a dump of a time range, the frames go by the time of their record
+} bench_ground;
+
+static bench_ground ground;
+
+static void place_frame(unsigned int sequence, byte *frame, uint8_t length)
+{
+	byte expected[SIZE_TXFRAME];
+	if (sequence >= BENCH_RECORDS)
+	{
+		ground.wrong++;
+		return;
+	}
+	if (build_data_frame(sequence, expected) != length || memcmp(expected, frame, length) != 0)
+		ground.wrong++;
+	ground.have[sequence] = TRUE;
+}
+
+static void ground_index(byte *frame)
+{
+	byte *data = SPL_TM_DATA(frame);
+	unsigned int first = BigEnE_raw_to_uShort(&data[2]);
+	int count = data[4];
+	int next = 0;
+	//the data frames since the last index frame, in their order in the range
+	for (int p = 0; p < ground.num_of_pending; p++)
+	{
+		unsigned int crc = dump_index_crc(ground.pending[p], ground.pending_lengths[p]);
+		for (int i = next; i < count; i++)
+		{
+			if (BigEnE_raw_to_uInt(&data[DUMP_INDEX_HEADER_SIZE + i * DUMP_INDEX_CRC_SIZE]) == crc)
+			{
+				place_frame(first + i, ground.pending[p], ground.pending_lengths[p]);
+				next = i + 1;
+				break;
+			}
+		}
+	}
+	ground.num_of_pending = 0;
+}
+
+static void ground_capture(unsigned char *frame, unsigned char length)
+{
+	if ((int)(next_random() % 1000) < ground.loss)
+		return;
+	ground.received++;
+	if (frame[1] == DUMP_INDEX_ST)
+	{
+		ground_index(frame);
+		return;
+	}
+	if (ground.by_time)
+	{
+		TM_spl_header header;
+		read_TM_header(frame, &header);
+		place_frame(header.time, frame, length);
+		return;
+	}
+	if (ground.num_of_pending < BENCH_MAX_PENDING)
+	{
+		memcpy(ground.pending[ground.num_of_pending], frame, length);
+		ground.pending_lengths[ground.num_of_pending] = length;
+		ground.num_of_pending++;
+	}
+}
+
+//missing as the ground knows it: the frames a seen index frame lists and it has not, every frame of a range without one
+static Boolean ground_missing(unsigned int sequence)
+{
+	return !ground.have[sequence];
+}
+
+static unsigned int count_missing()
+{
+	unsigned int missing = 0;
+	for (unsigned int s = 0; s < BENCH_RECORDS; s++)
+		missing += ground_missing(s) ? 1 : 0;
+	return missing;
+}
+
+//the dump
+
+typedef struct
+{
+	unsigned int frames;		// frames on the air, index frames included
+	unsigned long long air_ms;	// from the first frame to the last
+	unsigned int chunk_reads;
+	unsigned int commands;		// dump or resend commands the ground sent
+} bench_cost;
+
+static void add_cost(bench_cost *cost, bench_source *source)
+{
+	HostTx_Stats stats;
+	HostTx_GetStats(&stats);
+	cost->frames += stats.frames;
+	cost->air_ms += stats.busy_ms;
+	cost->chunk_reads += source->chunk_reads;
+	cost->commands++;
+}
+
+static void run_dump(unsigned int from_record, unsigned int to_record, bench_cost *cost)
+{
+	static dump_pipeline pipe;
+	static dump_sequencer seq;
+	bench_source source;
+	dump_manifest manifest;
+
+	memset(&source, 0, sizeof(source));
+	memset(&manifest, 0, sizeof(manifest));
+	source.record = from_record;
+	source.end_record = to_record;
+	manifest.frame_limit = SIZE_TXFRAME;
+	manifest.start_time = from_record;
+	manifest.end_time = to_record;
+	HostTx_Reset();
+	HostClock_Advance(60 * 1000);
+	begin_dump_sequence(&seq, &manifest, bench_frame_source, &source, bench_get_position, bench_set_position);
+	init_dump_pipeline(&pipe, next_sequenced_frame, &seq, xDumpQueue);
+	if (run_dump_pipeline(&pipe) != 0)
+		printf("run_dump_pipeline failed\n");
+	ground.num_of_pending = 0;
+	add_cost(cost, &source);
+}
+
+//one resend command for the missing frames from 'first', returns the frame after the bitmap
+static unsigned int run_resend(unsigned short dump_id, unsigned int first, bench_cost *cost)
+{
+	static dump_pipeline pipe;
+	static dump_sequencer seq;
+	bench_source source;
+	byte bitmap[DUMP_RESEND_MAX_BITMAP];
+	int bitmap_length = 0;
+
+	memset(bitmap, 0, sizeof(bitmap));
+	for (unsigned int s = first; s < BENCH_RECORDS && s < first + DUMP_RESEND_MAX_BITMAP * 8; s++)
+	{
+		if (ground_missing(s))
+		{
+			bitmap[(s - first) / 8] |= (byte)(0x80 >> ((s - first) % 8));
+			bitmap_length = (int)((s - first) / 8 + 1);
+		}
+	}
+
+	memset(&source, 0, sizeof(source));
+	source.end_record = BENCH_RECORDS;
+	HostTx_Reset();
+	HostClock_Advance(60 * 1000);
+	if (begin_dump_resend(&seq, dump_id, first, bitmap, bitmap_length) != 0)
+	{
+		printf("begin_dump_resend failed\n");
+		return BENCH_RECORDS;
+	}
+	dump_sequence_source(&seq, bench_frame_source, &source, bench_get_position, bench_set_position);
+	init_dump_pipeline(&pipe, next_sequenced_frame, &seq, xDumpQueue);
+	if (run_dump_pipeline(&pipe) != 0)
+		printf("run_dump_pipeline failed\n");
+	ground.num_of_pending = 0;
+	add_cost(cost, &source);
+	return first + DUMP_RESEND_MAX_BITMAP * 8;
+}
+
+static void reset_ground(int loss)
+{
+	memset(&ground, 0, sizeof(ground));
+	ground.loss = loss;
+}
+
+static void print_cost(const char *title, int loss, const bench_cost *dump, const bench_cost *recovery, int rounds, unsigned int missing)
+{
+	printf("%4.1f%%  %-10s %7u %9u %10.1f %8u %7d %9u %6u\n", loss / 10.0, title, dump->frames - BENCH_RECORDS,
+			recovery->frames, recovery->air_ms / 1000.0, recovery->chunk_reads, rounds, missing, ground.wrong);
+}
+
+int main()
+{
+	static const int losses[] = { 10, 50, 100 };
+	dump_manifest manifest;
+
+	vSemaphoreCreateBinary(xIsTransmitting);
+	xDumpQueue = xQueueCreate(1, sizeof(queueRequest));
+	init_Tx_scheduler();
+	HostTx_SetCapture(ground_capture);
+
+	printf("dump of %u records, one data frame each, %d data frames a range\n", BENCH_RECORDS, DUMP_RANGE_SIZE);
+	printf("%-5s  %-10s %7s %9s %10s %8s %7s %9s %6s\n", "loss", "recovery", "index", "frames",
+			"air [s]", "chunks", "rounds", "missing", "wrong");
+	for (unsigned int l = 0; l < sizeof(losses) / sizeof(losses[0]); l++)
+	{
+		bench_cost dump, recovery;
+		unsigned int missing;
+		int rounds;
+
+		// 1. a new dump of the time range from the first missing record to the last
+		random_state = 1000 + l;
+		reset_ground(losses[l]);
+		memset(&dump, 0, sizeof(dump));
+		memset(&recovery, 0, sizeof(recovery));
+		run_dump(0, BENCH_RECORDS, &dump);
+		ground.by_time = TRUE;
+		for (rounds = 0; rounds < BENCH_MAX_ROUNDS && count_missing() > 0; rounds++)
+		{
+			unsigned int first = 0, last = BENCH_RECORDS - 1;
+			while (!ground_missing(first))
+				first++;
+			while (!ground_missing(last))
+				last--;
+			run_dump(first, last + 1, &recovery);
+		}
+		missing = count_missing();
+		print_cost("re-dump", losses[l], &dump, &recovery, rounds, missing);
+
+		// 2. resend commands with the bitmap of the missing frames
+		random_state = 1000 + l;
+		reset_ground(losses[l]);
+		memset(&dump, 0, sizeof(dump));
+		memset(&recovery, 0, sizeof(recovery));
+		run_dump(0, BENCH_RECORDS, &dump);
+		load_dump_manifest(&manifest);
+		for (rounds = 0; rounds < BENCH_MAX_ROUNDS && count_missing() > 0; rounds++)
+		{
+			unsigned int first = 0;
+			while (first < BENCH_RECORDS)
+			{
+				while (first < BENCH_RECORDS && !ground_missing(first))
+					first++;
+				if (first >= BENCH_RECORDS)
+					break;
+				first = run_resend(manifest.dump_id, first, &recovery);
+			}
+		}
+		missing = count_missing();
+		print_cost("resend", losses[l], &dump, &recovery, rounds, missing);
+	}
+	printf("\nindex: index frames of the dump, frames: frames of the recovery, index frames included,\n"
+			"air [s]: time on the air of the recovery, chunks: windows the cursor read for the recovery,\n"
+			"rounds: times the ground asked again for what it still missed, wrong: frames placed in the wrong place\n");
+	return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * RxBenchmark.c
+ *
+ * an orbit of the simulated receiver: an idle part with no uplink, then a
+ * pass with bursts of commands. runs the Rx loop TRXVU_task had before the
+ * Rx engine and the Rx engine, and reports the I2C transactions of the idle
+ * part and the latency of the commands in the pass.
+ */
+
+#include <stdio.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <satellite-subsystems/IsisTRXVU.h>
+
+#include "../src/sub-systemCode/Global/GlobalParam.h"
+#include "../src/sub-systemCode/COMM/Rx_engine.h"
+#include "HostStandIns.h"
+
+#define BENCH_IDLE_MS			(85 * 60 * 1000)	// out of a pass
+#define BENCH_PASS_MS			(10 * 60 * 1000)
+#define BENCH_BURST_PERIOD_MS	(20 * 1000)			// the ground station sends a burst every 20 s
+#define BENCH_FRAME_LENGTH		40					// bytes of a command frame
+#define BENCH_UPLINK_BITRATE	9600
+#define BENCH_HANDLE_MS			3					// decode, receive ACK and add_command of a frame
+#define BENCH_GROUND_PASSING_MS	(10 * 60 * 1000)	// GROUND_PASSING_TIME
+
+typedef struct
+{
+	const char* title;
+	int frames_in_burst;
+} bench_scenario;
+
+static const bench_scenario scenarios[] =
+{
+	{ "single commands", 1 },
+	{ "bursts of 5", 5 },
+	{ "bursts of 20", 20 },
+};
+
+static unsigned long long ground_conn_start;
+
+static void handle_frame(byte *frame, unsigned int length)
+{
+	(void)frame;
+	(void)length;
+	HostClock_Advance(BENCH_HANDLE_MS);
+	if (!get_ground_conn())
+		ground_conn_start = HostClock_Now();
+	set_ground_conn(TRUE);
+}
+
+//pass_above_Ground
+static void end_pass()
+{
+	if (get_ground_conn() && HostClock_Now() > ground_conn_start + BENCH_GROUND_PASSING_MS)
+		set_ground_conn(FALSE);
+}
+
+static unsigned long long schedule_orbit(const bench_scenario* scenario)
+{
+	unsigned long long start = HostClock_Now();
+	unsigned long long frame_ms = (BENCH_FRAME_LENGTH + 20) * 8 * 1000 / BENCH_UPLINK_BITRATE;
+	HostRx_Reset();
+	set_ground_conn(FALSE);
+	for (unsigned long long burst = BENCH_IDLE_MS; burst < BENCH_IDLE_MS + BENCH_PASS_MS; burst += BENCH_BURST_PERIOD_MS)
+		for (int i = 0; i < scenario->frames_in_burst; i++)
+			HostRx_Schedule(start + burst + (i + 1) * frame_ms, BENCH_FRAME_LENGTH);
+	return start;
+}
+
+//Rx_logic, TRX_getFrameData and the loop of TRXVU_task as they were before the Rx engine
+static void legacy_Rx_logic()
+{
+	byte frame[SIZE_RXFRAME];
+	unsigned short RxCounter = 0;
+	ISIStrxvuRxFrame rxFrameCmd = { 0, 0, 0, frame };
+	IsisTrxvu_rcGetFrameCount(0, &RxCounter);
+	if (RxCounter > 0)
+	{
+		IsisTrxvu_rcGetFrameCount(0, &RxCounter);
+		if (RxCounter > 0)
+		{
+			IsisTrxvu_rcGetCommandFrame(0, &rxFrameCmd);
+			handle_frame(frame, rxFrameCmd.rx_length);
+		}
+	}
+}
+
+static void print_result(const char* title, const char* version, const HostRx_Stats* idle, const HostRx_Stats* all, unsigned int frames)
+{
+	unsigned int pass_frames = all->frames - idle->frames;
+	printf("%-16s %-9s %10.1f %9u/%-5u %9.1f %8llu %10.1f\n", title, version,
+			idle->i2c_transactions * 60000.0 / BENCH_IDLE_MS,
+			all->frames, frames,
+			pass_frames > 0 ? (double)(all->latency_sum - idle->latency_sum) / pass_frames : 0,
+			all->latency_max,
+			(all->i2c_transactions - idle->i2c_transactions) * 1000.0 / BENCH_PASS_MS);
+}
+
+static void run(const bench_scenario* scenario, Boolean engine)
+{
+	unsigned long long start = schedule_orbit(scenario);
+	HostRx_Stats idle, all;
+	Boolean idle_done = FALSE;
+	while (HostClock_Now() < start + BENCH_IDLE_MS + BENCH_PASS_MS + 1000)
+	{
+		if (!idle_done && HostClock_Now() >= start + BENCH_IDLE_MS)
+		{
+			HostRx_GetStats(&idle);
+			idle_done = TRUE;
+		}
+		if (engine)
+		{
+			drain_Rx_frames(handle_frame);
+			end_pass();
+			vTaskDelay(Rx_poll_delay());
+		}
+		else
+		{
+			legacy_Rx_logic();
+			end_pass();
+			vTaskDelay(TASK_DELAY);
+		}
+	}
+	HostRx_GetStats(&all);
+	print_result(scenario->title, engine ? "engine" : "before", &idle, &all,
+			scenario->frames_in_burst * (BENCH_PASS_MS / BENCH_BURST_PERIOD_MS));
+}
+
+int main()
+{
+	printf("%-16s %-9s %10s %15s %9s %8s %10s\n", "", "", "idle I2C/m", "frames", "mean [ms]", "max [ms]", "pass I2C/s");
+	for (unsigned int i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+	{
+		run(&scenarios[i], FALSE);
+		run(&scenarios[i], TRUE);
+	}
+	printf("\nidle I2C/m: I2C transactions of the receiver per minute out of a pass,\n"
+			"mean, max: ms from the arrival of a frame until it was taken out of the buffer,\n"
+			"pass I2C/s: I2C transactions of the receiver per second in the pass\n");
+	return 0;
+}
@@ -0,0 +1,302 @@
+/*
+ * TlmBenchmark.c
+ *
+ * runs the flight TLM_management.c on the FAT stand-in of HostFAT.c, every
+ * file of the SD is a file in a directory of the host. writes a day of HK to
+ * c_files the way the HK task does, one record every TASK_HK_HIGH_RATE_DELAY,
+ * the compressed EPS c_file a day after the raw one. dumps the last orbit of
+ * it with c_fileRead and with a cursor, and reports the FRAM bytes, the
+ * estimated FRAM time, the file opens and the SD bytes per record and per run.
+ * checks both EPS c_files read back the records as written, and that a reboot
+ * keeps them.
+ * usage: tlm_bench [SD directory]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "../src/sub-systemCode/Global/TLM_management.h"
+#include "HostStandIns.h"
+
+#define BENCH_SD_ROOT				"build/sd"
+
+#define BENCH_RAW_C_FILE_NAME		"raw"
+#define BENCH_RAW_SIZE				12		// size of a small HK record
+#define BENCH_EPS_C_FILE_NAME		"eps"
+#define BENCH_EPS_Z_C_FILE_NAME		"epsz"
+#define BENCH_EPS_HK_SIZE			49		// EPS_HK_SIZE, 21 voltages and currents, the uptime and 3 states
+#define BENCH_EPS_HK_NUM_OF_FIELDS	25
+
+#define BENCH_SAVE_PERIOD			1		// seconds, TASK_HK_HIGH_RATE_DELAY
+#define BENCH_ORBIT_PERIOD			5400	// seconds
+#define BENCH_ORBIT_SUNLIGHT		3600	// seconds of every orbit in sunlight
+#define BENCH_DAY_NUM_OF_RECORDS	(24 * 60 * 60 / BENCH_SAVE_PERIOD)
+#define BENCH_ORBIT_NUM_OF_RECORDS	(BENCH_ORBIT_PERIOD / BENCH_SAVE_PERIOD)
+#define BENCH_CURSOR_WINDOW			20		// records per c_fileCursorNext, ~1KB of EPS HK
+#define BENCH_MAX_NUM_OF_RESULTS	16
+
+//layout of the EPS HK record, as EPS_HK_fields of HouseKeeping.c
+static const unsigned char eps_fields[BENCH_EPS_HK_NUM_OF_FIELDS] =
+		{ 2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2, 4,1,1,1 };
+
+typedef void (*BenchRecordGenerator)(unsigned int i, unsigned char* record);
+
+typedef struct
+{
+	const char* title;
+	unsigned int records;
+	HostFRAM_Stats fram;
+	HostSD_Stats sd;
+} BenchResult;
+
+static BenchResult results[BENCH_MAX_NUM_OF_RESULTS];
+static int num_of_results = 0;
+
+static void begin_measure()
+{
+	HostFRAM_ResetStats();
+	HostSD_ResetStats();
+}
+
+static void end_measure(const char* title, unsigned int records)
+{
+	if (num_of_results >= BENCH_MAX_NUM_OF_RESULTS)
+		return;
+	BenchResult* result = &results[num_of_results++];
+	result->title = title;
+	result->records = records;
+	HostFRAM_GetStats(&result->fram);
+	HostSD_GetStats(&result->sd);
+}
+
+static double per_record(double value, unsigned int records)
+{
+	return records > 0 ? value / records : 0;
+}
+
+static void print_results()
+{
+	printf("\n%-28s %8s %9s %9s %9s %9s %10s %10s %9s\n", "per record", "records", "FRAM W B",
+			"FRAM R B", "FRAM us", "opens", "SD W B", "SD R B", "seeks");
+	for (int i = 0; i < num_of_results; i++)
+	{
+		BenchResult* result = &results[i];
+		unsigned int records = result->records;
+		printf("%-28s %8u %9.2f %9.2f %9.2f %9.4f %10.2f %10.2f %9.4f\n", result->title, records,
+				per_record(result->fram.bytes_written, records),
+				per_record(result->fram.bytes_read, records),
+				per_record(HostFRAM_EstimateLatency(&result->fram), records),
+				per_record(result->sd.opens, records),
+				per_record(result->sd.bytes_written, records),
+				per_record(result->sd.bytes_read, records),
+				per_record(result->sd.seeks, records));
+	}
+
+	printf("\n%-28s %9s %9s %10s %7s %7s %10s %7s %10s %7s\n", "per run", "FRAM W B", "FRAM R B",
+			"FRAM us", "opens", "writes", "SD W B", "reads", "SD R B", "seeks");
+	for (int i = 0; i < num_of_results; i++)
+	{
+		BenchResult* result = &results[i];
+		printf("%-28s %9u %9u %10.0f %7u %7u %10u %7u %10u %7u\n", result->title,
+				result->fram.bytes_written, result->fram.bytes_read,
+				HostFRAM_EstimateLatency(&result->fram), result->sd.opens, result->sd.writes,
+				result->sd.bytes_written, result->sd.reads, result->sd.bytes_read, result->sd.seeks);
+	}
+}
+
+static void get_raw_record(unsigned int i, unsigned char* record)
+{
+	memset(record, 0, BENCH_RAW_SIZE);
+	memcpy(record, &i, sizeof(i));
+}
+
+//synthetic EPS HK of an orbit: voltages that ramp up in sunlight and down in eclipse,
+//a flickering LSB, the uptime and a few state bytes
+static void get_eps_record(unsigned int i, unsigned char* record)
+{
+	unsigned int time = i * BENCH_SAVE_PERIOD;
+	unsigned int phase = time % BENCH_ORBIT_PERIOD;
+	Boolean sunlight = phase < BENCH_ORBIT_SUNLIGHT;
+	unsigned int ramp = sunlight ? phase / 60 : (BENCH_ORBIT_PERIOD - phase) / 30;
+	for (unsigned int field = 0; field < 21; field++)
+	{
+		unsigned short value = 4000 + 100 * field + ramp + ((i * 7 + field) % 11 == 0);
+		memcpy(record + 2 * field, &value, sizeof(value));
+	}
+	memcpy(record + 42, &time, sizeof(time));
+	record[46] = 3;
+	record[47] = sunlight;
+	record[48] = 0;
+}
+
+//write a day of records the way the HK task does, a record every BENCH_SAVE_PERIOD and
+//c_fileFlushExpired after it. returns the time of the first record
+static time_unix write_day(char* c_file_name, BenchRecordGenerator generator, const char* title)
+{
+	unsigned char record[C_FILE_MAX_COMPRESSED_ELEMENT_SIZE];
+	time_unix start_time = 0;
+	int handle = c_fileOpenHandle(c_file_name);
+
+	Time_getUnixEpoch(&start_time);
+	begin_measure();
+	for (unsigned int i = 0; i < BENCH_DAY_NUM_OF_RECORDS; i++)
+	{
+		generator(i, record);
+		c_fileWriteByHandle(handle, record);
+		HostClock_Advance(BENCH_SAVE_PERIOD * 1000);
+		c_fileFlushExpired();
+	}
+	c_fileFlushAll();
+	end_measure(title, BENCH_DAY_NUM_OF_RECORDS);
+	return start_time;
+}
+
+static void dump_with_read(char* c_file_name, int size_of_record, time_unix from_time, time_unix to_time,
+		const char* title)
+{
+	int size_of_buffer = BENCH_ORBIT_NUM_OF_RECORDS * (size_of_record + sizeof(unsigned int));
+	byte* buffer = malloc(size_of_buffer);
+	int read = 0;
+	time_unix last_read_time = 0;
+	if (buffer == NULL)
+		return;
+	begin_measure();
+	if (c_fileRead(c_file_name, buffer, size_of_buffer, from_time, to_time, &read, &last_read_time) != FS_SUCCSESS)
+		printf("%s: c_fileRead failed\n", title);
+	end_measure(title, read);
+	free(buffer);
+}
+
+static void dump_with_cursor(char* c_file_name, time_unix from_time, time_unix to_time, const char* title)
+{
+	byte buffer[BENCH_CURSOR_WINDOW * (C_FILE_MAX_COMPRESSED_ELEMENT_SIZE + sizeof(unsigned int))];
+	C_FILE_CURSOR cursor;
+	unsigned int records = 0;
+	int read = 0;
+	begin_measure();
+	if (c_fileCursorOpen(c_file_name, from_time, to_time, &cursor) != FS_SUCCSESS)
+	{
+		printf("%s: c_fileCursorOpen failed\n", title);
+		return;
+	}
+	do
+	{
+		if (c_fileCursorNext(&cursor, buffer, BENCH_CURSOR_WINDOW, &read) != FS_SUCCSESS)
+		{
+			printf("%s: c_fileCursorNext failed\n", title);
+			break;
+		}
+		records += read;
+	} while (read == BENCH_CURSOR_WINDOW);
+	c_fileCursorClose(&cursor);
+	end_measure(title, records);
+}
+
+//read the range of an EPS HK c_file and check every record is the one get_eps_record made,
+//by the uptime in the record, and the records are in order
+static Boolean check_eps_records(char* c_file_name, time_unix from_time, time_unix to_time, int* num_of_records)
+{
+	int size_of_record_with_time = BENCH_EPS_HK_SIZE + sizeof(unsigned int);
+	int size_of_buffer = BENCH_ORBIT_NUM_OF_RECORDS * size_of_record_with_time;
+	byte* buffer = malloc(size_of_buffer);
+	unsigned char record[BENCH_EPS_HK_SIZE];
+	int read = 0;
+	time_unix last_read_time;
+	unsigned int last_uptime = 0;
+	Boolean same = FALSE;
+	if (buffer != NULL
+			&& c_fileRead(c_file_name, buffer, size_of_buffer, from_time, to_time, &read, &last_read_time) == FS_SUCCSESS)
+	{
+		same = read > 0;
+		for (int i = 0; same && i < read; i++)
+		{
+			byte* read_record = buffer + i * size_of_record_with_time + sizeof(unsigned int);
+			unsigned int uptime;
+			memcpy(&uptime, read_record + 42, sizeof(uptime));
+			get_eps_record(uptime / BENCH_SAVE_PERIOD, record);
+			same = memcmp(record, read_record, BENCH_EPS_HK_SIZE) == 0
+					&& (i == 0 || uptime == last_uptime + BENCH_SAVE_PERIOD);
+			last_uptime = uptime;
+		}
+	}
+	*num_of_records = read;
+	free(buffer);
+	return same;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* sd_root = argc > 1 ? argv[1] : BENCH_SD_ROOT;
+
+	mkdir(sd_root, 0755);
+	if (HostSD_Init(sd_root, 1) != 0)
+	{
+		printf("can't use '%s' as the SD\n", sd_root);
+		return 1;
+	}
+	HostFRAM_Erase();
+
+	begin_measure();
+	if (InitializeFS(TRUE) != FS_SUCCSESS)
+	{
+		printf("InitializeFS failed\n");
+		return 1;
+	}
+	printf("\n");
+	end_measure("boot (InitializeFS)", 0);
+
+	if (c_fileCreate(BENCH_RAW_C_FILE_NAME, BENCH_RAW_SIZE) != FS_SUCCSESS
+			|| c_fileCreate(BENCH_EPS_C_FILE_NAME, BENCH_EPS_HK_SIZE) != FS_SUCCSESS
+			|| c_fileCreateCompressed(BENCH_EPS_Z_C_FILE_NAME, BENCH_EPS_HK_SIZE, (unsigned char*)eps_fields,
+					BENCH_EPS_HK_NUM_OF_FIELDS) != FS_SUCCSESS)
+	{
+		printf("c_fileCreate failed\n");
+		return 1;
+	}
+
+	c_fileSetFlushDeadline(0);
+	write_day(BENCH_RAW_C_FILE_NAME, get_raw_record, "write raw 12B, deadline 0");
+	c_fileReset(BENCH_RAW_C_FILE_NAME);
+	c_fileSetFlushDeadline(C_FILE_DEFAULT_FLUSH_DEADLINE);
+	write_day(BENCH_RAW_C_FILE_NAME, get_raw_record, "write raw 12B");
+
+	//the compressed c_file gets the same day of records, a day later
+	time_unix start_time = write_day(BENCH_EPS_C_FILE_NAME, get_eps_record, "write EPS HK 49B");
+	time_unix later = write_day(BENCH_EPS_Z_C_FILE_NAME, get_eps_record, "write EPS HK 49B compressed") - start_time;
+
+	//dump the last orbit of the day
+	time_unix from_time = start_time + (BENCH_DAY_NUM_OF_RECORDS - BENCH_ORBIT_NUM_OF_RECORDS) * BENCH_SAVE_PERIOD;
+	time_unix to_time = start_time + (BENCH_DAY_NUM_OF_RECORDS - 1) * BENCH_SAVE_PERIOD;
+	dump_with_read(BENCH_EPS_C_FILE_NAME, BENCH_EPS_HK_SIZE, from_time, to_time, "dump EPS, c_fileRead");
+	dump_with_cursor(BENCH_EPS_C_FILE_NAME, from_time, to_time, "dump EPS, cursor");
+	dump_with_cursor(BENCH_EPS_Z_C_FILE_NAME, from_time + later, to_time + later, "dump EPS compressed, cursor");
+	int num_of_records = 0, num_of_compressed_records = 0;
+	Boolean kept = check_eps_records(BENCH_EPS_C_FILE_NAME, from_time, to_time, &num_of_records);
+	Boolean kept_compressed = check_eps_records(BENCH_EPS_Z_C_FILE_NAME, from_time + later, to_time + later,
+			&num_of_compressed_records);
+
+	begin_measure();
+	InitializeFS(FALSE);
+	printf("\n");
+	end_measure("reboot (InitializeFS)", 0);
+	int rebooted_num_of_records = 0;
+	Boolean kept_rebooted = check_eps_records(BENCH_EPS_Z_C_FILE_NAME, from_time + later, to_time + later,
+			&rebooted_num_of_records) && rebooted_num_of_records == num_of_compressed_records;
+	print_results();
+
+	unsigned int size = c_fileGetSize(BENCH_EPS_C_FILE_NAME);
+	unsigned int compressed_size = c_fileGetSize(BENCH_EPS_Z_C_FILE_NAME);
+	printf("\nSD: EPS HK %u bytes, compressed %u bytes, %.2f of it\n", size, compressed_size,
+			size > 0 ? (double)compressed_size / size : 0);
+	printf("last orbit: EPS HK %d records %s, compressed %d records %s, %s after the reboot\n",
+			num_of_records, kept ? "as written" : "NOT as written",
+			num_of_compressed_records, kept_compressed ? "as written" : "NOT as written",
+			kept_rebooted ? "kept" : "NOT kept");
+	printf("\nFRAM us: estimate at %d Hz SPI, %d us and %d command bytes for every access\n",
+			HOST_FRAM_SPI_CLOCK, HOST_FRAM_TRANSACTION_US, HOST_FRAM_COMMAND_SIZE);
+	printf("opens: f_open calls, SD W B and SD R B: bytes written to and read from the SD, the orbit is\n"
+			"fewer records than its seconds as the SD time delays the HK task\n");
+	return kept && kept_compressed && kept_rebooted ? 0 : 1;
+}
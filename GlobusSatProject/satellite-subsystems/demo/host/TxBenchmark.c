@@ -0,0 +1,144 @@
+/*
+ * TxBenchmark.c
+ *
+ * sends the frames of 30 minutes of beacons, receive ACKs and an APRS dump
+ * through the simulated transmitter, once with TRX_sendFrame as it was
+ * before the Tx scheduler and once through the Tx scheduler, and reports the
+ * I2C transactions, bitrate changes and time the sending task was held.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "../src/sub-systemCode/TRXVU.h"
+#include "../src/sub-systemCode/COMM/Tx_scheduler.h"
+#include "HostStandIns.h"
+
+#define BENCH_TIME_MS			(30 * 60 * 1000)
+#define BENCH_BEACON_PERIOD_MS	(20 * 1000)		// DEFULT_BEACON_DELAY
+#define BENCH_BURST_PERIOD_MS	(20 * 1000)
+#define BENCH_BEACON_SIZE		(BEACON_LENGTH + SPL_TM_HEADER_SIZE)
+#define BENCH_NUM_OF_APRS		20				// packets in the APRS list, each sent twice
+#define BENCH_TRANSMMIT_DELAY_1200	(20 * 100)	// TRANSMMIT_DELAY_1200
+
+xSemaphoreHandle xIsTransmitting;
+
+typedef struct
+{
+	const char* title;
+	int acks_in_burst;		// receive ACKs of a batch of commands, every BENCH_BURST_PERIOD_MS
+	Boolean APRS_dump;		// an APRS dump in every burst
+} bench_scenario;
+
+static const bench_scenario scenarios[] =
+{
+	{ "beacons", 0, FALSE },
+	{ "beacons + 5 ACKs", 5, FALSE },
+	{ "beacons + APRS dump", 1, TRUE },
+};
+
+static unsigned long long held_ms;	// time the sending task was held in the send functions
+
+//TRX_sendFrame as it was before the Tx scheduler
+static void legacy_sendFrame(byte* data, uint8_t length, ISIStrxvuBitrate bitRate)
+{
+	int retVal = 0;
+	xSemaphoreTake(xIsTransmitting, MAX_DELAY);
+	if (bitRate != trxvu_bitrate_9600)
+		IsisTrxvu_tcSetAx25Bitrate(0, bitRate);
+	unsigned char avalFrames = VALUE_TX_BUFFER_FULL;
+	int count = 0;
+	do
+	{
+		IsisTrxvu_tcSendAX25DefClSign(0, data, length, &avalFrames);
+		retVal = 0;
+		if (count % 10 == 1)
+		{
+			vTaskDelay((portTickType)(length * 20));
+			retVal = -1;
+		}
+		count++;
+	}while(avalFrames == VALUE_TX_BUFFER_FULL);
+	if (bitRate == trxvu_bitrate_1200 && retVal == 0)
+		vTaskDelay(BENCH_TRANSMMIT_DELAY_1200);
+	IsisTrxvu_tcSetAx25Bitrate(0, trxvu_bitrate_9600);
+	xSemaphoreGive(xIsTransmitting);
+}
+
+static void send(Boolean scheduler, int frames, uint8_t length, ISIStrxvuBitrate bitrate, tx_priority priority)
+{
+	byte frame[SIZE_TXFRAME];
+	unsigned long long start = HostClock_Now();
+	memset(frame, 0, sizeof(frame));
+	for (int i = 0; i < frames; i++)
+	{
+		if (scheduler)
+			Tx_schedule_frame(frame, length, bitrate, priority);
+		else
+			legacy_sendFrame(frame, length, bitrate);
+	}
+	if (scheduler)
+		Tx_flush_frames();
+	held_ms += HostClock_Now() - start;
+}
+
+static void run(const bench_scenario* scenario, Boolean scheduler)
+{
+	unsigned long long start = HostClock_Now();
+	unsigned long long next_beacon = start, next_burst = start + BENCH_BURST_PERIOD_MS / 2;
+	int beacon_count = 0;
+	HostTx_Stats stats;
+
+	held_ms = 0;
+	while (next_beacon < start + BENCH_TIME_MS)
+	{
+		if (next_beacon <= next_burst)
+		{
+			if (HostClock_Now() < next_beacon)
+				HostClock_Advance(next_beacon - HostClock_Now());
+			//Beacon_task, every third beacon in 1200
+			send(scheduler, 1, BENCH_BEACON_SIZE, beacon_count % 3 == 0 ? trxvu_bitrate_1200 : trxvu_bitrate_9600, tx_priority_beacon);
+			beacon_count++;
+			next_beacon += BENCH_BEACON_PERIOD_MS;
+			continue;
+		}
+		if (HostClock_Now() < next_burst)
+			HostClock_Advance(next_burst - HostClock_Now());
+		if (scenario->acks_in_burst > 0)
+			send(scheduler, scenario->acks_in_burst, ACK_RAW_SIZE, trxvu_bitrate_9600, tx_priority_ACK);
+		if (scenario->APRS_dump)
+			send(scheduler, 2 * BENCH_NUM_OF_APRS, APRS_SIZE_WITH_TIME + SPL_TM_HEADER_SIZE, trxvu_bitrate_9600, tx_priority_APRS);
+		next_burst += BENCH_BURST_PERIOD_MS;
+	}
+
+	HostTx_GetStats(&stats);
+	printf("%-22s %-9s %7u %9u %9u %11u %11.1f\n", scenario->title, scheduler ? "scheduler" : "before",
+			stats.frames, stats.i2c_transactions, stats.bitrate_sets, stats.bitrate_changes_on_air, held_ms / 1000.0);
+}
+
+int main()
+{
+	vSemaphoreCreateBinary(xIsTransmitting);
+	init_Tx_scheduler();
+
+	printf("%-22s %-9s %7s %9s %9s %11s %11s\n", "", "", "frames", "Tx I2C", "rate sets", "on air chg", "held [s]");
+	for (unsigned int i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+	{
+		for (int scheduler = 0; scheduler < 2; scheduler++)
+		{
+			//both start in 9600 with an empty transmitter
+			HostClock_Advance(60 * 1000);
+			Tx_set_bitrate(trxvu_bitrate_9600);
+			HostTx_Reset();
+			run(&scenarios[i], scheduler);
+		}
+	}
+	printf("\nTx I2C: I2C transactions of the transmitter, rate sets: IsisTrxvu_tcSetAx25Bitrate calls,\n"
+			"on air chg: bitrate changes while frames of the other bitrate were still in the buffer,\n"
+			"held: time the sending tasks were held in the send functions\n");
+	return 0;
+}
@@ -0,0 +1,8 @@
+/*
+ * Boolean.h
+ *
+ * TLM_management.h includes hal/Boolean.h, the name it has on the
+ * case-insensitive file system of the IDE.
+ */
+
+#include <hal/boolean.h>
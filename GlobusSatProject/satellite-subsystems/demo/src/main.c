@@ -65,15 +65,13 @@ void save_time()
 
 void Command_logic()
 {
-	TC_spl command;
-	int error = 0;
-	do
+	TC_spl *command;
+	//every command is executed from its slot, the slot is free after it
+	while ((command = peek_command()) != NULL)
 	{
-		error = get_command(&command);
-		if (error == 0)
-			act_upon_command(command);
+		act_upon_command(command);
+		release_command();
 	}
-	while (error == 0);
 }
 
 void taskMain()
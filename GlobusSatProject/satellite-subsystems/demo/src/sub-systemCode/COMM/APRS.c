@@ -11,6 +11,7 @@
 #include "APRS.h"
 #include "GSC.h"
 #include "../TRXVU.h"
+#include "Tx_scheduler.h"
 
 static byte APRS_list[APRS_SIZE_WITH_TIME * MAX_NAMBER_OF_APRS_PACKETS];
 
@@ -44,6 +45,10 @@ int send_APRS_Dump()
 	// 1. Get the list of APRS packets and number of packets from the FRAM
 	i_error = FRAM_read(&numberOfAPRS, NUMBER_PACKET_APRS_ADDR, sizeof(numberOfAPRS));
 	check_int("send_APRS_Dump, FRAM_read", i_error);
+	if (numberOfAPRS > MAX_NAMBER_OF_APRS_PACKETS)
+	{
+		numberOfAPRS = MAX_NAMBER_OF_APRS_PACKETS;
+	}
 	i_error =FRAM_read(APRS_list, APRS_PACKETS_ADDR, (numberOfAPRS * APRS_SIZE_WITH_TIME));
 	check_int("send_APRS_Dump, FRAM_read", i_error);
 
@@ -52,33 +57,28 @@ int send_APRS_Dump()
 		return 1;
 	}
 
-	time_unix time_now;
-	byte rawData[APRS_SIZE_WITH_TIME + 8];
+	byte rawData[APRS_SIZE_WITH_TIME + SPL_TM_HEADER_SIZE];
 	int rawDataLength = 0;
 
-	TM_spl packet;
-	packet.type = APRS;
-	packet.subType = APRS_PACKET_FRAM;
-	packet.length = APRS_SIZE_WITH_TIME;
+	TM_spl_header packet = { APRS, APRS_PACKET_FRAM, APRS_SIZE_WITH_TIME, 0 };
 
 	// 2. Going throw every packet on the list
 	int i, j;
 	for (i = 0; i < numberOfAPRS; i++)
 	{
-		// 3. Insert data to packet
-		memcpy(packet.data, APRS_list, APRS_SIZE_WITH_TIME);
-
-		i_error = Time_getUnixEpoch(&time_now);	//get time
+		// 3. Insert data to the frame
+		i_error = Time_getUnixEpoch(&packet.time);	//get time
 		check_int("send_APRS_Dump, Time_getUnixEpoch", i_error);
-		packet.time = time_now;
+		write_TM_header(rawData, &packet, &rawDataLength);
+		memcpy(SPL_TM_DATA(rawData), APRS_list + i * APRS_SIZE_WITH_TIME, APRS_SIZE_WITH_TIME);
 
-		encode_TMpacket(rawData, &rawDataLength, packet);
 		// 4. Sends packet twice
 		for (j = 0; j < 2; j++)
 		{
-			TRX_sendFrame(rawData, (unsigned char)rawDataLength, trxvu_bitrate_9600);
+			Tx_schedule_frame(rawData, (unsigned char)rawDataLength, trxvu_bitrate_9600, tx_priority_APRS);
 		}
 	}
+	Tx_flush_frames();
 
 	// 5. Reseting the APRS list in the FRAM
 	reset_APRS_list(FALSE);
@@ -100,30 +100,13 @@ int check_APRS(unsigned char* data)
 		//3. save APRS Packet in the FRAM list
 		uint8_t number_of_APRS_save = 0;
 		FRAM_read(&number_of_APRS_save, NUMBER_PACKET_APRS_ADDR, sizeof(number_of_APRS_save));
-
-		if (number_of_APRS_save == 0)	//in case there's no list in the FRAM
-		{
-			FRAM_write(data, APRS_PACKETS_ADDR, APRS_SIZE_WITH_TIME);//write the list back to the FRAM
-			number_of_APRS_save++;
-			FRAM_write(&number_of_APRS_save, NUMBER_PACKET_APRS_ADDR, sizeof(number_of_APRS_save));//write the number of APRS packets in the FRAM back to the FRAM
-
-			return 1;	//returns that the packet was an APRS packet
-		}
-
-		FRAM_read(APRS_list, APRS_PACKETS_ADDR, (MAX_NAMBER_OF_APRS_PACKETS * APRS_SIZE_WITH_TIME));//read exiting list in the FRAM
-		int count = 0;
-		while (APRS_list[count] == '!')//find if empty place for the new APRS packet
-		{
-			count += APRS_SIZE_WITH_TIME;
-		}
-
-		//saves the APRS packet in the exiting list
-		for (int i = 0; i < APRS_SIZE_WITH_TIME; i++)
+		if (number_of_APRS_save >= MAX_NAMBER_OF_APRS_PACKETS)
 		{
-			APRS_list[i + count] = data[i];
+			return 1;	//the list is full, the packet is dropped
 		}
 
-		FRAM_write(APRS_list, APRS_PACKETS_ADDR, APRS_SIZE_WITH_TIME);//write the list back to the FRAM
+		//the packets before it stay in the list, only the slot of the new packet is written
+		FRAM_write(data, APRS_PACKETS_ADDR + number_of_APRS_save * APRS_SIZE_WITH_TIME, APRS_SIZE_WITH_TIME);
 		number_of_APRS_save++;
 		FRAM_write(&number_of_APRS_save, NUMBER_PACKET_APRS_ADDR, sizeof(number_of_APRS_save));//write the number of APRS packets in the FRAM back to the FRAM
 		set_numOfAPRS(number_of_APRS_save);
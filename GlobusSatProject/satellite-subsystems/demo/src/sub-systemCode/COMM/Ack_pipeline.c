@@ -0,0 +1,111 @@
+/*
+ * Ack_pipeline.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include <hal/Timing/Time.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../Main/HouseKeeping.h"
+#include "../Global/TLM_management.h"
+#include "Tx_scheduler.h"
+#include "splTypes.h"
+#include "Ack_pipeline.h"
+
+typedef struct
+{
+	byte data[ACK_DATA_LENGTH];//data field of the ACK
+	byte flags;
+	time_unix time;
+} ack_entry;
+
+static xQueueHandle xAckQueue = NULL;
+
+int init_Ack_pipeline()
+{
+	if (xAckQueue == NULL)
+		xAckQueue = xQueueCreate(ACK_QUEUE_LENGTH, sizeof(ack_entry));
+	if (xAckQueue == NULL)
+		return -1;
+	return 0;
+}
+
+int post_ACK(Ack_type type, ERR_type err, command_id ACKcommandId, byte flags)
+{
+	ack_entry entry;
+	if (xAckQueue == NULL)
+		return -1;
+	build_data_field_ACK(type, err, ACKcommandId, entry.data);
+	entry.flags = flags;
+	Time_getUnixEpoch(&entry.time);
+	if (xQueueSend(xAckQueue, &entry, 0) != pdTRUE)
+		return -2;
+	return 0;
+}
+
+int flush_ACKs()
+{
+	ack_entry entry;
+	byte saved[ACK_BATCH_SIZE * ACK_DATA_LENGTH];
+	time_unix saved_times[ACK_BATCH_SIZE];
+	byte raw_ACK[ACK_RAW_SIZE];
+	int handled = 0;
+	int in_batch;
+
+	if (xAckQueue == NULL)
+		return 0;
+	do
+	{
+		int num_saved = 0;
+		int num_sent = 0;
+		// 1. the ACKs to send go to the Tx queue with the time they were posted in
+		for (in_batch = 0; in_batch < ACK_BATCH_SIZE && xQueueReceive(xAckQueue, &entry, 0) == pdTRUE; in_batch++)
+		{
+			if (entry.flags & ACK_SAVE)
+			{
+				memcpy(saved + num_saved * ACK_DATA_LENGTH, entry.data, ACK_DATA_LENGTH);
+				saved_times[num_saved] = entry.time;
+				num_saved++;
+			}
+			if (entry.flags & ACK_SEND)
+			{
+				TM_spl_header spl = { ACK_TYPE, ACK_ST, ACK_DATA_LENGTH, entry.time };
+				write_TM_header(raw_ACK, &spl, NULL);
+				memcpy(SPL_TM_DATA(raw_ACK), entry.data, ACK_DATA_LENGTH);
+				if (Tx_schedule_frame(raw_ACK, ACK_RAW_SIZE, trxvu_bitrate_9600, tx_priority_ACK) == 0)
+					num_sent++;
+			}
+		}
+		// 2. the ACKs to save in one write
+		if (num_saved > 0)
+		{
+			FileSystemResult error = c_fileWriteElements(ACK_FILE_NAME, saved, saved_times, num_saved);
+			if (error != FS_SUCCSESS)
+				printf("could not save %d ACKs, error %d\n", num_saved, error);
+		}
+		if (num_sent > 0)
+			Tx_flush_frames();
+		handled += in_batch;
+	}
+	while (in_batch == ACK_BATCH_SIZE);
+
+	return handled;
+}
+
+void Ack_task()
+{
+	ack_entry first;
+	while (1)
+	{
+		//sleeps until an ACK is posted, the ACKs posted while the other tasks run join its batch
+		if (xQueuePeek(xAckQueue, &first, MAX_DELAY) == pdTRUE)
+			flush_ACKs();
+	}
+}
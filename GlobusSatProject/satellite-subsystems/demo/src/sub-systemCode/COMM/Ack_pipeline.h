@@ -0,0 +1,48 @@
+/*
+ * Ack_pipeline.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+
+#ifndef ACK_PIPELINE_H_
+#define ACK_PIPELINE_H_
+
+#include "../Global/Global.h"
+#include "GSC.h"
+
+#define ACK_QUEUE_LENGTH	64//ACKs waiting for the ACK task, the receive ACKs of a full Rx buffer and the ACKs of their commands
+#define ACK_BATCH_SIZE		32//ACKs saved in one write and sent in one flush of the Tx queue
+#define ACK_TASK_BUFFER		1024//stack of the ACK task
+
+#define ACK_SAVE	0x01//the ACK is saved to ACK_FILE_NAME
+#define ACK_SEND	0x02//the ACK is sent to ground
+
+/**
+ * @brief		creates the queue of the ACK task
+ * @note		call after init_Tx_scheduler
+ * @return		0 on success, -1 if the queue could not be created
+ */
+int init_Ack_pipeline();
+
+/**
+ * @brief		posts an ACK to the ACK task, without waiting
+ * @param[in]	flags ACK_SAVE, ACK_SEND or both
+ * @note		the time of the ACK is the time it is posted
+ * @return		0 the ACK is posted, -1 the queue was not created, -2 the queue is full
+ */
+int post_ACK(Ack_type type, ERR_type err, command_id ACKcommandId, byte flags);
+
+/**
+ * @brief		saves and sends every ACK posted, in batches of up to ACK_BATCH_SIZE ACKs
+ * @note		one c_fileWriteElements and one Tx_flush_frames for every batch
+ * @return		number of ACKs taken out of the queue
+ */
+int flush_ACKs();
+
+/**
+ * @brief		task function of the ACK task, flushes the ACKs after they are posted
+ */
+void Ack_task();
+
+#endif /* ACK_PIPELINE_H_ */
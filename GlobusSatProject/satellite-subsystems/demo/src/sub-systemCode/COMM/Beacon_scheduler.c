@@ -0,0 +1,115 @@
+/*
+ * Beacon_scheduler.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <hal/Storage/FRAM.h>
+
+#include "../TRXVU.h"
+#include "../Global/FRAMadress.h"
+#include "../Global/GlobalParam.h"
+#include "Beacon_scheduler.h"
+
+#define VBATT_SCALE	16//the filtered Vbatt and its trend are kept in 1/16 mV
+
+static Boolean params_changed = TRUE;
+static uint8_t beacon_delay = DEFULT_BEACON_DELAY;//seconds, BEACON_TIME_ADDR
+static voltage_t low_v_beacon = DEFULT_COMM_VOL;//BEACON_LOW_BATTERY_STATE_ADDR
+
+static int vbatt_filtered = -1;//1/16 mV, -1 before the first sample
+static int vbatt_trend = 0;//1/16 mV a minute
+static Boolean low_voltage = FALSE;
+static unsigned int last_delay = 0;//seconds between the last two samples
+
+static void load_params()
+{
+	int i_error;
+	i_error = FRAM_read(&beacon_delay, BEACON_TIME_ADDR, 1);
+	check_int("load_params, FRAM_read(BEACON_TIME_ADDR)", i_error);
+	if (i_error != 0 || beacon_delay < MIN_TIME_DELAY_BEACON || beacon_delay > MAX_TIME_DELAY_BEACON)
+	{
+		beacon_delay = DEFULT_BEACON_DELAY;
+	}
+
+	i_error = FRAM_read((byte*)&low_v_beacon, BEACON_LOW_BATTERY_STATE_ADDR, 2);
+	check_int("load_params, FRAM_read(BEACON_LOW_BATTERY_STATE_ADDR)", i_error);
+	if (i_error != 0)
+	{
+		low_v_beacon = DEFULT_COMM_VOL;
+	}
+#ifdef TESTING
+	if (7400 < low_v_beacon || low_v_beacon < 7200)
+	{
+		low_v_beacon = 7250;
+	}
+#endif
+}
+
+//filters the new Vbatt sample and the slope from the last one
+static void sample_Vbatt()
+{
+	int vbatt = (int)get_Vbatt() * VBATT_SCALE;
+	if (vbatt_filtered < 0 || last_delay == 0)
+	{
+		vbatt_filtered = vbatt;
+		vbatt_trend = 0;
+		return;
+	}
+	int previous = vbatt_filtered;
+	vbatt_filtered += (vbatt - vbatt_filtered) / BEACON_VBATT_FILTER;
+	int slope = (vbatt_filtered - previous) * 60 / (int)last_delay;
+	vbatt_trend += (slope - vbatt_trend) / BEACON_TREND_FILTER;
+}
+
+portTickType Beacon_next_delay()
+{
+	unsigned int delay;
+	int low = (int)low_v_beacon * VBATT_SCALE;
+
+	// 1. parameters from the FRAM only when a command changed them
+	if (params_changed)
+	{
+		params_changed = FALSE;
+		load_params();
+	}
+	sample_Vbatt();
+
+	// 2. low voltage when Vbatt is below it by the next beacon,
+	// left only above the hysteresis so the delay doesn't flip on every sample
+	if (vbatt_filtered + vbatt_trend * (int)beacon_delay / 60 < low)
+		low_voltage = TRUE;
+	else if (vbatt_filtered > low + BEACON_LOW_V_HYSTERESIS * VBATT_SCALE)
+		low_voltage = FALSE;
+
+	// 3. the delay
+	if (low_voltage)
+	{
+		delay = GET_BEACON_DELAY_LOW_VOLTAGE(beacon_delay);
+	}
+	else if (vbatt_filtered + vbatt_trend * BEACON_TREND_HORIZON < low)
+	{
+		delay = beacon_delay * BEACON_APPROACH_FACTOR;
+	}
+	else if (get_ground_conn())
+	{
+		delay = beacon_delay / BEACON_PASS_DIVIDER;
+		if (delay < MIN_TIME_DELAY_BEACON)
+			delay = MIN_TIME_DELAY_BEACON;
+	}
+	else
+	{
+		delay = beacon_delay;
+	}
+
+	last_delay = delay;
+	return CONVERT_SECONDS_TO_MS(delay) / portTICK_RATE_MS;
+}
+
+void Beacon_params_changed()
+{
+	params_changed = TRUE;
+}
@@ -0,0 +1,39 @@
+/*
+ * Beacon_scheduler.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+
+#ifndef BEACON_SCHEDULER_H_
+#define BEACON_SCHEDULER_H_
+
+#include <freertos/FreeRTOS.h>
+
+#include "../Global/Global.h"
+
+#define BEACON_PASS_DIVIDER			2//the beacon goes this many times faster in a pass above ground
+#define BEACON_APPROACH_FACTOR		2//the delay is multiplied by it while Vbatt goes down to the low voltage
+#define BEACON_LOW_V_HYSTERESIS		50//mV above the low voltage Vbatt has to pass to leave the low voltage delay
+#define BEACON_TREND_HORIZON		10//minutes, Vbatt approaches the low voltage if its trend reaches it by then
+#define BEACON_VBATT_FILTER			2//weight of a new Vbatt sample in the filtered Vbatt is 1 / BEACON_VBATT_FILTER
+#define BEACON_TREND_FILTER			8//weight of a new slope in the Vbatt trend is 1 / BEACON_TREND_FILTER
+
+/**
+ * @brief		the delay before the next beacon, from the delay in BEACON_TIME_ADDR:
+ * 				GET_BEACON_DELAY_LOW_VOLTAGE of it when the filtered Vbatt is below BEACON_LOW_BATTERY_STATE_ADDR,
+ * 				BEACON_APPROACH_FACTOR times it when the Vbatt trend reaches the low voltage within BEACON_TREND_HORIZON,
+ * 				1 / BEACON_PASS_DIVIDER of it in a pass above ground, the delay itself otherwise
+ * @note		samples Vbatt once a call, call once a beacon.
+ * 				the parameters are read from the FRAM on the first call and after Beacon_params_changed
+ * @return		the delay in ticks
+ */
+portTickType Beacon_next_delay();
+
+/**
+ * @brief		the next Beacon_next_delay reads the parameters of the beacon from the FRAM again
+ * @note		call after writing BEACON_TIME_ADDR or BEACON_LOW_BATTERY_STATE_ADDR
+ */
+void Beacon_params_changed();
+
+#endif /* BEACON_SCHEDULER_H_ */
@@ -14,137 +14,256 @@
 #include "DelayedCommand_list.h"
 #include "../Main/commands.h"
 
-#define DELETE_CMD_FROM_LIST(starting_point) memset((starting_point + DelayCommand_list) , 0, SIZE_OF_DELAYED_COMMAND)
-#define EXTRACT_TIME_FROM_DELAYED_COMMAND(startOfCommand) BigEnE_raw_to_uInt(DelayCommand_list + startOfCommand + SPL_TC_HEADER_SIZE - TIME_SIZE)
+//a record of the log: the length of the packet, 0 ends the log, its state and the packet
+#define RECORD_LENGTH	0
+#define RECORD_STATE	1
+#define RECORD_PENDING	0x5A//written, not added yet
+#define RECORD_LIVE		0xA5
+#define RECORD_DEAD		0x00
+#define RECORD_SIZE(length)	(DELAY_RECORD_HEADER_SIZE + (length))
+#define HALF_ADDR(half)	(DELAY_COMMAD_FRAM_ADDR + (half) * DELAY_COMMAND_STORE_SIZE)
+#define EXTRACT_TIME_FROM_RECORD(record) BigEnE_raw_to_uInt((record) + DELAY_RECORD_HEADER_SIZE + SPL_TC_HEADER_SIZE - TIME_SIZE)
 
-static byte DelayCommand_list[MAX_NUMBER_OF_DELAY_COMMAND * SIZE_OF_DELAYED_COMMAND];
+//a command of the list by its time, the heap keeps the earliest at the root
+typedef struct
+{
+	time_unix time;
+	unsigned short offset;//of the record of the command in the half in use
+	unsigned char length;//of the packet
+} delayed_entry;
 
-/*
- * @brief		Find a delayed command in the list
- * @param[in]	Starting index in the buffer
- * @return		The index were the next command in the list starts
- */
-int find_CMD_in_list(int startingPoint)
+static delayed_entry delayed_heap[MAX_NUMBER_OF_DELAY_COMMAND];
+static int heap_count = 0;//the number of commands in the list
+static byte store_half = 0;//the half of the store in use
+static unsigned int log_end = 0;//offset of the end of the log, the next record is written there
+static unsigned int live_bytes = 0;//bytes of the records of the commands in the heap
+
+static void heap_swap(int a, int b)
+{
+	delayed_entry temp = delayed_heap[a];
+	delayed_heap[a] = delayed_heap[b];
+	delayed_heap[b] = temp;
+}
+
+static void sift_up(int i)
 {
-	int count = startingPoint + CMD_ID_SIZE;
-	while (count < SIZE_OF_DELAYED_COMMAND * MAX_NUMBER_OF_DELAY_COMMAND)
+	while (i > 0 && delayed_heap[(i - 1) / 2].time > delayed_heap[i].time)
 	{
-		if ((byte)NOT_DELAYED_COMMAND != DelayCommand_list[count])
-		{
-			return count - CMD_ID_SIZE;
-		}
-		else
-		{
-			count += SIZE_OF_DELAYED_COMMAND;
-		}
+		heap_swap(i, (i - 1) / 2);
+		i = (i - 1) / 2;
 	}
-	return -1;
 }
 
-/*
- * @brief	Find the next empty space in the list from the start
- * @return	The startimg index of the empty space
- */
-int find_empty_in_list()
+static void sift_down(int i)
 {
-	int count = CMD_ID_SIZE;
-	while (count < SIZE_OF_DELAYED_COMMAND * MAX_NUMBER_OF_DELAY_COMMAND)
+	while (1)
 	{
-		if ((byte)NOT_DELAYED_COMMAND == DelayCommand_list[count])
-		{
-			return count - CMD_ID_SIZE;
-		}
-		else
-		{
-			count += SIZE_OF_DELAYED_COMMAND;
-		}
+		int smallest = i;
+		int left = 2 * i + 1;
+		if (left < heap_count && delayed_heap[left].time < delayed_heap[smallest].time)
+			smallest = left;
+		if (left + 1 < heap_count && delayed_heap[left + 1].time < delayed_heap[smallest].time)
+			smallest = left + 1;
+		if (smallest == i)
+			return;
+		heap_swap(i, smallest);
+		i = smallest;
+	}
+}
+
+static void heap_push(time_unix time, unsigned int offset, unsigned char length)
+{
+	delayed_heap[heap_count].time = time;
+	delayed_heap[heap_count].offset = (unsigned short)offset;
+	delayed_heap[heap_count].length = length;
+	heap_count++;
+	live_bytes += RECORD_SIZE(length);
+	sift_up(heap_count - 1);
+}
+
+//takes entry i out of the heap, its record stays in the FRAM
+static delayed_entry heap_remove(int i)
+{
+	delayed_entry entry = delayed_heap[i];
+	live_bytes -= RECORD_SIZE(entry.length);
+	heap_count--;
+	if (i != heap_count)
+	{
+		delayed_heap[i] = delayed_heap[heap_count];
+		sift_up(i);
+		sift_down(i);
+	}
+	return entry;
+}
+
+//the index in the heap of the command with the latest time, a leaf of the heap
+static int latest_command()
+{
+	int latest = 0;
+	for (int i = heap_count / 2; i < heap_count; i++)
+	{
+		if (delayed_heap[i].time > delayed_heap[latest].time)
+			latest = i;
 	}
-	return -1;
+	return latest;
+}
+
+static void write_count()
+{
+	byte numberOfCommands = (byte)heap_count;
+	int err = FRAM_write(&numberOfCommands, NUMBER_COMMAND_FRAM_ADDR, sizeof(numberOfCommands));	//write back the nuber of commands that stored in the FRAM
+	check_int("write_count, FRAM_write(NUMBER_COMMAND_FRAM_ADDR)", err);
+	set_numOfDelayedCommand(numberOfCommands);
+}
+
+//takes entry i out of the heap and marks its record deleted, one byte a reset can't split
+static void delete_command(int i)
+{
+	byte state = RECORD_DEAD;
+	delayed_entry entry = heap_remove(i);
+	int err = FRAM_write(&state, HALF_ADDR(store_half) + entry.offset + RECORD_STATE, 1);
+	check_int("delete_command, FRAM_write(DELAY_COMMAD_FRAM_ADDR)", err);
+}
+
+//the room at the end of the log for a record of 'length', and for the 0 that ends the log after it
+static Boolean room_at_end(unsigned int end, int length)
+{
+	return end + RECORD_SIZE(length) + 1 <= DELAY_COMMAND_STORE_SIZE;
 }
 
 /*
- * @brief		Check if the time indecent a command ready to execute,
- * 				delete if the command expired or if the command is not ready yet
- * @return		-1 expired command, 1 command ready to execute 0 not ready
+ * @brief		writes a record at the end of the log. a reset before its state is written leaves the
+ * 				log without the command, a pending record is skipped on a load
+ * @return		the offset of the record
  */
-int check_delayCommandTime(time_unix cmd_time)
+static unsigned int append_record(byte *packet, int length)
 {
-	time_unix time_now;
-	int error = Time_getUnixEpoch(&time_now);
-	check_int("check_delayCommandTime, Time_getUnixEpoch", error);
-
-	int ret = 0;
-	if (cmd_time + EXPIRED_TIME_DC <= time_now)
-		ret = -1;//expired command
-	else if (cmd_time <= time_now)
-		ret = 1;//command to execute
-	else
-		ret = 0;//not the time
+	byte record[RECORD_SIZE(SIZE_OF_DELAYED_COMMAND) + 1];
+	unsigned int offset = log_end;
+	unsigned int address = HALF_ADDR(store_half) + offset;
+
+	record[RECORD_LENGTH] = (byte)length;
+	record[RECORD_STATE] = RECORD_PENDING;
+	memcpy(record + DELAY_RECORD_HEADER_SIZE, packet, length);
+	record[RECORD_SIZE(length)] = 0;
+
+	// 1. the record after its length, and the end of the log after it. the log still ends before it
+	int err = FRAM_write(record + RECORD_STATE, address + RECORD_STATE, RECORD_SIZE(length));
+	check_int("append_record, FRAM_write(DELAY_COMMAD_FRAM_ADDR)", err);
+	// 2. the length links the pending record to the log
+	err = FRAM_write(record + RECORD_LENGTH, address + RECORD_LENGTH, 1);
+	check_int("append_record, FRAM_write(DELAY_COMMAD_FRAM_ADDR)", err);
+	// 3. the state adds the command
+	record[RECORD_STATE] = RECORD_LIVE;
+	err = FRAM_write(record + RECORD_STATE, address + RECORD_STATE, 1);
+	check_int("append_record, FRAM_write(DELAY_COMMAD_FRAM_ADDR)", err);
 
-	//printf("time now: %u \ncmd time: %u \nret value: %d\n\n", time_now, cmd_time, ret);
-	return ret;
+	log_end += RECORD_SIZE(length);
+	return offset;
 }
 
-void execute_delayedCommand(int startingPoint)
+/*
+ * @brief		copies the commands of the heap to the other half of the store and the new record after
+ * 				them, the deleted records are left behind. the half in use changes with one byte, a reset
+ * 				before it leaves the list as it was
+ * @return		the offset of the new record
+ */
+static unsigned int compact_records(byte *packet, int length)
 {
-	TC_spl decode;	//decode command
-	decode_TCpacket(DelayCommand_list + startingPoint, -1, &decode);	//docoded packet to execute
-	add_command(decode);	//executing command
+	byte record[RECORD_SIZE(SIZE_OF_DELAYED_COMMAND) + 1];
+	byte other = (byte)(1 - store_half);
+	unsigned int end = 0;
+	int err;
+
+	// 1. the commands of the heap, to the start of the other half
+	for (int i = 0; i < heap_count; i++)
+	{
+		int size = RECORD_SIZE(delayed_heap[i].length);
+		err = FRAM_read(record, HALF_ADDR(store_half) + delayed_heap[i].offset, size);
+		check_int("compact_records, FRAM_read(DELAY_COMMAD_FRAM_ADDR)", err);
+		err = FRAM_write(record, HALF_ADDR(other) + end, size);
+		check_int("compact_records, FRAM_write(DELAY_COMMAD_FRAM_ADDR)", err);
+		delayed_heap[i].offset = (unsigned short)end;
+		end += size;
+	}
+
+	// 2. the new record, and the end of the log
+	unsigned int offset = end;
+	record[RECORD_LENGTH] = (byte)length;
+	record[RECORD_STATE] = RECORD_LIVE;
+	memcpy(record + DELAY_RECORD_HEADER_SIZE, packet, length);
+	record[RECORD_SIZE(length)] = 0;
+	err = FRAM_write(record, HALF_ADDR(other) + end, RECORD_SIZE(length) + 1);
+	check_int("compact_records, FRAM_write(DELAY_COMMAD_FRAM_ADDR)", err);
+	end += RECORD_SIZE(length);
+
+	// 3. the other half is in use
+	err = FRAM_write(&other, DELAY_COMMAND_HALF_ADDR, 1);
+	check_int("compact_records, FRAM_write(DELAY_COMMAND_HALF_ADDR)", err);
+	store_half = other;
+	log_end = end;
+	return offset;
+}
+
+/*
+ * @brief		reads a delayed command from the FRAM to the command queue
+ * @return		0 on success, 1 the command queue is full
+ */
+static int execute_delayedCommand(delayed_entry *entry)
+{
+	byte packet[SIZE_OF_DELAYED_COMMAND];
+	TC_spl *decode = reserve_command();	//the slot of the command in the command queue
+	if (decode == NULL)
+		return 1;
+	int err = FRAM_read(packet, HALF_ADDR(store_half) + entry->offset + DELAY_RECORD_HEADER_SIZE, entry->length);
+	check_int("execute_delayedCommand, FRAM_read(DELAY_COMMAD_FRAM_ADDR)", err);
+	if (err == 0 && decode_TCpacket(packet, entry->length, decode) == 0)	//docoded packet to execute
+		commit_command();	//executing command
+	return 0;
 }
 
 void check_delaycommand()
 {
 	Boolean list_changed = FALSE;
-	int err;
-	unsigned char numberOfCommands = 0;	//stored the number of commands from the FRAM
-	err = FRAM_read(&numberOfCommands, NUMBER_COMMAND_FRAM_ADDR, 1);
-	check_int("check_delaycommand, FRAM_read(NUMBER_COMMAND_FRAM_ADDR)", err);
-	set_numOfDelayedCommand(numberOfCommands);
-	//printf("number of commands in FRAM %d\n", numberOfCommands);
-	//2. Loading delayed command list from FRAM
-
-	time_unix time_;
-	int count = find_CMD_in_list(0);	//count the number of byte of the list, starts from 4 (the first command type)
-	while (count != -1)
-	{
-		time_ = EXTRACT_TIME_FROM_DELAYED_COMMAND(count);
-		int ret = check_delayCommandTime(time_);
-		if (ret == -1)
-		{
-			DELETE_CMD_FROM_LIST(count);
-			list_changed = TRUE;
-			numberOfCommands--;
-		}
-		else if (ret == 1)
-		{
-			execute_delayedCommand(count);
-			DELETE_CMD_FROM_LIST(count);
-			list_changed = TRUE;
-			numberOfCommands--;
-		}
+	time_unix time_now;
 
-		count = find_CMD_in_list(count + SIZE_OF_DELAYED_COMMAND);
-	}
+	// 1. one compare with the earliest command while it isn't the time
+	if (heap_count == 0)
+		return;
+	int err = Time_getUnixEpoch(&time_now);
+	check_int("check_delaycommand, Time_getUnixEpoch", err);
+	if (delayed_heap[0].time > time_now)
+		return;
 
-	// 11. check if there's the need to return list to FRAM
-	if (list_changed == TRUE)
+	// 2. the commands that are due, earliest first. expired commands are deleted
+	while (heap_count > 0 && delayed_heap[0].time <= time_now)
 	{
-		// 12. return the list to the FRAM
-		FRAM_write(DelayCommand_list, DELAY_COMMAD_FRAM_ADDR, (MAX_NUMBER_OF_DELAY_COMMAND * SIZE_OF_DELAYED_COMMAND));	//write back the new list
-		FRAM_write(&numberOfCommands, NUMBER_COMMAND_FRAM_ADDR, sizeof(numberOfCommands));	//write back the nuber of commands that stored in the FRAM
+		if (delayed_heap[0].time + EXPIRED_TIME_DC > time_now &&
+				execute_delayedCommand(&delayed_heap[0]) != 0)
+			break;//the command queue is full, the command waits for the next check
+		delete_command(0);
+		list_changed = TRUE;
 	}
 
-	//set_numOfDelayedCommand(numberOfCommands);
+	if (list_changed == TRUE)
+		write_count();
 }
 
 void reset_delayCommand(Boolean firstActivation)
 {
 	byte numberOfCommands = 0;				//get number of command in the FRAM
+	byte end_of_log = 0;
 
-	memset(DelayCommand_list, 0, MAX_NUMBER_OF_DELAY_COMMAND * SIZE_OF_DELAYED_COMMAND);
+	heap_count = 0;
+	live_bytes = 0;
+	log_end = 0;
 
-	int err = FRAM_write(DelayCommand_list, DELAY_COMMAD_FRAM_ADDR, (MAX_NUMBER_OF_DELAY_COMMAND * SIZE_OF_DELAYED_COMMAND));	//reset the memory of the delay command list in the FRAM
+	//the log of the first half ends at its start, then the first half is in use
+	int err = FRAM_write(&end_of_log, HALF_ADDR(0), 1);
 	check_int("reset_delayCommand, FRAM_write(DELAY_COMMAD_FRAM_ADDR)", err);
+	store_half = 0;
+	err = FRAM_write(&store_half, DELAY_COMMAND_HALF_ADDR, 1);
+	check_int("reset_delayCommand, FRAM_write(DELAY_COMMAND_HALF_ADDR)", err);
 
 	err = FRAM_write(&numberOfCommands, NUMBER_COMMAND_FRAM_ADDR, sizeof(numberOfCommands));	//reset the number of commands in the FRAM to 0
 	check_int("reset_delayCommand, FRAM_write(NUMBER_COMMAND_FRAM_ADDR)", err);
@@ -152,19 +271,19 @@ void reset_delayCommand(Boolean firstActivation)
 	//  if its not init, update the number of APRS commands
 	if (!firstActivation)
 	{
-		//set_numOfDelayedCommand(numberOfCommands);
+		set_numOfDelayedCommand(numberOfCommands);
 	}
 }
 
 int add_delayCommand(TC_spl decode)
 {
-	int i_error = 0;
+	unsigned int offset;
+
 	// 1. check if the length of the command in range of delay command
 	if (decode.length + SPL_TC_HEADER_SIZE > SIZE_OF_DELAYED_COMMAND)
 	{
 		return -1;
 	}
-	unsigned char numberOfCommands = 0;				//get number of command in the FRAM
 
 	int size = SIZE_OF_DELAYED_COMMAND;				//size of array data
 	byte command[SIZE_OF_DELAYED_COMMAND];				//encoded packet
@@ -172,31 +291,27 @@ int add_delayCommand(TC_spl decode)
 
 	// 2. encode TC command
 	encode_TCpacket(command, &size, decode);
+	int length = decode.length + SPL_TC_HEADER_SIZE;
 
-	// 3. read number of delay commands in delay command list
-	i_error = FRAM_read(&numberOfCommands, NUMBER_COMMAND_FRAM_ADDR, 1);
-	check_int("add_delayCommand, FRAM_read", i_error);
-
-	// 4. check if the list is full
-	if (numberOfCommands >= MAX_NUMBER_OF_DELAY_COMMAND)
+	// 3. the command goes to the end of the log
+	if (heap_count < MAX_NUMBER_OF_DELAY_COMMAND && room_at_end(log_end, length))
 	{
-		EmptyOldestCommand();
-		numberOfCommands--;
-		printf("list full delete one element\n");
+		offset = append_record(command, length);
 	}
-
-	int count = find_empty_in_list();
-	if (count != -1)//if there's an empty space in the list
+	else
 	{
-		memcpy(DelayCommand_list + count, command, decode.length + SPL_TC_HEADER_SIZE);
+		// 4. no room at the end, the latest commands of a full list are left out of the compaction
+		while (heap_count >= MAX_NUMBER_OF_DELAY_COMMAND || !room_at_end(live_bytes, length))
+		{
+			heap_remove(latest_command());
+			printf("list full delete one element\n");
+		}
+		offset = compact_records(command, length);
 	}
 
-	// 7.1. returns the list to the FRAM
-	i_error = FRAM_write(DelayCommand_list, DELAY_COMMAD_FRAM_ADDR, (SIZE_OF_DELAYED_COMMAND * MAX_NUMBER_OF_DELAY_COMMAND));
-	check_int("add_delayCommand, FRAM_write", i_error);
-	numberOfCommands++;
-	i_error = FRAM_write(&numberOfCommands, NUMBER_COMMAND_FRAM_ADDR, 1);
-	check_int("add_delayCommand, FRAM_write", i_error);
+	// 5. the command goes to the heap by its time
+	heap_push(decode.time, offset, (unsigned char)length);
+	write_count();
 
 	return 0;
 }
@@ -204,33 +319,37 @@ int add_delayCommand(TC_spl decode)
 void get_delayCommand_list()
 {
 	int error;
-	memset(DelayCommand_list, 0, MAX_NUMBER_OF_DELAY_COMMAND * SIZE_OF_DELAYED_COMMAND);	//sets all slots in the array to zero for later write to the FRAM
-	error = FRAM_read(DelayCommand_list, DELAY_COMMAD_FRAM_ADDR, MAX_NUMBER_OF_DELAY_COMMAND * SIZE_OF_DELAYED_COMMAND);
-	check_int("get_delayCommand_list, FRAM_read(DELAY_COMMAD_FRAM_ADDR)", error);
-	unsigned char num;
-	error = FRAM_read(&num, NUMBER_COMMAND_FRAM_ADDR, 1);
-	check_int("get_delayCommand_list, FRAM_read(NUMBER_COMMAND_FRAM_ADDR)", error);
-	//set_numOfDelayedCommand(num);
-}
+	byte record[DELAY_RECORD_HEADER_SIZE + SPL_TC_HEADER_SIZE];
+	unsigned int offset = 0;
 
-void EmptyOldestCommand()
-{
-	time_unix OldTime = 0, cmdTime = 0;
-	for (int i = 0; i < MAX_NUMBER_OF_DELAY_COMMAND * SIZE_OF_DELAYED_COMMAND; i+= SIZE_OF_COMMAND)
-	{
-		cmdTime = EXTRACT_TIME_FROM_DELAYED_COMMAND(i);
-		if (OldTime < cmdTime)
-		{
-			OldTime = cmdTime;
-		}
-	}
-	for (int i = 0; i < MAX_NUMBER_OF_DELAY_COMMAND * SIZE_OF_DELAYED_COMMAND; i += SIZE_OF_COMMAND)
+	heap_count = 0;
+	live_bytes = 0;
+	error = FRAM_read(&store_half, DELAY_COMMAND_HALF_ADDR, 1);
+	check_int("get_delayCommand_list, FRAM_read(DELAY_COMMAND_HALF_ADDR)", error);
+	if (store_half > 1)
+		store_half = 0;
+
+	// 1. the headers of the records until the end of the log, the live commands go to the heap
+	while (offset + sizeof(record) <= DELAY_COMMAND_STORE_SIZE)
 	{
-		cmdTime = EXTRACT_TIME_FROM_DELAYED_COMMAND(i);
-		if (OldTime == cmdTime)
-		{
-			DELETE_CMD_FROM_LIST(i);
+		error = FRAM_read(record, HALF_ADDR(store_half) + offset, sizeof(record));
+		check_int("get_delayCommand_list, FRAM_read(DELAY_COMMAD_FRAM_ADDR)", error);
+		int length = record[RECORD_LENGTH];
+		if (error != 0 || length < SPL_TC_HEADER_SIZE || length > SIZE_OF_DELAYED_COMMAND || !room_at_end(offset, length))
 			break;
-		}
+		if (record[RECORD_STATE] == RECORD_LIVE && heap_count < MAX_NUMBER_OF_DELAY_COMMAND)
+			heap_push(EXTRACT_TIME_FROM_RECORD(record), offset, (unsigned char)length);
+		offset += RECORD_SIZE(length);
 	}
+	log_end = offset;
+
+	set_numOfDelayedCommand((uint8_t)heap_count);
+}
+
+void EmptyOldestCommand()
+{
+	if (heap_count == 0)
+		return;
+	delete_command(latest_command());
+	write_count();
 }
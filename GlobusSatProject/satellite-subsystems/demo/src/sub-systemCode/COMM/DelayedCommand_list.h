@@ -14,13 +14,17 @@
 
 #define NOT_DELAYED_COMMAND 0
 #define EXPIRED_TIME_DC (15 * 60)
-#define MAX_NUMBER_OF_DELAY_COMMAND			100 //the max number of delayed commands in the FRAM
+#define MAX_NUMBER_OF_DELAY_COMMAND			255 //the max number of delayed commands in the FRAM, their number is a byte of the beacon
+#define DELAY_COMMAND_STORE_SIZE			10100//bytes of a half of the store, a compaction copies the commands to the other half
+#define DELAY_RECORD_HEADER_SIZE			2//the length of the packet and the state of the record before every command
 
 
 /**
- * 	@brief		goes over the delayed command list in the RAM and checks if time to execute one of the commands.
- * 				If the list changed the new list is place in the FRAM
- * 				deleting expired commands
+ * 	@brief		checks if time to execute the earliest command of the delayed command list, a heap in the RAM
+ * 				keeps the commands by their time and place in the FRAM. the due commands are read from the FRAM
+ * 				to the command queue, earliest first, the commands executed and expired are marked deleted
+ * 	@note		while the earliest command isn't due it is one compare. a command is deleted after it went to
+ * 				the command queue, a reset in between executes it again after the reset
  */
 void check_delaycommand();
 
@@ -30,15 +34,17 @@ void check_delaycommand();
 void reset_delayCommand(Boolean firstActivation);
 
 /**
- *  @brief       add new command to the delayed command list in an empty space
- *  			 If there's no free place on the list the function delete one command with EmptyOldestCommand()
+ *  @brief       add new command to the end of the log of the delayed command list in the FRAM
+ *  			 If there's no free place at the end the commands are compacted to the other half of the store,
+ *  			 if the list is full the commands with the latest times are left out of it
  *  @param[in]   the command to add to the delayed command list
  *  @return      0 if everything work, 1 if the list is full, -1 if the command is corrupted
  */
 int add_delayCommand(TC_spl decode);
 
 /*
- * @brief	Read from the FRAM the current list to a ram buffer
+ * @brief	Read the headers of the commands in the FRAM to the heap in the ram
+ * @note	a command a reset stopped before it was added is skipped
  */
 void get_delayCommand_list();
 
@@ -0,0 +1,168 @@
+/*
+ * Dump_fec.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+#include <hal/checksum.h>
+
+#include <string.h>
+
+#include "GSC.h"
+#include "splTypes.h"
+#include "Dump_fec.h"
+
+#define GF_POLYNOMIAL	0x11d
+
+static Boolean tables_ready = FALSE;
+static byte gf_exp[512];//twice, so the sum of two logs needs no modulo
+static unsigned short gf_log[256];
+static unsigned short coefficient_log[FEC_MAX_REPAIR][FEC_WINDOW_SIZE];
+static unsigned short crc_LUT[256];
+
+static void init_tables()
+{
+	unsigned short x = 1;
+	for (int i = 0; i < 255; i++)
+	{
+		gf_exp[i] = (byte)x;
+		gf_exp[i + 255] = (byte)x;
+		gf_log[x] = (unsigned short)i;
+		x <<= 1;
+		if (x & 0x100)
+			x ^= GF_POLYNOMIAL;
+	}
+	gf_exp[510] = gf_exp[0];
+	gf_exp[511] = gf_exp[1];
+	gf_log[0] = 0;
+	//Cauchy matrix 1 / (x_j + y_i), x_j = j and y_i = FEC_MAX_REPAIR + i are all different,
+	//so every square part of it can be inverted
+	for (int j = 0; j < FEC_MAX_REPAIR; j++)
+		for (int i = 0; i < FEC_WINDOW_SIZE; i++)
+			coefficient_log[j][i] = (unsigned short)(255 - gf_log[j ^ (FEC_MAX_REPAIR + i)]);
+	checksum_prepareLUTCRC16(CRC16_POLYNOMIAL, crc_LUT);
+	tables_ready = TRUE;
+}
+
+byte dump_fec_gf_mul(byte a, byte b)
+{
+	if (!tables_ready)
+		init_tables();
+	if (a == 0 || b == 0)
+		return 0;
+	return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+byte dump_fec_gf_inv(byte a)
+{
+	if (a == 0)
+		return 0;
+	if (!tables_ready)
+		init_tables();
+	return gf_exp[255 - gf_log[a]];
+}
+
+byte dump_fec_coefficient(int repair, int frame)
+{
+	if (!tables_ready)
+		init_tables();
+	return gf_exp[coefficient_log[repair][frame]];
+}
+
+unsigned short dump_fec_crc(byte *frame, uint8_t length)
+{
+	if (!tables_ready)
+		init_tables();
+	return checksum_calculateCRC16LUT(frame, length, crc_LUT, CRC16_DEFAULT_STARTREMAINDER, TRUE);
+}
+
+static void open_window(dump_fec *fec)
+{
+	memset(fec->repair, 0, sizeof(fec->repair));
+	fec->count = 0;
+	fec->max_length = 0;
+	fec->next_repair = fec->num_of_repair;
+}
+
+int init_dump_fec(dump_fec *fec, int num_of_repair)
+{
+	if (num_of_repair < 1 || num_of_repair > FEC_MAX_REPAIR)
+		return -1;
+	if (!tables_ready)
+		init_tables();
+	fec->num_of_repair = num_of_repair;
+	fec->window = 0;
+	open_window(fec);
+	return 0;
+}
+
+int dump_fec_add(dump_fec *fec, byte *frame, uint8_t length)
+{
+	if (length > FEC_MAX_DATA_FRAME)
+		return -1;
+	int i = fec->count;
+	if (i == 0)
+	{
+		TM_spl_header header;
+		fec->time = read_TM_header(frame, &header) == 0 ? header.time : 0;
+	}
+	fec->lengths[i] = length;
+	fec->crcs[i] = dump_fec_crc(frame, length);
+	if (length > fec->max_length)
+		fec->max_length = length;
+	//the log of a byte is looked up once for all the repair frames
+	for (int b = 0; b < length; b++)
+	{
+		if (frame[b] == 0)
+			continue;
+		unsigned short log = gf_log[frame[b]];
+		for (int j = 0; j < fec->num_of_repair; j++)
+			fec->repair[j][b] ^= gf_exp[log + coefficient_log[j][i]];
+	}
+	fec->count++;
+	if (fec->count == FEC_WINDOW_SIZE)
+		fec->next_repair = 0;
+	return 0;
+}
+
+void dump_fec_end(dump_fec *fec)
+{
+	if (fec->count > 0 && fec->next_repair == fec->num_of_repair)
+		fec->next_repair = 0;
+}
+
+int dump_fec_next_repair(dump_fec *fec, byte *frame, uint8_t *length)
+{
+	if (fec->next_repair >= fec->num_of_repair)
+		return 0;
+	int j = fec->next_repair;
+	int size = 0;
+	TM_spl_header header = { DUMP_T, FEC_DUMP_ST, 0, fec->time };
+	header.length = (unsigned short)(FEC_HEADER_SIZE + fec->count * FEC_FRAME_INFO_SIZE + fec->max_length);
+	write_TM_header(frame, &header, &size);
+
+	byte *data = SPL_TM_DATA(frame);
+	data[0] = (byte)(fec->window >> 8);
+	data[1] = (byte)fec->window;
+	data[2] = (byte)fec->count;
+	data[3] = (byte)fec->num_of_repair;
+	data[4] = (byte)j;
+	data += FEC_HEADER_SIZE;
+	for (int i = 0; i < fec->count; i++)
+	{
+		data[0] = fec->lengths[i];
+		data[1] = (byte)(fec->crcs[i] >> 8);
+		data[2] = (byte)fec->crcs[i];
+		data += FEC_FRAME_INFO_SIZE;
+	}
+	memcpy(data, fec->repair[j], fec->max_length);
+	*length = (uint8_t)size;
+
+	fec->next_repair++;
+	if (fec->next_repair == fec->num_of_repair)
+	{
+		fec->window++;
+		open_window(fec);
+	}
+	return 1;
+}
@@ -0,0 +1,87 @@
+/*
+ * Dump_fec.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+
+#ifndef DUMP_FEC_H_
+#define DUMP_FEC_H_
+
+#include "../Global/Global.h"
+#include "../Global/sizes.h"
+
+#define FEC_WINDOW_SIZE		8//data frames in a window of repair frames
+#define FEC_MAX_REPAIR		4//repair frames of a window, the most frames of a window that can be lost
+#define FEC_HEADER_SIZE		5//window number (2), frames in the window, repair frames of the window, index of the repair frame
+#define FEC_FRAME_INFO_SIZE	3//length and CRC16 of every data frame of the window, in a repair frame
+//the longest data frame a repair frame can cover
+#define FEC_MAX_DATA_FRAME	(SIZE_TXFRAME - SPL_TM_HEADER_SIZE - FEC_HEADER_SIZE - FEC_WINDOW_SIZE * FEC_FRAME_INFO_SIZE)
+
+//erasure code of the frames of a dump, the repair frames of a window are built while its data frames go out
+typedef struct
+{
+	byte repair[FEC_MAX_REPAIR][FEC_MAX_DATA_FRAME];//the repair symbols of the window so far
+	uint8_t lengths[FEC_WINDOW_SIZE];
+	unsigned short crcs[FEC_WINDOW_SIZE];
+	time_unix time;//of the first data frame of the window
+	uint8_t max_length;//of the data frames of the window
+	int num_of_repair;
+	int count;//data frames in the window
+	int next_repair;//index of the next repair frame to build, num_of_repair while the window is open
+	unsigned short window;
+} dump_fec;
+
+/**
+ * @brief		prepare the erasure code of a dump
+ * @param[out]	fec the code
+ * @param[in]	num_of_repair repair frames after every FEC_WINDOW_SIZE data frames, 1 to FEC_MAX_REPAIR
+ * @return		0 on success, -1 wrong num_of_repair
+ */
+int init_dump_fec(dump_fec *fec, int num_of_repair);
+
+/**
+ * @brief		adds a data frame to the window
+ * @note		the frame goes out as it is, the ground matches it to its place in the window by its CRC16.
+ * 				call only while dump_fec_next_repair has no repair frame to build
+ * @return		0 on success, -1 the frame is longer than FEC_MAX_DATA_FRAME
+ */
+int dump_fec_add(dump_fec *fec, byte *frame, uint8_t length);
+
+/**
+ * @brief		closes the window before it has FEC_WINDOW_SIZE data frames, at the end of the dump
+ */
+void dump_fec_end(dump_fec *fec);
+
+/**
+ * @brief		builds the next repair frame of a full or closed window
+ * @note		a repair frame is a DUMP_T, FEC_DUMP_ST packet: the FEC header, the length and
+ * 				CRC16 of every data frame of the window, and the repair symbols of the data frames
+ * 				padded with zeros to the longest. repair symbol j of byte b is the sum over the data
+ * 				frames i of dump_fec_coefficient(j, i) * byte b of frame i, in GF(256).
+ * 				the ground rebuilds the window from any count of its data and repair frames
+ * @return		1 a repair frame was built, 0 the window is still open
+ */
+int dump_fec_next_repair(dump_fec *fec, byte *frame, uint8_t *length);
+
+/**
+ * @return		the coefficient of data frame 'frame' in repair frame 'repair', a Cauchy matrix in GF(256)
+ */
+byte dump_fec_coefficient(int repair, int frame);
+
+/**
+ * @return		a * b in GF(256), polynomial 0x11d
+ */
+byte dump_fec_gf_mul(byte a, byte b);
+
+/**
+ * @return		1 / a in GF(256), 0 for 0
+ */
+byte dump_fec_gf_inv(byte a);
+
+/**
+ * @return		the CRC16 of a data frame, as the repair frames carry it
+ */
+unsigned short dump_fec_crc(byte *frame, uint8_t length);
+
+#endif /* DUMP_FEC_H_ */
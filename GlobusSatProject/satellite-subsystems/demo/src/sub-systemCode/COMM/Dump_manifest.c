@@ -0,0 +1,290 @@
+/*
+ * Dump_manifest.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+#include <hal/Timing/Time.h>
+#include <hal/Storage/FRAM.h>
+#include <hal/checksum.h>
+
+#include <string.h>
+
+#include "../Global/FRAMadress.h"
+#include "GSC.h"
+#include "splTypes.h"
+#include "Dump_manifest.h"
+
+#define RANGES_ADDR			(DUMP_MANIFEST_ADDR + DUMP_MANIFEST_HEADER_SIZE)
+#define NUM_OF_RANGES_ADDR	(DUMP_MANIFEST_ADDR + DUMP_MANIFEST_HEADER_SIZE - 2)
+
+static Boolean crc_ready = FALSE;
+static unsigned int crc_LUT[256];
+
+static void uShort_to_raw(unsigned short value, byte raw[2])
+{
+	raw[0] = (byte)(value >> 8);
+	raw[1] = (byte)value;
+}
+
+unsigned int dump_index_crc(byte *frame, uint8_t length)
+{
+	if (!crc_ready)
+	{
+		checksum_prepareLUTCRC32(CRC32_POLYNOMIAL, crc_LUT);
+		crc_ready = TRUE;
+	}
+	return checksum_calculateCRC32LUT(frame, length, crc_LUT, CRC32_DEFAULT_STARTREMAINDER);
+}
+
+static void encode_header(const dump_manifest *manifest, byte raw[DUMP_MANIFEST_HEADER_SIZE])
+{
+	uShort_to_raw(manifest->dump_id, &raw[0]);
+	memcpy(&raw[2], manifest->HK, DUMP_MANIFEST_FILES);
+	raw[7] = manifest->resulotion;
+	BigEnE_uInt_to_raw(manifest->start_time, &raw[8]);
+	BigEnE_uInt_to_raw(manifest->end_time, &raw[12]);
+	raw[16] = manifest->packed ? 1 : 0;
+	raw[17] = manifest->frame_limit;
+	uShort_to_raw(manifest->num_of_ranges, &raw[18]);
+}
+
+int load_dump_manifest(dump_manifest *manifest)
+{
+	byte raw[DUMP_MANIFEST_HEADER_SIZE];
+	int i_error = FRAM_read(raw, DUMP_MANIFEST_ADDR, DUMP_MANIFEST_HEADER_SIZE);
+	check_int("load_dump_manifest, FRAM_read(DUMP_MANIFEST_ADDR)", i_error);
+	if (i_error != 0)
+		return -1;
+	manifest->dump_id = BigEnE_raw_to_uShort(&raw[0]);
+	memcpy(manifest->HK, &raw[2], DUMP_MANIFEST_FILES);
+	manifest->resulotion = raw[7];
+	manifest->start_time = BigEnE_raw_to_uInt(&raw[8]);
+	manifest->end_time = BigEnE_raw_to_uInt(&raw[12]);
+	manifest->packed = raw[16] ? TRUE : FALSE;
+	manifest->frame_limit = raw[17];
+	manifest->num_of_ranges = BigEnE_raw_to_uShort(&raw[18]);
+	//a FRAM that never had a manifest
+	if (manifest->num_of_ranges > DUMP_MANIFEST_MAX_RANGES)
+		manifest->num_of_ranges = 0;
+	return 0;
+}
+
+int reset_dump_manifest()
+{
+	byte raw[2] = { 0, 0 };
+	int i_error = FRAM_write(raw, NUM_OF_RANGES_ADDR, 2);
+	check_int("reset_dump_manifest, FRAM_write(DUMP_MANIFEST_ADDR)", i_error);
+	return i_error == 0 ? 0 : -1;
+}
+
+//saves where the source reads the first data frame of the range that starts now
+static void save_range(dump_sequencer *seq)
+{
+	dump_position position;
+	byte raw[DUMP_RANGE_RAW_SIZE];
+	byte count[2];
+	unsigned int range = seq->sequence / DUMP_RANGE_SIZE;
+	if (range >= DUMP_MANIFEST_MAX_RANGES)
+		return;
+
+	seq->get_position(seq->context, &position);
+	raw[0] = (byte)position.file;
+	uShort_to_raw(position.parameter, &raw[1]);
+	BigEnE_uInt_to_raw(position.chunk_time, &raw[3]);
+	BigEnE_uInt_to_raw(position.last_send, &raw[7]);
+	int i_error = FRAM_write(raw, RANGES_ADDR + range * DUMP_RANGE_RAW_SIZE, DUMP_RANGE_RAW_SIZE);
+	check_int("save_range, FRAM_write(DUMP_MANIFEST_ADDR)", i_error);
+	if (i_error != 0)
+		return;
+	//the range counts only after its position is in the FRAM
+	seq->manifest.num_of_ranges = (unsigned short)(range + 1);
+	uShort_to_raw(seq->manifest.num_of_ranges, count);
+	i_error = FRAM_write(count, NUM_OF_RANGES_ADDR, 2);
+	check_int("save_range, FRAM_write(DUMP_MANIFEST_ADDR)", i_error);
+}
+
+static int load_range(unsigned int range, dump_position *position)
+{
+	byte raw[DUMP_RANGE_RAW_SIZE];
+	int i_error = FRAM_read(raw, RANGES_ADDR + range * DUMP_RANGE_RAW_SIZE, DUMP_RANGE_RAW_SIZE);
+	check_int("load_range, FRAM_read(DUMP_MANIFEST_ADDR)", i_error);
+	if (i_error != 0)
+		return -1;
+	position->file = (signed char)raw[0];
+	position->parameter = BigEnE_raw_to_uShort(&raw[1]);
+	position->chunk_time = BigEnE_raw_to_uInt(&raw[3]);
+	position->last_send = BigEnE_raw_to_uInt(&raw[7]);
+	return 0;
+}
+
+//the index frame of the data frames of the range so far, it closes the range
+static void build_index(dump_sequencer *seq, byte *frame, uint8_t *length)
+{
+	TM_spl_header header = { DUMP_T, DUMP_INDEX_ST, (unsigned short)(DUMP_INDEX_HEADER_SIZE + seq->range_count * DUMP_INDEX_CRC_SIZE), 0 };
+	byte *data = SPL_TM_DATA(frame);
+	Time_getUnixEpoch(&header.time);
+	write_TM_header(frame, &header, NULL);
+	uShort_to_raw(seq->manifest.dump_id, &data[0]);
+	uShort_to_raw((unsigned short)(seq->sequence - seq->range_count), &data[2]);
+	data[4] = (byte)seq->range_count;
+	for (int i = 0; i < seq->range_count; i++)
+		BigEnE_uInt_to_raw(seq->crcs[i], &data[DUMP_INDEX_HEADER_SIZE + i * DUMP_INDEX_CRC_SIZE]);
+	*length = (uint8_t)(SPL_TM_HEADER_SIZE + header.length);
+	seq->range_count = 0;
+}
+
+//the next frame of the dump, the data frames numbered and an index frame after every range
+static int next_frame(dump_sequencer *seq, byte *frame, uint8_t *length)
+{
+	int result;
+	if (seq->index_pending)
+	{
+		seq->index_pending = FALSE;
+		build_index(seq, frame, length);
+		return 1;
+	}
+	if (seq->ended)
+		return 0;
+	if (seq->range_count == 0 && !seq->resend)
+		save_range(seq);
+
+	result = seq->source(seq->context, frame, length);
+	if (result < 0)
+		return result;
+	if (result == 0)
+	{
+		seq->ended = TRUE;
+		if (seq->range_count == 0)
+			return 0;
+		//the last range of the dump isn't full
+		build_index(seq, frame, length);
+		return 1;
+	}
+	seq->crcs[seq->range_count++] = dump_index_crc(frame, *length);
+	seq->sequence++;
+	if (seq->range_count == DUMP_RANGE_SIZE)
+		seq->index_pending = TRUE;
+	return 1;
+}
+
+static Boolean frame_missing(dump_sequencer *seq, unsigned int sequence)
+{
+	if (sequence < seq->first || sequence >= seq->first + (unsigned int)seq->bitmap_length * 8)
+		return FALSE;
+	unsigned int bit = sequence - seq->first;
+	return (seq->bitmap[bit / 8] >> (7 - bit % 8)) & 1 ? TRUE : FALSE;
+}
+
+static Boolean range_missing(dump_sequencer *seq, unsigned int range)
+{
+	for (unsigned int i = 0; i < DUMP_RANGE_SIZE; i++)
+	{
+		if (frame_missing(seq, range * DUMP_RANGE_SIZE + i))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+//seeks the source to every range with missing frames and builds the range again,
+//only its missing frames and its index frame go out
+static int next_resent_frame(dump_sequencer *seq, byte *frame, uint8_t *length)
+{
+	dump_position position;
+	unsigned int last_range = (seq->first + (unsigned int)seq->bitmap_length * 8 - 1) / DUMP_RANGE_SIZE;
+	while (1)
+	{
+		// 1. the next range with a missing frame
+		if (!seq->in_range)
+		{
+			while (seq->range <= last_range && seq->range < seq->manifest.num_of_ranges && !range_missing(seq, seq->range))
+				seq->range++;
+			if (seq->range > last_range || seq->range >= seq->manifest.num_of_ranges)
+				return 0;
+			//the source is at the start of the range after the one it built last, it seeks only to other ranges
+			if (seq->range != seq->source_range)
+			{
+				if (load_range(seq->range, &position) != 0 || seq->set_position(seq->context, &position) != 0)
+					return -1;
+			}
+			seq->sequence = seq->range * DUMP_RANGE_SIZE;
+			seq->range_count = 0;
+			seq->index_pending = FALSE;
+			seq->ended = FALSE;
+			seq->in_range = TRUE;
+		}
+		// 2. the frames of the range, the index frame closes it
+		unsigned int sequence = seq->sequence;
+		int result = next_frame(seq, frame, length);
+		if (result < 0)
+			return result;
+		if (result == 0 || seq->sequence == sequence)
+		{
+			seq->in_range = FALSE;
+			seq->range++;
+			seq->source_range = result == 1 ? seq->range : DUMP_MANIFEST_MAX_RANGES;
+			if (result == 1)
+				return 1;
+			continue;
+		}
+		if (frame_missing(seq, sequence))
+		{
+			seq->frames_resent++;
+			return 1;
+		}
+	}
+}
+
+int next_sequenced_frame(void *context, byte *frame, uint8_t *length)
+{
+	dump_sequencer *seq = (dump_sequencer*)context;
+	if (seq->resend)
+		return next_resent_frame(seq, frame, length);
+	return next_frame(seq, frame, length);
+}
+
+void dump_sequence_source(dump_sequencer *seq, dump_frame_source source, void *context,
+		dump_position_get get_position, dump_position_set set_position)
+{
+	seq->source = source;
+	seq->context = context;
+	seq->get_position = get_position;
+	seq->set_position = set_position;
+}
+
+int begin_dump_sequence(dump_sequencer *seq, const dump_manifest *manifest, dump_frame_source source, void *context,
+		dump_position_get get_position, dump_position_set set_position)
+{
+	dump_manifest last;
+	byte raw[DUMP_MANIFEST_HEADER_SIZE];
+
+	memset(seq, 0, sizeof(dump_sequencer));
+	dump_sequence_source(seq, source, context, get_position, set_position);
+	seq->manifest = *manifest;
+	//the dump id goes on from the last dump, so the frames of an old dump can't be asked for by mistake
+	seq->manifest.dump_id = 0;
+	if (load_dump_manifest(&last) == 0)
+		seq->manifest.dump_id = (unsigned short)(last.dump_id + 1);
+	seq->manifest.num_of_ranges = 0;
+
+	encode_header(&seq->manifest, raw);
+	int i_error = FRAM_write(raw, DUMP_MANIFEST_ADDR, DUMP_MANIFEST_HEADER_SIZE);
+	check_int("begin_dump_sequence, FRAM_write(DUMP_MANIFEST_ADDR)", i_error);
+	return i_error == 0 ? 0 : -1;
+}
+
+int begin_dump_resend(dump_sequencer *seq, unsigned short dump_id, unsigned int first, const byte *bitmap, int bitmap_length)
+{
+	memset(seq, 0, sizeof(dump_sequencer));
+	if (load_dump_manifest(&seq->manifest) != 0)
+		return -1;
+	if (dump_id != seq->manifest.dump_id || bitmap == NULL || bitmap_length < 1 || bitmap_length > DUMP_RESEND_MAX_BITMAP)
+		return -2;
+	seq->resend = TRUE;
+	seq->bitmap = bitmap;
+	seq->bitmap_length = bitmap_length;
+	seq->first = first;
+	seq->range = first / DUMP_RANGE_SIZE;
+	seq->source_range = DUMP_MANIFEST_MAX_RANGES;
+	return 0;
+}
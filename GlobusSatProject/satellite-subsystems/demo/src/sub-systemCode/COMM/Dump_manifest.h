@@ -0,0 +1,139 @@
+/*
+ * Dump_manifest.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+
+#ifndef DUMP_MANIFEST_H_
+#define DUMP_MANIFEST_H_
+
+#include "../Global/Global.h"
+#include "../Global/sizes.h"
+#include "Dump_pipeline.h"
+
+#define DUMP_RANGE_SIZE				16//data frames of a range, one reading position in the manifest and one index frame each
+#define DUMP_MANIFEST_MAX_RANGES	256//ranges the FRAM manifest holds, the frames after them can't be resent
+#define DUMP_MANIFEST_FILES			5//files of a dump, NUM_FILES_IN_DUMP
+#define DUMP_MANIFEST_HEADER_SIZE	20//dump id (2), files, resolution, start and end time, packed, frame limit, number of ranges (2)
+#define DUMP_RANGE_RAW_SIZE			11//file, parameter (2), chunk time, last send
+#define DUMP_INDEX_HEADER_SIZE		5//dump id (2), sequence number of the first frame (2), frames in the range
+#define DUMP_INDEX_CRC_SIZE			4//CRC32 of every data frame of the range, in its index frame
+//the longest missing frames bitmap of a resend command, after the command id, dump id and first sequence number
+#define DUMP_RESEND_MAX_BITMAP		(SIZE_OF_COMMAND - SPL_TC_HEADER_SIZE - 4)
+
+//the dump command of the last dump, as the manifest keeps it to build its frames again
+typedef struct
+{
+	unsigned short dump_id;
+	byte HK[DUMP_MANIFEST_FILES];//HK_types of the files
+	uint8_t resulotion;
+	time_unix start_time;
+	time_unix end_time;
+	Boolean packed;
+	uint8_t frame_limit;//the longest data frame of the dump
+	unsigned short num_of_ranges;//ranges with a saved reading position
+} dump_manifest;
+
+//where the source of a dump reads the first data frame of a range
+typedef struct
+{
+	signed char file;//index in the files of the dump, -1 before the first file
+	unsigned short parameter;//parameters from the first one of the chunk
+	time_unix chunk_time;//the time the chunk was read from, a cursor opened from it finds the chunk
+	time_unix last_send;//the time of the last record sent, for the resolution
+} dump_position;
+
+/**
+ * @brief		gets the reading position of the source of a dump, between two data frames
+ */
+typedef void (*dump_position_get)(void *context, dump_position *position);
+
+/**
+ * @brief		moves the source of a dump back to a reading position it had
+ * @return		0 on success, -1 on error
+ */
+typedef int (*dump_position_set)(void *context, const dump_position *position);
+
+//numbers the data frames of a dump and adds an index frame after every range of them,
+//on a dump it saves the reading position of every range, on a resend it goes back to them
+typedef struct
+{
+	dump_frame_source source;
+	void *context;
+	dump_position_get get_position;
+	dump_position_set set_position;
+	dump_manifest manifest;
+	Boolean resend;
+	unsigned int sequence;//of the next data frame
+	int range_count;//data frames of the current range so far
+	unsigned int crcs[DUMP_RANGE_SIZE];//of the data frames of the current range
+	Boolean index_pending;//the range is full, its index frame goes out next
+	Boolean ended;
+	//resend
+	const byte *bitmap;//bit i, from the MSB of the first byte, is the frame first + i
+	int bitmap_length;
+	unsigned int first;
+	unsigned int range;//the range being sent
+	unsigned int source_range;//the range the source reads next without a seek, DUMP_MANIFEST_MAX_RANGES for none
+	Boolean in_range;
+	unsigned int frames_resent;
+} dump_sequencer;
+
+/**
+ * @brief		starts the manifest of a new dump in the FRAM, with the next dump id
+ * @param[out]	seq the sequencer of the dump
+ * @param[in]	manifest the dump command, dump_id and num_of_ranges are set here
+ * @param[in]	source, context the frames of the dump
+ * @param[in]	get_position, set_position the reading position of source
+ * @return		0 on success, -1 the manifest could not be written, the dump goes on without it
+ */
+int begin_dump_sequence(dump_sequencer *seq, const dump_manifest *manifest, dump_frame_source source, void *context,
+		dump_position_get get_position, dump_position_set set_position);
+
+/**
+ * @brief		prepares the resend of the missing frames of the last dump
+ * @note		seq->manifest has the dump command after it, the source is initialized from it
+ * 				and given with dump_sequence_source before the pipeline starts
+ * @param[out]	seq the sequencer of the resend
+ * @param[in]	dump_id the dump the frames are missing from
+ * @param[in]	first the sequence number of bit 0 of bitmap
+ * @param[in]	bitmap a set bit for every missing frame, kept by the caller until the resend ends
+ * @param[in]	bitmap_length bytes of bitmap, 1 to DUMP_RESEND_MAX_BITMAP
+ * @return		0 on success, -1 the FRAM could not be read, -2 dump_id isn't the last dump or wrong bitmap
+ */
+int begin_dump_resend(dump_sequencer *seq, unsigned short dump_id, unsigned int first, const byte *bitmap, int bitmap_length);
+
+/**
+ * @brief		sets the source of a resend from begin_dump_resend
+ */
+void dump_sequence_source(dump_sequencer *seq, dump_frame_source source, void *context,
+		dump_position_get get_position, dump_position_set set_position);
+
+/**
+ * @brief		the dump_frame_source of the pipeline, the context is the dump_sequencer
+ * @note		an index frame is a DUMP_T, DUMP_INDEX_ST packet: the DUMP_INDEX_HEADER_SIZE header and the
+ * 				dump_index_crc of every data frame of the range. on a resend only the missing frames
+ * 				of a range go out, with its index frame
+ */
+int next_sequenced_frame(void *context, byte *frame, uint8_t *length);
+
+/**
+ * @return		the CRC32 of a data frame, as the index frames carry it. 32 bits, so the ground can tell
+ * 				the frames of a range apart by it
+ */
+unsigned int dump_index_crc(byte *frame, uint8_t length);
+
+/**
+ * @brief		reads the manifest of the last dump from the FRAM
+ * @return		0 on success, -1 on error
+ */
+int load_dump_manifest(dump_manifest *manifest);
+
+/**
+ * @brief		forgets the reading positions of the last dump, its frames can't be resent after it
+ * @return		0 on success, -1 on error
+ */
+int reset_dump_manifest();
+
+#endif /* DUMP_MANIFEST_H_ */
@@ -0,0 +1,125 @@
+/*
+ * Dump_pipeline.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <satellite-subsystems/IsisTRXVU.h>
+
+#include <string.h>
+
+#include "../TRXVU.h"
+#include "../Global/GlobalParam.h"
+#include "Dump_pipeline.h"
+#include "Tx_scheduler.h"
+
+void init_dump_pipeline(dump_pipeline *pipe, dump_frame_source source, void *context, xQueueHandle abort_queue)
+{
+	memset(pipe, 0, sizeof(dump_pipeline));
+	pipe->source = source;
+	pipe->context = context;
+	pipe->abort_queue = abort_queue;
+}
+
+//reads frames from the source until the ring is full or the source ended,
+//the repair frames of a window go in after its data frames
+static int fill_ring(dump_pipeline *pipe)
+{
+	while (pipe->count < DUMP_RING_SIZE)
+	{
+		int last = (pipe->first + pipe->count) % DUMP_RING_SIZE;
+		if (pipe->fec != NULL && dump_fec_next_repair(pipe->fec, pipe->frames[last], &pipe->lengths[last]))
+		{
+			pipe->count++;
+			continue;
+		}
+		if (pipe->source_ended)
+			break;
+		int result = pipe->source(pipe->context, pipe->frames[last], &pipe->lengths[last]);
+		if (result < 0)
+			return -1;
+		if (result == 0)
+		{
+			pipe->source_ended = TRUE;
+			if (pipe->fec != NULL)
+				dump_fec_end(pipe->fec);
+			continue;
+		}
+		if (pipe->fec != NULL && dump_fec_add(pipe->fec, pipe->frames[last], pipe->lengths[last]) != 0)
+			return -1;
+		pipe->count++;
+	}
+	return 0;
+}
+
+//checks the abort queue without blocking
+static Boolean stop_requested(dump_pipeline *pipe)
+{
+	queueRequest request = nothing;
+	if (pipe->abort_queue == NULL)
+		return FALSE;
+	if (xQueueReceive(pipe->abort_queue, &request, 0) != pdTRUE)
+		return FALSE;
+	return request == deleteTask;
+}
+
+int run_dump_pipeline(dump_pipeline *pipe)
+{
+	int result;
+
+	while (1)
+	{
+		// 1. read ahead until the ring is full
+		if (fill_ring(pipe) != 0)
+			return -1;
+		if (pipe->count == 0)
+		{
+			//the last frames go out from the dump queue
+			Tx_flush_frames();
+			return 0;
+		}
+
+		// 2. once per batch, not once per record
+		if (stop_requested(pipe))
+		{
+			Tx_drop_frames(tx_priority_dump);
+			return 1;
+		}
+		if (!CHECK_TRANSMIT_ABILITY)
+			return 2;
+
+		// 3. the frames go to the dump queue of the Tx scheduler while it has room,
+		//the Tx task sends them between the more urgent frames
+		do
+		{
+			result = Tx_schedule_frame_nowait(pipe->frames[pipe->first], pipe->lengths[pipe->first], trxvu_bitrate_9600, tx_priority_dump);
+			if (result != 0)
+				break;
+			pipe->first = (pipe->first + 1) % DUMP_RING_SIZE;
+			pipe->count--;
+			pipe->frames_sent++;
+		}
+		while (pipe->count > 0);
+		if (result == -2)
+			return -2;
+		if (result != 0 && result != TX_QUEUE_FULL)
+			return 2;
+
+		// 4. the dump queue is full, read ahead while the frames go and sleep the rest of a frame
+		if (result == TX_QUEUE_FULL)
+		{
+			portTickType start = xTaskGetTickCount();
+			if (fill_ring(pipe) != 0)
+				return -1;
+			portTickType frame_time = (portTickType)IsisTrxvu_tcEstimateTransmissionTime(0,
+					pipe->count > 0 ? pipe->lengths[pipe->first] : SIZE_TXFRAME) / portTICK_RATE_MS;
+			portTickType passed = xTaskGetTickCount() - start;
+			Tx_wait(passed < frame_time ? frame_time - passed : 1);
+			pipe->waits++;
+		}
+	}
+}
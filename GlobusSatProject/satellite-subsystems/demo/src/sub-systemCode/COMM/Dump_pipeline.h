@@ -0,0 +1,69 @@
+/*
+ * Dump_pipeline.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+
+#ifndef DUMP_PIPELINE_H_
+#define DUMP_PIPELINE_H_
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+#include "../Global/Global.h"
+#include "Dump_fec.h"
+
+#define DUMP_RING_SIZE	16//number of frames read and encoded ahead of the dump queue
+
+/**
+ * @brief		reads and encodes the next frame of a dump
+ * @param[in]	context the context given to init_dump_pipeline
+ * @param[out]	frame the encoded frame, up to SIZE_TXFRAME bytes
+ * @param[out]	length length of the encoded frame
+ * @return		1 a frame was encoded, 0 there are no more frames, -1 on error
+ */
+typedef int (*dump_frame_source)(void *context, byte *frame, uint8_t *length);
+
+typedef struct
+{
+	byte frames[DUMP_RING_SIZE][SIZE_TXFRAME];
+	uint8_t lengths[DUMP_RING_SIZE];
+	int first;//index of the oldest frame in the ring
+	int count;//number of frames in the ring
+	Boolean source_ended;
+	dump_frame_source source;
+	void *context;
+	xQueueHandle abort_queue;//queue of the requests to stop the dump
+	dump_fec *fec;//repair frames after the data frames of every window, NULL for none
+	//statistics
+	unsigned int frames_sent;//to the dump queue of the Tx scheduler
+	unsigned int waits;//times the pipeline waited for room in the dump queue
+} dump_pipeline;
+
+/**
+ * @brief		prepare a pipeline for a dump
+ * @param[out]	pipe the pipeline
+ * @param[in]	source function that reads and encodes the frames of the dump
+ * @param[in]	context passed to source
+ * @param[in]	abort_queue queue of queueRequest to stop the dump, NULL if it can't be stopped
+ * @note		set pipe->fec after it for repair frames, the source has to keep its frames
+ * 				up to FEC_MAX_DATA_FRAME long
+ */
+void init_dump_pipeline(dump_pipeline *pipe, dump_frame_source source, void *context, xQueueHandle abort_queue);
+
+/**
+ * @brief		transmit all the frames of a dump
+ * @note		frames are read and encoded ahead into a ring while the Tx task sends the frames
+ * 				of the dump queue, and go to the dump queue in batches that fill it. the task sleeps
+ * 				only while the dump queue is full, a stopped dump drops the frames left in it
+ * @param[in]	pipe a pipeline from init_dump_pipeline
+ * @return		0 all the frames were sent,
+ * 				1 the dump was stopped by a request,
+ * 				2 transmitting is not allowed (mute, Tx off or transponder),
+ * 				-1 the source failed or built a frame too long for the repair frames,
+ * 				-2 could not take a semaphore of the Tx scheduler
+ */
+int run_dump_pipeline(dump_pipeline *pipe);
+
+#endif /* DUMP_PIPELINE_H_ */
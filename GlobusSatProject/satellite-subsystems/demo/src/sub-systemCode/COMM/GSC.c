@@ -28,9 +28,9 @@
 #include "GSC.h"
 #include "splTypes.h"
 
-int decode_TCpacket(byte *data, int length, TC_spl *packet)
+int read_TC_header(byte* frame, int length, TC_spl_header* header)
 {
-	if (data == NULL)
+	if (frame == NULL || header == NULL)
 		return -1;
 
 	if (length != -1)
@@ -40,24 +40,40 @@ int decode_TCpacket(byte *data, int length, TC_spl *packet)
 			return 2;
 		}
 	}
-	packet->id = BigEnE_raw_to_uInt(&data[0]);
-	packet->type = (byte)data[4];
-	packet->subType = (byte)data[5];
-	packet->length = (unsigned short)(data[6] << 8);
-	packet->length += (unsigned short)data[7];
+	header->id = BigEnE_raw_to_uInt(&frame[0]);
+	header->type = (byte)frame[4];
+	header->subType = (byte)frame[5];
+	header->length = (unsigned short)(frame[6] << 8);
+	header->length += (unsigned short)frame[7];
 	if (length != -1)
 	{
-		if ((int)packet->length + SPL_TC_HEADER_SIZE != length)
+		if ((int)header->length + SPL_TC_HEADER_SIZE != length)
 		{
 			return 1;
 		}
-		if ((int)packet->length > SIZE_RXFRAME - SPL_TC_HEADER_SIZE)
+		if ((int)header->length > SIZE_RXFRAME - SPL_TC_HEADER_SIZE)
 		{
 			return 3;
 		}
 	}
-	packet->time = (time_unix)BigEnE_raw_to_uInt(&data[8]);
-	memcpy(packet->data, data + SPL_TC_HEADER_SIZE, (int)packet->length);
+	header->time = (time_unix)BigEnE_raw_to_uInt(&frame[8]);
+
+	return 0;
+}
+
+int decode_TCpacket(byte *data, int length, TC_spl *packet)
+{
+	TC_spl_header header;
+	int error = read_TC_header(data, length, &header);
+	if (error != 0)
+		return error;
+
+	packet->id = header.id;
+	packet->type = header.type;
+	packet->subType = header.subType;
+	packet->length = header.length;
+	packet->time = header.time;
+	memcpy(packet->data, SPL_TC_DATA(data), (int)packet->length);
 
 	return 0;
 }
@@ -74,7 +90,7 @@ int encode_TCpacket(byte* data, int *size, TC_spl packet)
 	BigEnE_uInt_to_raw(packet.id, &data[0]);
 	data[4] = (byte)packet.type;
 	data[5] = (byte)packet.subType;
-	data[6] = (byte)packet.length >> 8;
+	data[6] = (byte)(packet.length >> 8);
 	data[7] = (byte)packet.length;
 	BigEnE_uInt_to_raw(packet.time, &data[8]);
 	memcpy(data + SPL_TC_HEADER_SIZE, packet.data, (int)packet.length);
@@ -82,41 +98,143 @@ int encode_TCpacket(byte* data, int *size, TC_spl packet)
 	return 0;
 }
 
-int decode_TMpacket(byte* data, TM_spl *packet)
+int read_TM_header(byte* frame, TM_spl_header* header)
 {
-	if (data == NULL)
+	if (frame == NULL || header == NULL)
 		return -1;
 
-	packet->type = (byte)data[0];
-	packet->subType = (byte)data[1];
-	packet->length = (unsigned short)(data[2] << 8);
-	packet->length += (unsigned short)data[3];
-	if (packet->length > SIZE_TXFRAME - SPL_TM_HEADER_SIZE)
+	header->type = (byte)frame[0];
+	header->subType = (byte)frame[1];
+	header->length = (unsigned short)(frame[2] << 8);
+	header->length += (unsigned short)frame[3];
+	if (header->length > SIZE_TXFRAME - SPL_TM_HEADER_SIZE)
 	{
 		return 1;
 	}
-	packet->time = (time_unix)BigEnE_raw_to_uInt(&data[4]);
-	memcpy(packet->data, data + SPL_TM_HEADER_SIZE, (int)packet->length);
+	header->time = (time_unix)BigEnE_raw_to_uInt(&frame[4]);
 
 	return 0;
 }
 
-int encode_TMpacket(byte* data, int* size, TM_spl packet)
+int decode_TMpacket(byte* data, TM_spl *packet)
 {
-	*size = packet.length + SPL_TM_HEADER_SIZE;
+	TM_spl_header header;
+	int error = read_TM_header(data, &header);
+	if (error != 0)
+		return error;
+
+	packet->type = header.type;
+	packet->subType = header.subType;
+	packet->length = header.length;
+	packet->time = header.time;
+	memcpy(packet->data, SPL_TM_DATA(data), (int)packet->length);
 
+	return 0;
+}
+
+int write_TM_header(byte* frame, TM_spl_header* header, int* size)
+{
+	if (frame == NULL || header == NULL)
+		return -1;
+
+	if (header->length + SPL_TM_HEADER_SIZE > SIZE_TXFRAME)
+		return 1;
+
+	frame[0] = (byte)header->type;
+	frame[1] = (byte)header->subType;
+	frame[2] = (byte)(header->length >> 8);
+	frame[3] = (byte)header->length;
+	BigEnE_uInt_to_raw(header->time, &frame[4]);
+	if (size != NULL)
+		*size = header->length + SPL_TM_HEADER_SIZE;
+
+	return 0;
+}
+
+int encode_TMpacket(byte* data, int* size, TM_spl packet)
+{
 	if (data == NULL || size == NULL)
 		return -1;
 
-	if (*size > SIZE_TXFRAME)
+	TM_spl_header header = { packet.type, packet.subType, packet.length, packet.time };
+	int error = write_TM_header(data, &header, size);
+	if (error != 0)
+		return error;
+
+	memcpy(SPL_TM_DATA(data), packet.data, (int)packet.length);
+
+	return 0;
+}
+
+int init_packed_TMframe(byte* frame, TM_spl_header* first)
+{
+	if (frame == NULL || first == NULL)
+		return -1;
+
+	if (PACKED_TM_HEADER_SIZE + PACKED_TM_OFFSET_SIZE + first->length > SIZE_TXFRAME - SPL_TM_HEADER_SIZE)
+		return 1;
+
+	TM_spl_header packed = { DUMP_T, PACKED_DUMP_ST, PACKED_TM_HEADER_SIZE, first->time };
+	write_TM_header(frame, &packed, NULL);
+	byte* data = SPL_TM_DATA(frame);
+	data[0] = first->type;
+	data[1] = first->subType;
+	data[2] = (byte)first->length;
+	data[3] = 0;
+
+	return 0;
+}
+
+byte* add_to_packed_TMframe(byte* frame, TM_spl_header* record)
+{
+	if (frame == NULL || record == NULL)
+		return NULL;
+
+	//only the length and the number of records change, the header is read and written in place
+	byte* data = SPL_TM_DATA(frame);
+	unsigned short length = (unsigned short)((frame[2] << 8) | frame[3]);
+	time_unix time = (time_unix)BigEnE_raw_to_uInt(&frame[4]);
+	if (record->type != data[0] || record->subType != data[1] || record->length != data[2])
+		return NULL;
+	if (record->time < time || record->time - time > MAX_PACKED_TM_OFFSET)
+		return NULL;
+	if (length + PACKED_TM_OFFSET_SIZE + record->length > SIZE_TXFRAME - SPL_TM_HEADER_SIZE)
+		return NULL;
+
+	byte* raw = data + length;
+	unsigned short offset = (unsigned short)(record->time - time);
+	raw[0] = (byte)(offset >> 8);
+	raw[1] = (byte)offset;
+	length += PACKED_TM_OFFSET_SIZE + record->length;
+	frame[2] = (byte)(length >> 8);
+	frame[3] = (byte)length;
+	data[3]++;
+
+	return raw + PACKED_TM_OFFSET_SIZE;
+}
+
+int unpack_TMframe(byte* frame, int index, TM_spl_header* record, byte** data)
+{
+	TM_spl_header packed;
+	if (frame == NULL || record == NULL || data == NULL)
+		return -1;
+
+	if (read_TM_header(frame, &packed) != 0 || packed.type != DUMP_T || packed.subType != PACKED_DUMP_ST
+			|| packed.length < PACKED_TM_HEADER_SIZE)
+		return 1;
+	byte* packed_data = SPL_TM_DATA(frame);
+	int record_size = PACKED_TM_OFFSET_SIZE + packed_data[2];
+	if (PACKED_TM_HEADER_SIZE + packed_data[3] * record_size != packed.length)
 		return 1;
+	if (index < 0 || index >= packed_data[3])
+		return 2;
 
-	data[0] = (byte)packet.type;
-	data[1] = (byte)packet.subType;
-	data[2] = (byte)packet.length >> 8;
-	data[3] = (byte)packet.length;
-	BigEnE_uInt_to_raw(packet.time, &data[4]);
-	memcpy(data + SPL_TM_HEADER_SIZE, packet.data, (int)packet.length);
+	byte* raw = packed_data + PACKED_TM_HEADER_SIZE + index * record_size;
+	record->type = packed_data[0];
+	record->subType = packed_data[1];
+	record->length = packed_data[2];
+	record->time = packed.time + (time_unix)((raw[0] << 8) | raw[1]);
+	*data = raw + PACKED_TM_OFFSET_SIZE;
 
 	return 0;
 }
@@ -124,18 +242,13 @@ int encode_TMpacket(byte* data, int* size, TM_spl packet)
 int build_raw_ACK(Ack_type type, ERR_type err, command_id ACKcommandId, byte* raw_ACK)
 {
 	//spl header
-	TM_spl spl;
-	spl.type = ACK_TYPE;
-	spl.subType = 	ACK_ST;
-	spl.length = ACK_DATA_LENGTH;
-	time_unix time_now;
-	Time_getUnixEpoch(&time_now);
-	spl.time = time_now;
-	//build data field
-	build_data_field_ACK(type, err, ACKcommandId, spl.data);
-	//encode packet
-	int raw_ACK_len = 0;
-	return encode_TMpacket(raw_ACK, &raw_ACK_len, spl);
+	TM_spl_header spl = { ACK_TYPE, ACK_ST, ACK_DATA_LENGTH, 0 };
+	Time_getUnixEpoch(&spl.time);
+	int error = write_TM_header(raw_ACK, &spl, NULL);
+	if (error != 0)
+		return error;
+	//build data field in place
+	return build_data_field_ACK(type, err, ACKcommandId, SPL_TM_DATA(raw_ACK));
 }
 
 int build_data_field_ACK(Ack_type type, ERR_type err, command_id ACKcommandId, byte* data_feild)
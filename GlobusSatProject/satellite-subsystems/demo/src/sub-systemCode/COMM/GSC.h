@@ -14,6 +14,10 @@
 #define MAX_NAMBER_OF_APRS_PACKETS 20//the max number of APRS packets in the FRAM list
 #define NO_AVAILABLE_SLOTS -1
 
+#define PACKED_TM_HEADER_SIZE	4//type, sub type, length and number of the records in a packed TM packet
+#define PACKED_TM_OFFSET_SIZE	2//time offset of a packed record from the time of its packet
+#define MAX_PACKED_TM_OFFSET	0xffff
+
 typedef enum ERR_type
 {
 	ERR_SUCCESS,
@@ -107,6 +111,28 @@ typedef struct inklajn_spl_TC
 	byte data[SIZE_OF_COMMAND - SPL_TC_HEADER_SIZE];//the data in the packet
 }TC_spl;
 
+//the header of a TM spl packet, its data stays in the frame
+typedef struct
+{
+	uint8_t type;//service type
+	uint8_t subType;//service sub type
+	unsigned short length;//Length of data array
+	time_unix time;//Unix time
+}TM_spl_header;
+
+//the header of a TC spl packet, its data stays in the frame
+typedef struct
+{
+	command_id id;
+	uint8_t type;//service type
+	uint8_t subType;//service sub type
+	unsigned short length;//Length of data array
+	time_unix time;//Unix time
+}TC_spl_header;
+
+#define SPL_TM_DATA(frame)	((frame) + SPL_TM_HEADER_SIZE)//the data of a TM spl packet in its frame
+#define SPL_TC_DATA(frame)	((frame) + SPL_TC_HEADER_SIZE)//the data of a TC spl packet in its frame
+
 /**
  *	@brief			decode raw data to a TM spl packet
  *	@param[in]		data to decode
@@ -152,6 +178,74 @@ int decode_TCpacket(byte* data, int length, TC_spl* packet);//this function use
  */
 int encode_TCpacket(byte* data, int* size, TC_spl packet);//this function use calloc for the data
 
+/**
+ *	@brief			write the header of a TM spl packet in place, before its data
+ *	@param[out]		frame the frame of the packet, its data is at SPL_TM_DATA(frame)
+ *	@param[in]		header of the packet
+ *	@param[out]		size length of the packet in the frame, can be NULL
+ *	@return			0 no problems in writing,
+ *					1 a problem with length
+ *					-1 a NULL pointer
+ */
+int write_TM_header(byte* frame, TM_spl_header* header, int* size);
+
+/**
+ *	@brief			read the header of a TM spl packet in place, without copying its data
+ *	@param[in]		frame the frame of the packet
+ *	@param[out]		header of the packet
+ *	@return			0 no problems in reading,
+ *					1 a problem with length
+ *					-1 a NULL pointer
+ */
+int read_TM_header(byte* frame, TM_spl_header* header);
+
+/**
+ *	@brief			read the header of a TC spl packet in place, without copying its data
+ *	@param[in]		frame the frame of the packet, its data is at SPL_TC_DATA(frame)
+ *	@param[in]		length of the frame
+ *	@note			if length is -1 that means that the command is delayed command
+ *	@param[out]		header of the packet
+ *	@return			0 no problems in reading,
+ *					1 ,2 ,3 a problem with length
+ *					-1 a NULL pointer
+ */
+int read_TC_header(byte* frame, int length, TC_spl_header* header);
+
+/**
+ *	@brief			start a packed TM packet (PACKED_DUMP_ST) in a frame, for records like 'first'
+ *	@param[out]		frame the frame of the packed packet, its time is the time of 'first'
+ *	@param[in]		first header of the first record, added with add_to_packed_TMframe
+ *	@return			0 no problems in packing,
+ *					1 the record is too long to be packed
+ *					-1 a NULL pointer
+ */
+int init_packed_TMframe(byte* frame, TM_spl_header* first);
+
+/**
+ *	@brief			make room for a record in a packed TM packet
+ *	@param[in][out]	frame the frame of the packed packet
+ *	@param[in]		record header of the record
+ *	@note			a record is added only if it has the type, sub type and length of the
+ *					records in the packet and its time is up to MAX_PACKED_TM_OFFSET seconds
+ *					after the time of the packet
+ *	@return			where the data of the record goes in the frame,
+ *					NULL if the packet is full or the record doesn't match it
+ */
+byte* add_to_packed_TMframe(byte* frame, TM_spl_header* record);
+
+/**
+ *	@brief			get a record out of a packed TM packet, in place
+ *	@param[in]		frame the frame of the packed packet
+ *	@param[in]		index of the record in the packet
+ *	@param[out]		record header of the record
+ *	@param[out]		data where the data of the record is in the frame
+ *	@return			0 no problems in unpacking,
+ *					1 not a packed packet or a bad header
+ *					2 index out of range
+ *					-1 a NULL pointer
+ */
+int unpack_TMframe(byte* frame, int index, TM_spl_header* record, byte** data);
+
 /**
  * @brief 		build Ack inside spl.
  * @param[in] 	type Ack type according to Ack_type (typedef enum).
@@ -0,0 +1,63 @@
+/*
+ * Rx_engine.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <satellite-subsystems/IsisTRXVU.h>
+
+#include "../Global/GlobalParam.h"
+#include "Rx_engine.h"
+
+int drain_Rx_frames(rx_frame_handler handler)
+{
+	int i_error;
+	int handled = 0;
+	unsigned short RxCounter = 0;
+	byte receive_frm[SIZE_RXFRAME];
+	ISIStrxvuRxFrame rxFrameCmd;
+
+	i_error = IsisTrxvu_rcGetFrameCount(I2C_BUS_ADDR, &RxCounter);
+	check_int("drain_Rx_frames, IsisTrxvu_rcGetFrameCount", i_error);
+	if (i_error != 0)
+		return -1;
+
+	while (RxCounter > 0 && handled < RX_MAX_FRAMES_PER_WAKE)
+	{
+		//1. the frames counted, without counting again before every frame
+		for (; RxCounter > 0 && handled < RX_MAX_FRAMES_PER_WAKE; RxCounter--)
+		{
+			rxFrameCmd.rx_length = 0;
+			rxFrameCmd.rx_doppler = 0;
+			rxFrameCmd.rx_rssi = 0;
+			rxFrameCmd.rx_framedata = receive_frm;
+			i_error = IsisTrxvu_rcGetCommandFrame(I2C_BUS_ADDR, &rxFrameCmd);
+			check_int("drain_Rx_frames, IsisTrxvu_rcGetCommandFrame", i_error);
+			if (i_error != 0)
+				return handled > 0 ? handled : -1;
+			handled++;
+			if (rxFrameCmd.rx_length > 0 && rxFrameCmd.rx_length <= SIZE_RXFRAME)
+				handler(receive_frm, rxFrameCmd.rx_length);
+		}
+		//2. the frames that arrived while the batch was handled
+		if (handled < RX_MAX_FRAMES_PER_WAKE)
+		{
+			i_error = IsisTrxvu_rcGetFrameCount(I2C_BUS_ADDR, &RxCounter);
+			check_int("drain_Rx_frames, IsisTrxvu_rcGetFrameCount", i_error);
+			if (i_error != 0)
+				break;
+		}
+	}
+
+	return handled;
+}
+
+portTickType Rx_poll_delay()
+{
+	if (get_ground_conn())
+		return RX_POLL_DELAY_PASS / portTICK_RATE_MS;
+	return RX_POLL_DELAY_IDLE / portTICK_RATE_MS;
+}
@@ -0,0 +1,43 @@
+/*
+ * Rx_engine.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+
+#ifndef RX_ENGINE_H_
+#define RX_ENGINE_H_
+
+#include <freertos/FreeRTOS.h>
+
+#include "../Global/Global.h"
+
+#define RX_MAX_FRAMES_PER_WAKE	40//frames drained in one wake up, the depth of the Rx buffer
+
+#define RX_POLL_DELAY_PASS	50//ms between two polls of the Rx buffer during a pass above ground
+#define RX_POLL_DELAY_IDLE	500//ms between two polls of the Rx buffer out of a pass
+
+/**
+ * @brief		handles a frame taken out of the Rx buffer
+ * @param[in]	frame the raw frame, SIZE_RXFRAME bytes the handler can write to
+ * @param[in]	length length of the frame
+ */
+typedef void (*rx_frame_handler)(byte *frame, unsigned int length);
+
+/**
+ * @brief		takes every frame in the Rx buffer out and hands it to the handler,
+ * 				including the frames that arrived while the handler ran
+ * @param[in]	handler called for every frame, in the order of arrival
+ * @note		one frame count read for every batch, one read of every frame,
+ * 				up to RX_MAX_FRAMES_PER_WAKE frames
+ * @return		number of frames handled, -1 if the Rx buffer could not be read
+ */
+int drain_Rx_frames(rx_frame_handler handler);
+
+/**
+ * @brief		the time to wait before the next drain_Rx_frames
+ * @return		RX_POLL_DELAY_PASS during a pass above ground, RX_POLL_DELAY_IDLE otherwise, in ticks
+ */
+portTickType Rx_poll_delay();
+
+#endif /* RX_ENGINE_H_ */
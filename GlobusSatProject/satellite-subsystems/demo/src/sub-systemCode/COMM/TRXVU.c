@@ -38,6 +38,12 @@
 #include "../Global/GlobalParam.h"
 #include "../ADCS/Stage_Table.h"
 #include "DelayedCommand_list.h"
+#include "Dump_pipeline.h"
+#include "Dump_manifest.h"
+#include "Rx_engine.h"
+#include "Tx_scheduler.h"
+#include "Ack_pipeline.h"
+#include "Beacon_scheduler.h"
 
 #define FIRST 0
 
@@ -49,8 +55,10 @@ xSemaphoreHandle xIsTransmitting;
 time_unix allow_transponder;
 
 xTaskHandle xBeaconTask;
+xTaskHandle xAckTask;
+xTaskHandle xTxTask;
 
-static byte Dump_buffer[DUMP_BUFFER_SIZE];
+static byte Dump_window[DUMP_WINDOW_SIZE];
 
 
 void init_trxvu(void)
@@ -113,7 +121,7 @@ void TRXVU_task()
 	xTransponderQueue = xQueueCreate(1, sizeof(queueRequest));
 	vTaskDelay(SYSTEM_DEALY);
 	//2. check if the queues and the semaphore successfully created
-	if (xDumpQueue == NULL || xTransponderQueue == NULL || xIsTransmitting == NULL)
+	if (xDumpQueue == NULL || xTransponderQueue == NULL || xIsTransmitting == NULL || init_Tx_scheduler() != 0 || init_Ack_pipeline() != 0)
 	{
 		//2.1. in case the semaphore and queues are damaged
 		return;
@@ -122,6 +130,14 @@ void TRXVU_task()
 	lu_error = xTaskCreate(Beacon_task, (const signed char * const)"Beacon_Task", BEACON_TASK_BUFFER, NULL, (unsigned portBASE_TYPE)(configMAX_PRIORITIES - 2), xBeaconTask);
 	check_portBASE_TYPE("could not create Beacon Task.", lu_error);
 	vTaskDelay(SYSTEM_DEALY);
+	//3.1. create ACK task, below the other tasks so the ACKs they post go in one batch
+	lu_error = xTaskCreate(Ack_task, (const signed char * const)"Ack_Task", ACK_TASK_BUFFER, NULL, (unsigned portBASE_TYPE)(configMAX_PRIORITIES - 3), &xAckTask);
+	check_portBASE_TYPE("could not create ACK Task.", lu_error);
+	vTaskDelay(SYSTEM_DEALY);
+	//3.2. create Tx task, above the other tasks so the transmitter never runs out of frames
+	lu_error = xTaskCreate(Tx_task, (const signed char * const)"Tx_Task", TX_TASK_BUFFER, NULL, (unsigned portBASE_TYPE)(configMAX_PRIORITIES - 1), &xTxTask);
+	check_portBASE_TYPE("could not create Tx Task.", lu_error);
+	vTaskDelay(SYSTEM_DEALY);
 	//4. checks if theres was a dump before the reset and turned him off
 	if (get_system_state(dump_param))
 	{
@@ -135,79 +151,278 @@ void TRXVU_task()
 	while(1)
 	{
 		trxvu_logic();
-		vTaskDelay(TASK_DELAY);
+		vTaskDelay(Rx_poll_delay());
 	}
 }
 
 
-void dump_logic(command_id cmdID, time_unix start_time, time_unix end_time, uint8_t resulotion, HK_types HK[5])
+//reading position of a dump, the source of its dump_pipeline
+typedef struct
 {
+	HK_types *HK;
+	int file;//index in HK of the file being dumped
 	char fileName[MAX_F_FILE_NAME_SIZE];
-	ERR_type err = ERR_SUCCESS;
-	int numberOfParameters, parameterSize;
+	int parameterSize;
+	time_unix start_time;
+	time_unix end_time;
+	time_unix last_send;
+	uint8_t resulotion;
+	Boolean packed;//packs the records of a file in PACKED_DUMP_ST packets
+	int frame_limit;//the longest frame, shorter than SIZE_TXFRAME when repair frames cover the frames
+	C_FILE_CURSOR cursor;//over the file being dumped, the records are read once
+	Boolean cursor_open;
+	int numberOfParameters;//number of parameters in Dump_window
+	int parameter;//next parameter in Dump_window
+	time_unix chunk_time;//time the cursor finds the chunk from
+	int chunk_skip;//parameters from chunk_time to the first one in Dump_window
 	FileSystemResult FS_result;
+} dump_source;
+
+static void close_dump_file(dump_source *source)
+{
+	if (source->cursor_open)
+		c_fileCursorClose(&source->cursor);
+	source->cursor_open = FALSE;
+}
+
+//reads the next records of the current file to Dump_window, the cursor is closed at the end of the file
+static int read_dump_window(dump_source *source)
+{
+	int read = 0;
+	int skip = source->chunk_skip + source->numberOfParameters;
+	time_unix first_time;
+	source->numberOfParameters = 0;
+	source->parameter = 0;
+	if (!source->cursor_open)
+		return 0;
+	source->FS_result = c_fileCursorNext(&source->cursor, Dump_window, DUMP_WINDOW_SIZE / source->parameterSize, &read);
+	if (source->FS_result != FS_SUCCSESS || read == 0)
+	{
+		close_dump_file(source);
+		return source->FS_result == FS_SUCCSESS ? 0 : -1;
+	}
+	// a chunk starts at a new time, records of the same time go on counting in it
+	memcpy(&first_time, Dump_window, TIME_SIZE);
+	if (first_time != source->chunk_time)
+	{
+		source->chunk_time = first_time;
+		skip = 0;
+	}
+	source->chunk_skip = skip;
+	source->numberOfParameters = read;
+	return read;
+}
+
+//opens the cursor of the current file from a time and reads its first window
+static int open_dump_file(dump_source *source, time_unix from_time)
+{
+	close_dump_file(source);
+	source->numberOfParameters = 0;
+	source->parameter = 0;
+	source->chunk_time = from_time;
+	source->chunk_skip = 0;
+	source->FS_result = c_fileCursorOpen(source->fileName, from_time, source->end_time, &source->cursor);
+	if (source->FS_result != FS_SUCCSESS)
+		return -1;
+	source->cursor_open = TRUE;
+	return read_dump_window(source);
+}
+
+//the length of the packet built in frame
+static int end_dump_frame(byte *frame, uint8_t *length)
+{
+	TM_spl_header header;
+	if (read_TM_header(frame, &header) != 0)
+		return -1;
+	*length = (uint8_t)(header.length + SPL_TM_HEADER_SIZE);
+	return 1;
+}
+
+//builds the packets in the frame of the pipeline, the data of the records isn't copied on the way
+static int next_dump_frame(void *context, byte *frame, uint8_t *length)
+{
+	dump_source *source = (dump_source*)context;
+	TM_spl_header record;
+	byte *raw_record;
+	byte *record_data;
+	Boolean packing = FALSE;//a packed packet is being filled in frame
+	int packed_length = 0;//of the packed frame
+
+	while (1)
+	{
+		// 1. next parameter of the chunk, if the resolution lets it out
+		if (source->parameter < source->numberOfParameters)
+		{
+			raw_record = Dump_window + source->parameter * source->parameterSize;
+			if (build_HK_spl_header(source->HK[source->file], raw_record, &record) != 0)
+				return -1;
+			if (source->last_send + (time_unix)source->resulotion <= record.time || source->HK[source->file] == ACK_T)
+			{
+				if (!packing && (!source->packed || SPL_TM_HEADER_SIZE + PACKED_TM_HEADER_SIZE + PACKED_TM_OFFSET_SIZE
+						+ record.length > source->frame_limit || init_packed_TMframe(frame, &record) != 0))
+				{
+					// a packet of its own, also for records too long to be packed
+					source->parameter++;
+					source->last_send = record.time;
+					if (write_TM_header(frame, &record, NULL) != 0)
+						return -1;
+					build_HK_spl_data(source->HK[source->file], raw_record, SPL_TM_DATA(frame));
+					return end_dump_frame(frame, length);
+				}
+				if (!packing)
+					packed_length = SPL_TM_HEADER_SIZE + PACKED_TM_HEADER_SIZE;
+				record_data = NULL;
+				if (packed_length + PACKED_TM_OFFSET_SIZE + record.length <= source->frame_limit)
+					record_data = add_to_packed_TMframe(frame, &record);
+				if (record_data == NULL)
+				{
+					// the record starts the next packet
+					return end_dump_frame(frame, length);
+				}
+				build_HK_spl_data(source->HK[source->file], raw_record, record_data);
+				packed_length += PACKED_TM_OFFSET_SIZE + record.length;
+				packing = TRUE;
+				source->last_send = record.time;
+			}
+			source->parameter++;
+			continue;
+		}
+		// 2. next window of the file, the cursor goes on from the end of the last one
+		if (source->cursor_open)
+		{
+			read_dump_window(source);
+			continue;
+		}
+		// 3. the packed packet of the last records of the file
+		if (packing)
+			return end_dump_frame(frame, length);
+		// 4. next file
+		do
+		{
+			source->file++;
+		}
+		while (source->file < NUM_FILES_IN_DUMP && source->HK[source->file] == this_is_not_the_file_you_are_looking_for);
+		if (source->file >= NUM_FILES_IN_DUMP)
+			return 0;
+
+		find_fileName(source->HK[source->file], source->fileName);
+		source->parameterSize = (size_of_element(source->HK[source->file]) + TIME_SIZE);
+		source->last_send = 0;
+		// a file that can't be read is skipped, like in the dumps before
+		open_dump_file(source, source->start_time);
+	}
+}
+
+static void init_dump_source(dump_source *source, HK_types HK[5], time_unix start_time, time_unix end_time, uint8_t resulotion, Boolean packed)
+{
+	memset(source, 0, sizeof(dump_source));
+	source->HK = HK;
+	source->file = -1;
+	source->start_time = start_time;
+	source->end_time = end_time;
+	source->resulotion = resulotion;
+	source->packed = packed;
+	source->frame_limit = SIZE_TXFRAME;
+}
+
+//the reading position of the next data frame, for the manifest of the dump
+static void get_dump_position(void *context, dump_position *position)
+{
+	dump_source *source = (dump_source*)context;
+	position->file = (signed char)source->file;
+	position->parameter = (unsigned short)(source->chunk_skip + source->parameter);
+	position->chunk_time = source->chunk_time;
+	position->last_send = source->last_send;
+}
+
+//seeks back to a position of the manifest, the cursor is opened again from the time of the chunk
+static int set_dump_position(void *context, const dump_position *position)
+{
+	dump_source *source = (dump_source*)context;
+	int skip = position->parameter;
+	if (position->file >= NUM_FILES_IN_DUMP)
+		return -1;
+	close_dump_file(source);
+	source->file = position->file;
+	source->numberOfParameters = 0;
+	source->parameter = 0;
+	source->FS_result = FS_SUCCSESS;
+	if (source->file >= 0)
+	{
+		find_fileName(source->HK[source->file], source->fileName);
+		source->parameterSize = (size_of_element(source->HK[source->file]) + TIME_SIZE);
+		// a file that can't be read is skipped, like in the dump
+		open_dump_file(source, position->chunk_time);
+		while (source->numberOfParameters > 0 && skip >= source->numberOfParameters)
+		{
+			skip -= source->numberOfParameters;
+			read_dump_window(source);
+		}
+		if (source->numberOfParameters > 0)
+			source->parameter = skip;
+	}
+	source->last_send = position->last_send;
+	return 0;
+}
 
-	TM_spl packet;
-	int length_raw_packet;
-	byte raw_packet[MAX_SIZE_TM_PACKET];
+static ERR_type run_dump(dump_pipeline *pipe)
+{
+	switch (run_dump_pipeline(pipe))
+	{
+	case 0:
+		return ERR_SUCCESS;
+	case 1:
+		return ERR_STOP_TASK;
+	case 2:
+		return ERR_TURNED_OFF;
+	default:
+		return ERR_FAIL;
+	}
+}
 
-	time_unix last_read = 0;
-	time_unix last_send = 0;
+void dump_logic(command_id cmdID, time_unix start_time, time_unix end_time, uint8_t resulotion, HK_types HK[5], Boolean packed, uint8_t num_of_repair)
+{
+	ERR_type err = ERR_SUCCESS;
+	static dump_pipeline pipe;
+	static dump_fec fec;
+	static dump_sequencer seq;
+	dump_source source;
+	dump_manifest manifest;
 
 	sendRequestToStop_transponder();
 	vTaskDelay(SYSTEM_DEALY);
 
-	int i_error;
-	int numberOfPackets = 0;
-
 	if (CHECK_STARTING_DUMP_ABILITY)
 	{
 #ifdef TESTING_BRONFELD
 		for (uint8_t i = 0; i < 210; i++)
 		{
-			i_error = TRX_sendFrame(&i, (uint8_t)1, trxvu_bitrate_9600);
+			int i_error = TRX_sendFrame(&i, (uint8_t)1, trxvu_bitrate_9600, tx_priority_dump);
 			check_int("TRX_sendFrame, dump_logic", i_error);
 			printf("number of packets: %u\n", i);
 		}
 #else
+		Boolean repair = num_of_repair > 0 && init_dump_fec(&fec, num_of_repair) == 0;
+		init_dump_source(&source, HK, start_time, end_time, resulotion, packed);
+		if (repair)
+			source.frame_limit = FEC_MAX_DATA_FRAME;
 
+		// the frames are numbered and the manifest keeps where every range of them is read from
 		for (int i = 0; i < NUM_FILES_IN_DUMP; i++)
-		{
-			if (HK[i] == this_is_not_the_file_you_are_looking_for)
-				continue;
-
-			find_fileName(HK[i], fileName);
-			parameterSize = (size_of_element(HK[i]) + TIME_SIZE);
-			last_read = start_time;
-			last_send = 0;
-			do
-			{
-				numberOfParameters = 0;
-				FS_result = c_fileRead(fileName, Dump_buffer, DUMP_BUFFER_SIZE, start_time, end_time,
-						&numberOfParameters, &last_read);
-
-				if (FS_result != FS_SUCCSESS && FS_result != FS_BUFFER_OVERFLOW)
-					break;
-
-				last_read++;
-				for (int l = 0; l < numberOfParameters; l++)
-				{
-					build_HK_spl_packet(HK[i], Dump_buffer + l * parameterSize, &packet);
-					encode_TMpacket(raw_packet, &length_raw_packet, packet);
-
-					if (last_send + (time_unix)resulotion <= packet.time || HK[i] == ACK_T)
-					{
-						last_send = packet.time;
-						i_error = TRX_sendFrame(raw_packet, (uint8_t)length_raw_packet, trxvu_bitrate_9600);
-						check_int("TRX_sendFrame, dump_logic", i_error);
-						printf("number of packets: %d\n", numberOfPackets++);
-						vTaskDelay(SYSTEM_DEALY);
-					}
-					lookForRequestToDelete_dump(cmdID);
-				}
-			}
-			while (FS_result == FS_BUFFER_OVERFLOW);
-		}
+			manifest.HK[i] = (byte)HK[i];
+		manifest.resulotion = resulotion;
+		manifest.start_time = start_time;
+		manifest.end_time = end_time;
+		manifest.packed = packed;
+		manifest.frame_limit = (uint8_t)source.frame_limit;
+		begin_dump_sequence(&seq, &manifest, next_dump_frame, &source, get_dump_position, set_dump_position);
+
+		init_dump_pipeline(&pipe, next_sequenced_frame, &seq, xDumpQueue);
+		if (repair)
+			pipe.fec = &fec;
+		err = run_dump(&pipe);
+		close_dump_file(&source);
+		printf("number of packets: %u, dump id: %u\n", pipe.frames_sent, seq.manifest.dump_id);
 #endif
 	}
 
@@ -221,6 +436,8 @@ void Dump_task(void *arg)
 	time_unix endTime;
 	command_id id;
 	uint8_t resulotion;
+	Boolean packed;
+	uint8_t num_of_repair;
 	HK_types HK_dump_type[5];
 
 	id = BigEnE_raw_to_uInt(&dump_param_data[0]);
@@ -229,6 +446,8 @@ void Dump_task(void *arg)
 	resulotion = dump_param_data[9];
 	startTime = BigEnE_raw_to_uInt(&dump_param_data[10]);
 	endTime = BigEnE_raw_to_uInt(&dump_param_data[14]);
+	packed = dump_param_data[18] ? TRUE : FALSE;
+	num_of_repair = dump_param_data[19];
 
 	if (get_system_state(dump_param))
 	{
@@ -242,7 +461,7 @@ void Dump_task(void *arg)
 	}
 
 	// 2. check if parameters are legal
-	if (startTime > endTime)
+	if (startTime > endTime || num_of_repair > FEC_MAX_REPAIR)
 	{
 		save_ACK(ACK_DUMP, ERR_PARAMETERS, id);
 		set_system_state(dump_param, SWITCH_OFF);
@@ -251,13 +470,100 @@ void Dump_task(void *arg)
 	{
 		vTaskDelay(SYSTEM_DEALY);
 		xQueueReset(xDumpQueue);
-		dump_logic(id, startTime, endTime, resulotion, HK_dump_type);
+		dump_logic(id, startTime, endTime, resulotion, HK_dump_type, packed, num_of_repair);
 	}
 
 	set_system_state(dump_param, SWITCH_OFF);
 	vTaskDelete(NULL);
 }
 
+void resend_logic(command_id cmdID, unsigned short dump_id, unsigned int first, byte *bitmap, int bitmap_length)
+{
+	ERR_type err = ERR_SUCCESS;
+	static dump_pipeline pipe;
+	static dump_sequencer seq;
+	dump_source source;
+	HK_types HK[NUM_FILES_IN_DUMP];
+
+	sendRequestToStop_transponder();
+	vTaskDelay(SYSTEM_DEALY);
+
+	switch (begin_dump_resend(&seq, dump_id, first, bitmap, bitmap_length))
+	{
+	case 0:
+		break;
+	case -1:
+		save_ACK(ACK_DUMP, ERR_FRAM_READ_FAIL, cmdID);
+		return;
+	default:
+		save_ACK(ACK_DUMP, ERR_PARAMETERS, cmdID);
+		return;
+	}
+
+	if (CHECK_STARTING_DUMP_ABILITY)
+	{
+		// the source of the dump, as the manifest kept its command
+		for (int i = 0; i < NUM_FILES_IN_DUMP; i++)
+			HK[i] = (HK_types)seq.manifest.HK[i];
+		init_dump_source(&source, HK, seq.manifest.start_time, seq.manifest.end_time, seq.manifest.resulotion, seq.manifest.packed);
+		source.frame_limit = seq.manifest.frame_limit;
+		dump_sequence_source(&seq, next_dump_frame, &source, get_dump_position, set_dump_position);
+
+		init_dump_pipeline(&pipe, next_sequenced_frame, &seq, xDumpQueue);
+		err = run_dump(&pipe);
+		close_dump_file(&source);
+		printf("number of packets resent: %u\n", seq.frames_resent);
+	}
+
+	save_ACK(ACK_DUMP, err, cmdID);
+}
+
+void Dump_resend_task(void *arg)
+{
+	byte* resend_param_data = (byte*)arg;
+	byte bitmap[DUMP_RESEND_MAX_BITMAP];
+	command_id id;
+	unsigned short dump_id;
+	unsigned int first;
+	int bitmap_length;
+
+	id = BigEnE_raw_to_uInt(&resend_param_data[0]);
+	bitmap_length = resend_param_data[4];
+	dump_id = BigEnE_raw_to_uShort(&resend_param_data[5]);
+	first = BigEnE_raw_to_uShort(&resend_param_data[7]);
+	if (bitmap_length > DUMP_RESEND_MAX_BITMAP)
+		bitmap_length = DUMP_RESEND_MAX_BITMAP;
+	memcpy(bitmap, &resend_param_data[9], bitmap_length);
+
+	if (get_system_state(dump_param))
+	{
+		//	exit dump task and saves ACK
+		save_ACK(ACK_DUMP, ERR_TASK_EXISTS, id);
+		vTaskDelete(NULL);
+	}
+	else
+	{
+		set_system_state(dump_param, SWITCH_ON);
+	}
+
+	vTaskDelay(SYSTEM_DEALY);
+	xQueueReset(xDumpQueue);
+	resend_logic(id, dump_id, first, bitmap, bitmap_length);
+
+	set_system_state(dump_param, SWITCH_OFF);
+	vTaskDelete(NULL);
+}
+
+
+//back to nominal mode between two frames of the Tx scheduler
+static void end_transponder()
+{
+	portBASE_TYPE lu_error = xSemaphoreTake(xIsTransmitting, MAX_DELAY);
+	check_portBASE_TYPE("error in transponder task, semaphore xIsTransmitting", lu_error);
+	change_TRXVU_state(NOMINAL_MODE);
+	if (lu_error == pdTRUE)
+		xSemaphoreGive(xIsTransmitting);
+}
 
 void transponder_logic(time_unix time, command_id cmdID)
 {
@@ -320,20 +626,20 @@ void Transponder_task(void *arg)
 		time = time_now + DEFAULT_TIME_TRANSMITTER;
 	}
 
-	if (xSemaphoreTake(xIsTransmitting, MAX_DELAY) == pdTRUE)
+	if (!get_system_state(mute_param) && get_system_state(Tx_param))
 	{
-		if (!get_system_state(mute_param) && get_system_state(Tx_param))
-		{
-			save_ACK(ACK_TRANSPONDER, ERR_ACTIVE, cmdId);
-			change_TRXVU_state(TRANSPONDER_MODE);
-			xQueueReset(xTransponderQueue);
-			transponder_logic(time, cmdId);
-		}
+		save_ACK(ACK_TRANSPONDER, ERR_ACTIVE, cmdId);
+		//xIsTransmitting only while the mode changes, the Tx scheduler sends nothing in transponder mode
+		lu_error = xSemaphoreTake(xIsTransmitting, MAX_DELAY);
+		check_portBASE_TYPE("error in transponder task, semaphore xIsTransmitting", lu_error);
+		change_TRXVU_state(TRANSPONDER_MODE);
+		if (lu_error == pdTRUE)
+			xSemaphoreGive(xIsTransmitting);
+		xQueueReset(xTransponderQueue);
+		transponder_logic(time, cmdId);
 	}
 
-	change_TRXVU_state(NOMINAL_MODE);
-	lu_error = xSemaphoreGive(xIsTransmitting);
-	check_portBASE_TYPE("error in transponder task, semaphore xIsTransmitting", lu_error);
+	end_transponder();
 	vTaskDelete(NULL);
 }
 
@@ -348,9 +654,7 @@ void lookForRequestToDelete_transponder(command_id cmdID)
 		if (queueParameter == deleteTask)
 		{
 			save_ACK(ACK_TRANSPONDER, ERR_STOP_TASK, cmdID);
-			change_TRXVU_state(NOMINAL_MODE);
-			portBASE_TYPE lu_error = xSemaphoreGive(xIsTransmitting);
-			check_portBASE_TYPE("error in transponder task, semaphore xIsTransmitting", lu_error);
+			end_transponder();
 			vTaskDelete(NULL);
 		}
 	}
@@ -411,56 +715,73 @@ int sendRequestToStop_transponder()
 }
 
 
-void Rx_logic()
+//the ACK task sends the receive ACK of a command
+static void post_receive_ACK(ERR_type err, command_id id)
+{
+	if (post_ACK(ACK_RECEIVE_COMM, err, id, ACK_SEND) != 0)
+	{
+		//the ACK task can't take it, goes out with the next frames sent
+		byte rawACK[ACK_RAW_SIZE];
+		build_raw_ACK(ACK_RECEIVE_COMM, err, id, rawACK);
+		Tx_schedule_frame(rawACK, ACK_RAW_SIZE, trxvu_bitrate_9600, tx_priority_ACK);
+	}
+}
+
+//checks if a frame from the Rx buffer is a command, APRS packet or just Junk, and handles it
+static void handle_Rx_frame(byte *dataBuffer, unsigned int dataBuffer_length)
 {
 	int i_error;
-	byte dataBuffer[SIZE_RXFRAME];
-	unsigned int dataBuffer_length;
+	TC_spl_header header;
 	TC_spl packet;
-	unsigned short RxCounter = 0;
 	time_unix time_now;
 
-	i_error = IsisTrxvu_rcGetFrameCount(I2C_BUS_ADDR, &RxCounter);
-	check_int("IsisTrxvu_rcGetFrameCount, trxvu_logic", i_error);
-	if (RxCounter > 0)
+#ifdef APRS_ON
+	// 1.1. APRS packets are saved to the FRAM list
+	if (dataBuffer_length == 18 && check_APRS(dataBuffer) != 0)
+		return;
+#endif
+	// 1.2. reads the spl header in the frame, junk isn't copied
+	i_error = read_TC_header(dataBuffer, dataBuffer_length, &header);
+	if (i_error == 0)
 	{
-		//	1.1. gets data from Rx buffer
-		i_error = TRX_getFrameData(&dataBuffer_length, dataBuffer);
-		if (dataBuffer != NULL && i_error == 0)
+		set_ground_conn(TRUE);
+
+		i_error = Time_getUnixEpoch(&time_now);
+		check_int("trxvu_logic, Time_getUnixEpoch", i_error);
+		// 1.3. checks if command is delayed command
+		if (header.time <= time_now)
 		{
-			// 1.2. decode data to spl packet
-			i_error = decode_TCpacket(dataBuffer, dataBuffer_length ,&packet);
-			if (i_error == 0)
+			//execute command, decoded right into its slot in the command queue
+			TC_spl *slot = reserve_command();
+			if (slot == NULL || decode_TCpacket(dataBuffer, dataBuffer_length, slot) != 0)
 			{
-				set_ground_conn(TRUE);
-				// 1.3. sends receive ACK
-				byte rawACK[ACK_RAW_SIZE];
-				build_raw_ACK(ACK_RECEIVE_COMM, ERR_SUCCESS, packet.id, rawACK);
-				printf("Send ACK\n");
-				TRX_sendFrame(rawACK, ACK_RAW_SIZE, trxvu_bitrate_9600);
-
-				i_error = Time_getUnixEpoch(&time_now);
-				check_int("trxvu_logic, Time_getUnixEpoch", i_error);
-				// 1.4. checks if command is delayed command
-				if (packet.time <= time_now)
-				{
-					//execute command
-					add_command(packet);
-				}
-				else
-				{
-					add_delayCommand(packet);
-				}
+				//the command queue is full or the command is corrupted, the ground sends it again
+				post_receive_ACK(ERR_FAIL, header.id);
+				return;
 			}
+			// 1.4. the receive ACK goes before the ACKs of the execution
+			post_receive_ACK(ERR_SUCCESS, header.id);
+			commit_command();
+		}
+		else
+		{
+			decode_TCpacket(dataBuffer, dataBuffer_length, &packet);
+			// 1.4. the receive ACK tells if the delayed command list took the command
+			post_receive_ACK(add_delayCommand(packet) == 0 ? ERR_SUCCESS : ERR_FAIL, header.id);
+		}
+	}
 #ifdef TESTING
-			else
-			{
-				printf("Earth junk or space.\n");
-			}
+	else
+	{
+		printf("Earth junk or space.\n");
+	}
 #endif
-		}
+}
 
-	}
+void Rx_logic()
+{
+	//the receive ACKs of the frames go out together, when the ACK task runs after the batch
+	drain_Rx_frames(handle_Rx_frame);
 }
 
 void pass_above_Ground()
@@ -512,13 +833,10 @@ void trxvu_logic()
 
 void Beacon_task()
 {
-	int i_error;
 	// 0. Creating variables for task, initialize variables
-	uint8_t delayBaecon = DEFULT_BEACON_DELAY;
 	portTickType last_time = xTaskGetTickCount();
 	int beacon_count = 0;
 	ISIStrxvuBitrate bitrate = trxvu_bitrate_9600;
-	voltage_t low_v_beacon;
 	while(1)
 	{
 		// 1. check if Tx on, transponder off mute Tx off, dunp is off
@@ -535,77 +853,52 @@ void Beacon_task()
 			// 4. adding last beacon to count
 			beacon_count++;
 		}
-		// 5. reading from FRAM the low vBatt in wich the beacon is once in a minute
-		i_error = FRAM_read(&delayBaecon, BEACON_TIME_ADDR, 1);
-		check_int("beacon_task, FRAM_write(BEACON_TIME_ADDR)", i_error);
-		// 6. check if value in range
-		if (!(10 <= delayBaecon || delayBaecon <= 40))
-		{
-			delayBaecon = DEFULT_BEACON_DELAY;
-		}
-
-		//reading low_v_vbat from FRAM
-		i_error = FRAM_read((byte*)&low_v_beacon, BEACON_LOW_BATTERY_STATE_ADDR, 2);
-		check_int("beacon_task, FRAM_write(BEACON_LOW_BATTERY_STATE_ADDR)", i_error);
-
-#ifdef TESTING
-		if (7400 < low_v_beacon || low_v_beacon < 7200)
-		{
-			low_v_beacon = 7250;
-		}
-#endif
-		// 7. check if low vBatt
-		portTickType delay = CONVERT_SECONDS_TO_MS(delayBaecon);//normal
-		if (low_v_beacon > get_Vbatt())
-		{
-			// low
-			delay = GET_BEACON_DELAY_LOW_VOLTAGE(delay);
-		}
-
-		vTaskDelayUntil(&last_time, delay);
+		// 5. the delay from the Vbatt trend and the pass above ground
+		vTaskDelayUntil(&last_time, Beacon_next_delay());
 	}
 }
 
 void buildAndSend_beacon(ISIStrxvuBitrate bitRate)
 {
-	// 1. Declaring variables
-	TM_spl beacon;
+	// 1. Declaring variables, the beacon is built in its frame
+	byte rawData[BEACON_LENGTH + SPL_TM_HEADER_SIZE];
+	byte *beacon_data = SPL_TM_DATA(rawData);
+	int size = 0;
 	//2. Building basic structure of a beacon packet
-	beacon.type = BEACON_T;
-	beacon.subType = BEACON_ST;
-	beacon.length = BEACON_LENGTH;
+	TM_spl_header beacon = { BEACON_T, BEACON_ST, BEACON_LENGTH, 0 };
 	Time_getUnixEpoch(&beacon.time);
+	write_TM_header(rawData, &beacon, &size);
 	//3. getting the last update of the global parameters for the beacon
 	global_param beacon_param;
 	get_current_global_param(&beacon_param);
 	//4. set raw parameters
 	// 4.1. voltages [mV] and currents [mA] EPS part
-	beacon.data[0] = beacon_param.Vbatt >> 8;
-	beacon.data[1] = beacon_param.Vbatt;
-	beacon.data[2] = beacon_param.curBat >> 8;
-	beacon.data[3] = beacon_param.curBat;
-	beacon.data[4] = beacon_param.cur3V3 >> 8;
-	beacon.data[5] = beacon_param.cur3V3;
-	beacon.data[6] = beacon_param.cur5V >> 8;
-	beacon.data[7] = beacon_param.cur5V;
+	beacon_data[0] = beacon_param.Vbatt >> 8;
+	beacon_data[1] = beacon_param.Vbatt;
+	beacon_data[2] = beacon_param.curBat >> 8;
+	beacon_data[3] = beacon_param.curBat;
+	beacon_data[4] = beacon_param.cur3V3 >> 8;
+	beacon_data[5] = beacon_param.cur3V3;
+	beacon_data[6] = beacon_param.cur5V >> 8;
+	beacon_data[7] = beacon_param.cur5V;
 	// 4.2. temperatures [degC]
 	int i,l;
 	byte *raw_param = (byte*)&beacon_param.tempComm_LO;
 	for(i = 0; i < 2; i++)
 	{
-		beacon.data[8 + i] = raw_param[1 - i];
+		beacon_data[8 + i] = raw_param[1 - i];
 	}
 	raw_param = (byte*)&beacon_param.tempComm_PA;
 	for(i = 0; i < 2; i++)
 	{
-		beacon.data[10 + i] = raw_param[1 - i];
+		beacon_data[10 + i] = raw_param[1 - i];
 	}
 	for (l = 0 ; l < 4; l++)
 	{
 		raw_param = (byte*)&beacon_param.tempEPS[l];
 		for(i = 0; i < 2; i++)
 		{
-			beacon.data[12 + l * 2 + i] = raw_param[1 - i];
+			beacon_data[12 + l * 2 + i] = raw_param[1 - i];
 		}
 	}
 	for (l = 0; l < 2; l++)
@@ -613,63 +906,57 @@ void buildAndSend_beacon(ISIStrxvuBitrate bitRate)
 		raw_param = (byte*)&beacon_param.tempBatt[l];
 		for(i = 0; i < 2; i++)
 		{
-			beacon.data[20 + l * 2 + i] = raw_param[1 - i];
+			beacon_data[20 + l * 2 + i] = raw_param[1 - i];
 		}
 	}
 	// 4.3. Rx/Tx parameters
-	beacon.data[24] = beacon_param.RxDoppler << 8;
-	beacon.data[25] = beacon_param.RxDoppler;
-	beacon.data[26] = beacon_param.RxRSSI << 8;
-	beacon.data[27] = beacon_param.RxRSSI;
-	beacon.data[28] = beacon_param.TxRefl << 8;
-	beacon.data[29] = beacon_param.TxRefl;
-	beacon.data[30] = beacon_param.TxForw << 8;
-	beacon.data[31] = beacon_param.TxForw;
+	beacon_data[24] = beacon_param.RxDoppler << 8;
+	beacon_data[25] = beacon_param.RxDoppler;
+	beacon_data[26] = beacon_param.RxRSSI << 8;
+	beacon_data[27] = beacon_param.RxRSSI;
+	beacon_data[28] = beacon_param.TxRefl << 8;
+	beacon_data[29] = beacon_param.TxRefl;
+	beacon_data[30] = beacon_param.TxForw << 8;
+	beacon_data[31] = beacon_param.TxForw;
 	// 4.4. ADCS
 	byte raw_stageTable[STAGE_TABLE_SIZE];
 	getTableTo(get_ST(), raw_stageTable);
-	beacon.data[32] = raw_stageTable[2];
-	beacon.data[33] = raw_stageTable[1];
-	beacon.data[34] = raw_stageTable[0];
-	beacon.data[35] = raw_stageTable[3];
-	beacon.data[36] = raw_stageTable[4];
-	beacon.data[37] = raw_stageTable[5];
-	beacon.data[38] = raw_stageTable[8];
-	beacon.data[39] = raw_stageTable[7];
-	beacon.data[40] = raw_stageTable[6];
+	beacon_data[32] = raw_stageTable[2];
+	beacon_data[33] = raw_stageTable[1];
+	beacon_data[34] = raw_stageTable[0];
+	beacon_data[35] = raw_stageTable[3];
+	beacon_data[36] = raw_stageTable[4];
+	beacon_data[37] = raw_stageTable[5];
+	beacon_data[38] = raw_stageTable[8];
+	beacon_data[39] = raw_stageTable[7];
+	beacon_data[40] = raw_stageTable[6];
 	for (i = 0; i < 3; i++)
 	{
 		raw_param = (byte*)&(beacon_param.Attitude[i]);
 		for (l = 0; l < 2; l++)
 		{
-			beacon.data[41 + i * 2 + l] = raw_param[l];
+			beacon_data[41 + i * 2 + l] = raw_param[l];
 		}
 	}
 	// 4.5. stats
-	beacon.data[47] = beacon_param.numOfPics;
-	beacon.data[48] = beacon_param.numOfAPRS;
-	beacon.data[49] = beacon_param.numOfDelayedCommand;
+	beacon_data[47] = beacon_param.numOfPics;
+	beacon_data[48] = beacon_param.numOfAPRS;
+	beacon_data[49] = beacon_param.numOfDelayedCommand;
 	raw_param = (byte*)&beacon_param.numOfResets;
 	for(i = 0; i < 4; i++)
 	{
-		beacon.data[50 + i] = raw_param[3 - i];
+		beacon_data[50 + i] = raw_param[3 - i];
 	}
 	raw_param = (byte*)&beacon_param.lastReset;
 	for(i = 0; i < 4; i++)
 	{
-		beacon.data[54 + i] = raw_param[3 - i];
+		beacon_data[54 + i] = raw_param[3 - i];
 	}
 	// 4.6. states
-	beacon.data[58] = beacon_param.state.raw;
-	// 5. Encoding beacon for sending
-	byte rawData[BEACON_LENGTH + SPL_TM_HEADER_SIZE];
-	int size = 0;
-	encode_TMpacket(rawData, &size, beacon);
-	//11. sending beacon
-	for (i = 0; i < 1; i++)
-	{
-		TRX_sendFrame(rawData, size, bitRate);
-	}
+	beacon_data[58] = beacon_param.state.raw;
+	//5. sending beacon
+	Tx_schedule_frame(rawData, size, bitRate, tx_priority_beacon);
+	Tx_flush_frames();
 }
 
 
@@ -685,6 +972,9 @@ void reset_FRAM_TRXVU()
 	//Delay command list
 	reset_delayCommand(TRUE);
 
+	//the reading positions of the last dump
+	reset_dump_manifest();
+
 	//BEACON_LOW_BATTERY_STATE_ADDR reset
 	voltage_t voltage = DEFULT_COMM_VOL;
 	i_error = FRAM_write((byte*)&voltage, BEACON_LOW_BATTERY_STATE_ADDR, sizeof(voltage_t));
@@ -696,77 +986,17 @@ void reset_FRAM_TRXVU()
 	data[0] = DEFULT_BEACON_DELAY;
 	i_error = FRAM_write(data, BEACON_TIME_ADDR, 1);
 	check_int("reset_FRAM_TRXVU,, FRAM_write(BEACON_TIME_ADDR)", i_error);
+	Beacon_params_changed();
 
 }
 
 
-int TRX_sendFrame(byte* data, uint8_t length, ISIStrxvuBitrate bitRate)
+int TRX_sendFrame(byte* data, uint8_t length, ISIStrxvuBitrate bitRate, tx_priority priority)
 {
-	int i_error = 0, retVal = 0;
-	portBASE_TYPE lu_error = 0;
-	if (get_system_state(mute_param) == SWITCH_ON)
-	{
-		//mute
-		return -3;
-	}
-	if (get_system_state(Tx_param) == SWITCH_OFF)
-	{
-		//tx off
-		return -4;
-	}
-	if (get_system_state(transponder_active_param) == SWITCH_ON)
-	{
-		//we in transponder mode
-		return -5;
-	}
-
-	if (xSemaphoreTake(xIsTransmitting, MAX_DELAY))
-	{
-		if (bitRate != trxvu_bitrate_9600)
-		{
-			i_error = IsisTrxvu_tcSetAx25Bitrate(0, bitRate);
-			check_int("TRX_sendFrame, IsisTrxvu_tcSetAx25Bitrate", i_error);
-		}
-
-		unsigned char avalFrames = VALUE_TX_BUFFER_FULL;
-
-		int count = 0;
-		do
-		{
-			i_error = IsisTrxvu_tcSendAX25DefClSign(0, data, length, &avalFrames);
-			check_int("TRX_sendFrame, IsisTrxvu_tcSendAX25DefClSign", i_error);
-			retVal = 0;
-			if (count % 10 == 1)
-			{
-				vTaskDelay((portTickType)(length * 20));
-				printf("Tx buffer is full\n");
-				retVal = -1;
-			}
-			count++;
-		}while(avalFrames == VALUE_TX_BUFFER_FULL);
-
-		//delay so Tx buffer will never be full
-		if (bitRate == trxvu_bitrate_1200 && retVal == 0)
-		{
-			vTaskDelay(TRANSMMIT_DELAY_1200(length));
-		}
-
-		//returns bit rate to normal (9600)
-		i_error = IsisTrxvu_tcSetAx25Bitrate(0, trxvu_bitrate_9600);
-		check_int("TRX_sendFrame, IsisTrxvu_tcSetAx25Bitrate", i_error);
-
-		// returns xIsTransmitting semaphore
-		lu_error = xSemaphoreGive(xIsTransmitting);
-		check_portBASE_TYPE("TRX_sendFrame, xSemaphoreGive", lu_error);
-		retVal = 0;
-	}
-	else
-	{
-		// can't take semaphore, big problem...
-		retVal = -2;
-	}
-
-	return retVal;
+	int retVal = Tx_schedule_frame(data, length, bitRate, priority);
+	if (retVal != 0)
+		return retVal;
+	return Tx_flush_frames();
 }
 
 int TRX_getFrameData(unsigned int *length, byte* data_out)
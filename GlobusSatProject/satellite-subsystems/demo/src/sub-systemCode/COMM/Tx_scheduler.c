@@ -0,0 +1,327 @@
+/*
+ * Tx_scheduler.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <string.h>
+
+#include "../TRXVU.h"
+#include "../Global/GlobalParam.h"
+#include "Tx_scheduler.h"
+
+#define TX_LEAD_TICKS	((portTickType)(TX_LEAD_MS / portTICK_RATE_MS))
+#define TX_BITRATE_SWITCH_TICKS	((portTickType)(TX_BITRATE_SWITCH_MS / portTICK_RATE_MS))
+
+typedef struct
+{
+	byte data[SIZE_TXFRAME];
+	uint8_t length;
+	ISIStrxvuBitrate bitrate;
+	portTickType deadline;//tick the frame should be on the air by
+} tx_entry;
+
+//a FIFO of the frames of one priority
+typedef struct
+{
+	tx_entry *entries;
+	int size;
+	int first;//index of the oldest frame
+	int count;
+	portTickType wait;//ticks a frame of the queue may wait
+} tx_queue;
+
+static tx_entry ack_entries[TX_ACK_QUEUE_SIZE];
+static tx_entry beacon_entries[TX_BEACON_QUEUE_SIZE];
+static tx_entry dump_entries[TX_DUMP_QUEUE_SIZE];
+static tx_entry APRS_entries[TX_APRS_QUEUE_SIZE];
+
+static tx_queue tx_queues[TX_NUM_OF_PRIORITIES] =
+{
+	{ ack_entries, TX_ACK_QUEUE_SIZE, 0, 0, TX_ACK_DEADLINE / portTICK_RATE_MS },
+	{ beacon_entries, TX_BEACON_QUEUE_SIZE, 0, 0, TX_BEACON_DEADLINE / portTICK_RATE_MS },
+	{ dump_entries, TX_DUMP_QUEUE_SIZE, 0, 0, TX_DUMP_DEADLINE / portTICK_RATE_MS },
+	{ APRS_entries, TX_APRS_QUEUE_SIZE, 0, 0, TX_APRS_DEADLINE / portTICK_RATE_MS }
+};
+
+static xSemaphoreHandle xTxQueueSemaphore = NULL;//mutex on the Tx queues
+static xSemaphoreHandle xTxWakeSemaphore = NULL;//wakes the Tx task for a new frame
+static Boolean tx_task_running = FALSE;
+static int tx_result = 0;//of the frames sent since the last Tx_flush_frames
+
+static ISIStrxvuBitrate tx_bitrate = trxvu_bitrate_9600;//the bitrate the transmitter is set to
+static portTickType tx_air_until = 0;//tick the frames in the transmitter buffer leave the air
+
+int init_Tx_scheduler()
+{
+	vSemaphoreCreateBinary(xTxQueueSemaphore);
+	vSemaphoreCreateBinary(xTxWakeSemaphore);
+	if (xTxQueueSemaphore == NULL || xTxWakeSemaphore == NULL)
+		return -1;
+	//the Tx task sleeps until the first frame
+	xSemaphoreTake(xTxWakeSemaphore, 0);
+	for (int i = 0; i < TX_NUM_OF_PRIORITIES; i++)
+	{
+		tx_queues[i].first = 0;
+		tx_queues[i].count = 0;
+	}
+	tx_bitrate = trxvu_bitrate_9600;
+	tx_air_until = xTaskGetTickCount();
+	return 0;
+}
+
+static int schedule_frame(byte* data, uint8_t length, ISIStrxvuBitrate bitrate, tx_priority priority, Boolean wait)
+{
+	tx_queue *queue = &tx_queues[priority];
+	if (get_system_state(mute_param) == SWITCH_ON)
+		return -3;
+	if (get_system_state(Tx_param) == SWITCH_OFF)
+		return -4;
+	if (get_system_state(transponder_active_param) == SWITCH_ON)
+		return -5;
+	if (length > SIZE_TXFRAME)
+		return -6;
+
+	while (1)
+	{
+		if (xSemaphoreTake(xTxQueueSemaphore, MAX_DELAY) != pdTRUE)
+			return -2;
+		if (queue->count < queue->size)
+			break;
+		xSemaphoreGive(xTxQueueSemaphore);
+		if (!wait)
+			return TX_QUEUE_FULL;
+		//the queue is full, waits for a frame of it to go, without the Tx task sends its frames
+		if (tx_task_running)
+			Tx_wait((portTickType)IsisTrxvu_tcEstimateTransmissionTime(0, SIZE_TXFRAME) / portTICK_RATE_MS);
+		else if (Tx_flush_frames() == -2)
+			return -2;
+	}
+
+	tx_entry *entry = &queue->entries[(queue->first + queue->count) % queue->size];
+	memcpy(entry->data, data, length);
+	entry->length = length;
+	entry->bitrate = bitrate;
+	entry->deadline = xTaskGetTickCount() + queue->wait;
+	queue->count++;
+
+	xSemaphoreGive(xTxQueueSemaphore);
+	if (tx_task_running)
+		xSemaphoreGive(xTxWakeSemaphore);
+	return 0;
+}
+
+int Tx_schedule_frame(byte* data, uint8_t length, ISIStrxvuBitrate bitrate, tx_priority priority)
+{
+	return schedule_frame(data, length, bitrate, priority, TRUE);
+}
+
+int Tx_schedule_frame_nowait(byte* data, uint8_t length, ISIStrxvuBitrate bitrate, tx_priority priority)
+{
+	return schedule_frame(data, length, bitrate, priority, FALSE);
+}
+
+//the queue with the earliest deadline at its head, -1 if every queue is empty.
+//a frame in the bitrate of the transmitter goes before it while the frame still makes its deadline
+//after it and a bitrate change, so the frames of one bitrate go together
+static int next_queue()
+{
+	int next = -1, same = -1;
+	for (int i = 0; i < TX_NUM_OF_PRIORITIES; i++)
+	{
+		if (tx_queues[i].count == 0)
+			continue;
+		portTickType deadline = tx_queues[i].entries[tx_queues[i].first].deadline;
+		if (next < 0 || (long)(deadline - tx_queues[next].entries[tx_queues[next].first].deadline) < 0)
+			next = i;
+		if (tx_queues[i].entries[tx_queues[i].first].bitrate == tx_bitrate &&
+				(same < 0 || (long)(deadline - tx_queues[same].entries[tx_queues[same].first].deadline) < 0))
+			same = i;
+	}
+	if (same < 0 || same == next)
+		return next;
+
+	portTickType start = xTaskGetTickCount();
+	if ((long)(tx_air_until - start) > 0)
+		start = tx_air_until;
+	portTickType done = start + TX_BITRATE_SWITCH_TICKS +
+			(portTickType)IsisTrxvu_tcEstimateTransmissionTime(0, tx_queues[same].entries[tx_queues[same].first].length) / portTICK_RATE_MS;
+	if ((long)(tx_queues[next].entries[tx_queues[next].first].deadline - done) >= 0)
+		return same;
+	return next;
+}
+
+static void frame_on_air(uint8_t length)
+{
+	portTickType now = xTaskGetTickCount();
+	if ((long)(tx_air_until - now) < 0)
+		tx_air_until = now;
+	tx_air_until += (portTickType)IsisTrxvu_tcEstimateTransmissionTime(0, length) / portTICK_RATE_MS;
+}
+
+int Tx_set_bitrate(ISIStrxvuBitrate bitrate)
+{
+	if (bitrate == tx_bitrate)
+		return 0;
+	//the frames in the transmitter buffer go out in the bitrate they were sent in
+	portTickType now = xTaskGetTickCount();
+	if ((long)(tx_air_until - now) > 0)
+		vTaskDelay(tx_air_until - now);
+
+	int i_error = IsisTrxvu_tcSetAx25Bitrate(0, bitrate);
+	check_int("Tx_set_bitrate, IsisTrxvu_tcSetAx25Bitrate", i_error);
+	if (i_error == 0)
+		tx_bitrate = bitrate;
+	return i_error;
+}
+
+//sends frames until 'lead' ticks of air time are in the transmitter
+static portTickType arbitrate(portTickType lead)
+{
+	portTickType wait = MAX_DELAY;
+	unsigned char avalFrames = VALUE_TX_BUFFER_FULL;
+
+	if (xSemaphoreTake(xIsTransmitting, MAX_DELAY) != pdTRUE)
+	{
+		tx_result = -2;
+		return MAX_DELAY;
+	}
+	while (1)
+	{
+		if (xSemaphoreTake(xTxQueueSemaphore, MAX_DELAY) != pdTRUE)
+		{
+			tx_result = -2;
+			break;
+		}
+		int next = next_queue();
+		xSemaphoreGive(xTxQueueSemaphore);
+		if (next < 0)
+			break;
+		//only the holder of xIsTransmitting takes frames out, the head stays while the mutex is free
+		tx_queue *queue = &tx_queues[next];
+		tx_entry *frame = &queue->entries[queue->first];
+
+		//the frames of a mute or switched off transmitter are dropped
+		if (CHECK_TRANSMIT_ABILITY)
+		{
+			long ahead = (long)(tx_air_until - xTaskGetTickCount());
+			//another bitrate after the frames of the last one left the air
+			if (frame->bitrate != tx_bitrate && ahead > 0)
+			{
+				wait = (portTickType)ahead;
+				break;
+			}
+			if (ahead > (long)lead)
+			{
+				wait = (portTickType)ahead - lead;
+				break;
+			}
+			if (Tx_set_bitrate(frame->bitrate) != 0)
+			{
+				tx_result = -1;
+			}
+			else
+			{
+				int i_error = IsisTrxvu_tcSendAX25DefClSign(0, frame->data, frame->length, &avalFrames);
+				check_int("Tx_arbitrate, IsisTrxvu_tcSendAX25DefClSign", i_error);
+				if (i_error != 0)
+				{
+					tx_result = -1;
+				}
+				else if (avalFrames == VALUE_TX_BUFFER_FULL)
+				{
+					//more frames in the transmitter than counted, tries again after a frame
+					wait = (portTickType)IsisTrxvu_tcEstimateTransmissionTime(0, frame->length) / portTICK_RATE_MS + 1;
+					break;
+				}
+				else
+				{
+					frame_on_air(frame->length);
+				}
+			}
+		}
+
+		if (xSemaphoreTake(xTxQueueSemaphore, MAX_DELAY) != pdTRUE)
+		{
+			tx_result = -2;
+			break;
+		}
+		queue->first = (queue->first + 1) % queue->size;
+		queue->count--;
+		xSemaphoreGive(xTxQueueSemaphore);
+	}
+	xSemaphoreGive(xIsTransmitting);
+	return wait;
+}
+
+portTickType Tx_arbitrate()
+{
+	//one frame ahead in the transmitter, the next frame is picked when it is about to run out
+	return arbitrate(TX_LEAD_TICKS);
+}
+
+void Tx_task()
+{
+	portTickType wait;
+	tx_task_running = TRUE;
+	while (1)
+	{
+		wait = Tx_arbitrate();
+		//a new frame wakes the task before the wait ends
+		xSemaphoreTake(xTxWakeSemaphore, wait);
+	}
+}
+
+void Tx_wait(portTickType ticks)
+{
+	if (tx_task_running)
+	{
+		xSemaphoreGive(xTxWakeSemaphore);
+	}
+	else
+	{
+		//no Tx task yet, the waiting task sends the frames
+		portTickType next = Tx_arbitrate();
+		if (next < ticks)
+			ticks = next;
+	}
+	vTaskDelay(ticks);
+}
+
+int Tx_flush_frames()
+{
+	if (tx_task_running)
+	{
+		xSemaphoreGive(xTxWakeSemaphore);
+		return 0;
+	}
+
+	//no Tx task yet, as many frames as the transmitter takes
+	tx_result = 0;
+	while (1)
+	{
+		portTickType wait = arbitrate(MAX_DELAY);
+		if (wait == MAX_DELAY)
+			break;
+		vTaskDelay(wait);
+	}
+	return tx_result;
+}
+
+void Tx_drop_frames(tx_priority priority)
+{
+	//xIsTransmitting, so the frame at the head isn't taken out while it is sent
+	if (xSemaphoreTake(xIsTransmitting, MAX_DELAY) != pdTRUE)
+		return;
+	if (xSemaphoreTake(xTxQueueSemaphore, MAX_DELAY) == pdTRUE)
+	{
+		tx_queues[priority].first = 0;
+		tx_queues[priority].count = 0;
+		xSemaphoreGive(xTxQueueSemaphore);
+	}
+	xSemaphoreGive(xIsTransmitting);
+}
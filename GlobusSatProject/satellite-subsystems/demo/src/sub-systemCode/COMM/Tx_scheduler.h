@@ -0,0 +1,117 @@
+/*
+ * Tx_scheduler.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Hoopoe3n
+ */
+
+#ifndef TX_SCHEDULER_H_
+#define TX_SCHEDULER_H_
+
+#include <satellite-subsystems/IsisTRXVU.h>
+
+#include "../Global/Global.h"
+
+//frames of every priority that wait for the transmitter
+#define TX_ACK_QUEUE_SIZE		16
+#define TX_BEACON_QUEUE_SIZE	2
+#define TX_DUMP_QUEUE_SIZE		8
+#define TX_APRS_QUEUE_SIZE		16
+
+//ms a frame of a priority may wait in its queue, the frame with the earliest deadline goes first
+#define TX_ACK_DEADLINE			1000
+#define TX_BEACON_DEADLINE		250
+#define TX_DUMP_DEADLINE		30000
+#define TX_APRS_DEADLINE		10000
+
+//ms of air time left in the transmitter when the next frame is sent, more than the I2C of a frame.
+//the transmitter holds one frame ahead, so an urgent frame waits at most one frame time
+#define TX_LEAD_MS				30
+
+//ms a bitrate change holds the next frame, the I2C of IsisTrxvu_tcSetAx25Bitrate with margin
+#define TX_BITRATE_SWITCH_MS	20
+
+#define TX_TASK_BUFFER			1024//stack of the Tx task
+
+#define TX_QUEUE_FULL			-7
+
+//the queues of the frames, most urgent first when deadlines are equal
+typedef enum
+{
+	tx_priority_ACK,
+	tx_priority_beacon,
+	tx_priority_dump,
+	tx_priority_APRS,
+	TX_NUM_OF_PRIORITIES
+} tx_priority;
+
+/**
+ * @brief		creates the semaphores of the Tx queues
+ * @note		call after xIsTransmitting is created, and after init_trxvu set the bitrate to 9600
+ * @return		0 on success, -1 if a semaphore could not be created
+ */
+int init_Tx_scheduler();
+
+/**
+ * @brief		adds a frame to the queue of its priority, waits while the queue is full
+ * @param[in]	data the frame, copied to the queue
+ * @param[in]	length of the frame
+ * @param[in]	bitrate to send the frame in
+ * @param[in]	priority of the frame
+ * @return		0 the frame is in the queue,
+ * 				-2 could not take a semaphore
+ * 				-3 mute, -4 Tx off, -5 transponder mode, -6 the frame is too long
+ */
+int Tx_schedule_frame(byte* data, uint8_t length, ISIStrxvuBitrate bitrate, tx_priority priority);
+
+/**
+ * @brief		Tx_schedule_frame that doesn't wait
+ * @return		the returns of Tx_schedule_frame, TX_QUEUE_FULL the queue of the priority is full
+ */
+int Tx_schedule_frame_nowait(byte* data, uint8_t length, ISIStrxvuBitrate bitrate, tx_priority priority);
+
+/**
+ * @brief		sends the frames in the Tx queues
+ * @note		with the Tx task running it only wakes the task. before it runs, the calling task
+ * 				sends the frames itself, as many as the transmitter takes, and returns after the
+ * 				last one went to the transmitter
+ * @return		0 on success, -1 the driver failed to send a frame, -2 could not take xIsTransmitting
+ */
+int Tx_flush_frames();
+
+/**
+ * @brief		drops the frames waiting in the queue of a priority, for a stopped dump
+ */
+void Tx_drop_frames(tx_priority priority);
+
+/**
+ * @brief		sleeps, and sends the frames in the Tx queues meanwhile if the Tx task doesn't run
+ * @param[in]	ticks to sleep
+ */
+void Tx_wait(portTickType ticks);
+
+/**
+ * @brief		sends the next frame of the Tx queues when the transmitter is about to run out of frames
+ * @note		the frame with the earliest deadline goes, the priority breaks ties. the frames in the
+ * 				bitrate of the transmitter go before it while it still makes its deadline after them and a
+ * 				bitrate change. a frame of another bitrate waits until the frames of the last bitrate
+ * 				left the air. xIsTransmitting is
+ * 				held only while a frame is sent, the frames of a mute or switched off transmitter are dropped
+ * @return		ticks until the next frame can be sent, MAX_DELAY when the queues are empty
+ */
+portTickType Tx_arbitrate();
+
+/**
+ * @brief		the task that sends every frame of the Tx queues, by Tx_arbitrate
+ */
+void Tx_task();
+
+/**
+ * @brief		sets the bitrate of the transmitter if it is set to another bitrate,
+ * 				after the frames sent in the other bitrate left the air
+ * @note		while holding xIsTransmitting
+ * @return		0 on success, the error of IsisTrxvu_tcSetAx25Bitrate otherwise
+ */
+int Tx_set_bitrate(ISIStrxvuBitrate bitrate);
+
+#endif /* TX_SCHEDULER_H_ */
@@ -39,6 +39,9 @@
 #define COMM_DUMP_ST 45
 #define ADCS_DUMP_ST 78
 #define SP_DUMP_ST	91
+#define PACKED_DUMP_ST	50//records of one of the dumps subTypes, packed in one packet
+#define FEC_DUMP_ST		51//repair frame of a window of dump frames
+#define DUMP_INDEX_ST	52//sequence numbers and CRC32 of a range of dump frames, big endian
 
 #define IMAGE_DUMP_THUMBNAIL4_ST	100
 #define IMAGE_DUMP_THUMBNAIL3_ST	101
@@ -93,6 +96,7 @@
 //generally speaking
 #define GENERIC_I2C_ST			0
 #define DUMP_ST					33
+#define DUMP_RESEND_ST			34
 #define DELETE_PACKETS_ST		35
 #define RESET_FILE_ST			45
 #define RESTSRT_FS_ST			46
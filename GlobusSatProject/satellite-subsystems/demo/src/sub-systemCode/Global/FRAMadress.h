@@ -31,12 +31,14 @@
 #define BEACON_LOW_BATTERY_STATE_ADDR 0x311D // << 2 bytes >>
 #define TRANS_LOW_BATTERY_STATE_ADDR 0x311F
 #define NUMBER_COMMAND_FRAM_ADDR  0x3121 // << 1 byte >> The number of delayed command stored in the FRAM
-#define DELAY_COMMAD_FRAM_ADDR	0x3122 //<<100 * SIZE_OF_COMMAND = 30080 bytes >> All delayed command will be stored in this address ass one big array of bytes
+#define DELAY_COMMAD_FRAM_ADDR	0x3122 //<<2 * DELAY_COMMAND_STORE_SIZE = 20200 bytes >> two halves of the log of the delayed commands
+#define DELAY_COMMAND_HALF_ADDR	0x800A//<< 1 byte >> the half of DELAY_COMMAD_FRAM_ADDR in use
 #define NUMBER_PACKET_APRS_ADDR 0x8CEE // << 1 byte >> number of APRS packets in the FRAM
 #define APRS_PACKETS_ADDR 0x8CEF// << 20 * 18 = 360 >>
 #define BEACON_BIT_RATE_ADDR 0x8E57// << 1 byte >>
 #define BEACON_TIME_ADDR 0x8E58// << 1 byte >>
 #define MUTE_TIME_ADDR		0x8E59//<<1 bytes>>
+#define DUMP_MANIFEST_ADDR	0x9100//<< DUMP_MANIFEST_HEADER_SIZE + DUMP_MANIFEST_MAX_RANGES * DUMP_RANGE_RAW_SIZE = 2836 bytes >> reading positions of the last dump
 
 //ADCS
 #define STAGE_TABLE_ADDR 0x9044
@@ -30,6 +30,8 @@
 #include <satellite-subsystems/GomEPS.h>
 
 #include "Global.h"
+#include "GlobalParam.h"
+#include "TLM_management.h"
 
 int not_first_activation;
 
@@ -103,6 +105,7 @@ int soft_reset_subsystem(subSystem_indx reset_idx)
 		check_int("soft reset, ADCS", error);
 		break;
 	case OBC:
+		c_fileFlushAll();
 		gracefulReset();
 		error = 4242432;
 		break;
@@ -121,6 +124,7 @@ int hard_reset_subsystem(subSystem_indx reset_idx)
 	switch (reset_idx)
 	{
 	case EPS:
+		c_fileFlushAll();
 		error = GomEpsHardReset(0);
 		break;
 	case TRXVU:
@@ -240,13 +244,11 @@ Boolean comapre_string(unsigned char* str0, unsigned char* str1, int numberOfByt
 void reset_FRAM_MAIN()
 {
 	byte raw[4];
-	raw[0] = 0;
-	// reset the states byte in the FRAM
-	int err = FRAM_write(raw, STATES_ADDR, 1);
-	check_int("reset_FRAM_MAIN, FRAM_write(STATES_ADDR)", err);
+	// reset the states byte in the FRAM, and its copy in the RAM
+	reset_system_state();
 	// sets the FIRST_ACTIVATION_ADDR to true (now is the first activation)
 	raw[0] = TRUE_8BIT;
-	err = FRAM_write(raw, FIRST_ACTIVATION_ADDR, 1);
+	int err = FRAM_write(raw, FIRST_ACTIVATION_ADDR, 1);
 	check_int("reset_FRAM_MAIN, FRAM_write(FIRST_ACTIVATION_ADDR)", err);
 
 	int i;
@@ -32,6 +32,7 @@
 #define ATTITUDE_CALIBRATION 	10
 
 #define current_system_state current_global_param.state
+#define SYSTEM_STATE_RAW (*(volatile byte*)&current_system_state.raw)//a byte, read and written whole
 global_param current_global_param;
 xSemaphoreHandle xCGP_semaphore = NULL;
 
@@ -103,66 +104,60 @@ int init_GP()
 
 Boolean get_system_state(systems_state_parameters param)
 {
-	int i_error;
+	//the RAM copy is the state, one byte read without the semaphore
+	systems_state state;
+	state.raw = SYSTEM_STATE_RAW;
 	Boolean return_value = SWITCH_ON;
-	if (xSemaphoreTake(xCGP_semaphore, MAX_DELAY) == pdTRUE)
-	{
-
-		i_error = FRAM_read(&(current_system_state.raw), STATES_ADDR, 1);
-		check_int("can't get system state from FRAM", i_error);
-		switch (param)
-		{
-		case mute_param:
-			if (current_system_state.fields.mute == 1)
-				return_value = SWITCH_ON;
-			else
-				return_value = SWITCH_OFF;
-			break;
-		case cam_param:
-			if (current_system_state.fields.cammera == 1)
-				return_value = SWITCH_ON;
-			else
-				return_value = SWITCH_OFF;
-			break;
-		case anttena_deploy_param:
-			if (current_system_state.fields.anttena_deploy == 1)
-				return_value = SWITCH_ON;
-			else
-				return_value = SWITCH_OFF;
-			break;
-		case transponder_active_param:
-			if (current_system_state.fields.transponder_active == 1)
-				return_value = SWITCH_ON;
-			else
-				return_value = SWITCH_OFF;
-			break;
-		case dump_param:
-			if (current_system_state.fields.dump == 1)
-				return_value = SWITCH_ON;
-			else
-				return_value = SWITCH_OFF;
-			break;
-		case cam_operational_param:
-			if (current_system_state.fields.cam_operational == 1)
-				return_value = SWITCH_ON;
-			else
-				return_value = SWITCH_OFF;
-			break;
-		case Tx_param:
-			if (current_system_state.fields.Tx == 1)
-				return_value = SWITCH_ON;
-			else
-				return_value = SWITCH_OFF;
-			break;
-		case ADCS_param:
-			if (current_system_state.fields.ADCS == 1)
-				return_value = SWITCH_ON;
-			else
-				return_value = SWITCH_OFF;
-			break;
-		}
-		portBASE_TYPE lu_check = xSemaphoreGive(xCGP_semaphore);
-		check_portBASE_TYPE("can't return xCST_semaphore in get_system_state", lu_check);
+	switch (param)
+	{
+	case mute_param:
+		if (state.fields.mute == 1)
+			return_value = SWITCH_ON;
+		else
+			return_value = SWITCH_OFF;
+		break;
+	case cam_param:
+		if (state.fields.cammera == 1)
+			return_value = SWITCH_ON;
+		else
+			return_value = SWITCH_OFF;
+		break;
+	case anttena_deploy_param:
+		if (state.fields.anttena_deploy == 1)
+			return_value = SWITCH_ON;
+		else
+			return_value = SWITCH_OFF;
+		break;
+	case transponder_active_param:
+		if (state.fields.transponder_active == 1)
+			return_value = SWITCH_ON;
+		else
+			return_value = SWITCH_OFF;
+		break;
+	case dump_param:
+		if (state.fields.dump == 1)
+			return_value = SWITCH_ON;
+		else
+			return_value = SWITCH_OFF;
+		break;
+	case cam_operational_param:
+		if (state.fields.cam_operational == 1)
+			return_value = SWITCH_ON;
+		else
+			return_value = SWITCH_OFF;
+		break;
+	case Tx_param:
+		if (state.fields.Tx == 1)
+			return_value = SWITCH_ON;
+		else
+			return_value = SWITCH_OFF;
+		break;
+	case ADCS_param:
+		if (state.fields.ADCS == 1)
+			return_value = SWITCH_ON;
+		else
+			return_value = SWITCH_OFF;
+		break;
 	}
 	return return_value;
 }
@@ -171,69 +166,90 @@ void set_system_state(systems_state_parameters param, Boolean set_state)
 {
 	int i_error;
 	portBASE_TYPE lu_error;
+	systems_state state;
+	//the semaphore keeps the changes of two tasks apart, the readers don't take it
 	if (xSemaphoreTake(xCGP_semaphore, MAX_DELAY) == pdTRUE)
 	{
-		i_error = FRAM_read(&current_system_state.raw, STATES_ADDR, 1);
-		check_int("can't read from FRAM in set_system_state", i_error);
+		state.raw = SYSTEM_STATE_RAW;
 		switch (param)
 		{
 		case mute_param:
 			if (set_state == SWITCH_ON)
-				current_system_state.fields.mute = 1;
+				state.fields.mute = 1;
 			else
-				current_system_state.fields.mute = 0;
+				state.fields.mute = 0;
 			break;
 		case cam_param:
 			if (set_state == SWITCH_ON)
-				current_system_state.fields.cammera= 1;
+				state.fields.cammera = 1;
 			else
-				current_system_state.fields.cammera = 0;
+				state.fields.cammera = 0;
 			break;
 		case anttena_deploy_param:
 			if (set_state == SWITCH_ON)
-				current_system_state.fields.anttena_deploy = 1;
+				state.fields.anttena_deploy = 1;
 			else
-				current_system_state.fields.anttena_deploy = 0;
+				state.fields.anttena_deploy = 0;
 			break;
 		case transponder_active_param:
 			if (set_state == SWITCH_ON)
-				current_system_state.fields.transponder_active = 1;
+				state.fields.transponder_active = 1;
 			else
-				current_system_state.fields.transponder_active = 0;
+				state.fields.transponder_active = 0;
 			break;
 		case dump_param:
 			if (set_state == SWITCH_ON)
-				current_system_state.fields.dump = 1;
+				state.fields.dump = 1;
 			else
-				current_system_state.fields.dump = 0;
+				state.fields.dump = 0;
 			break;
 		case cam_operational_param:
 			if (set_state == SWITCH_ON)
-				current_system_state.fields.cam_operational = 1;
+				state.fields.cam_operational = 1;
 			else
-				current_system_state.fields.cam_operational = 0;
+				state.fields.cam_operational = 0;
 			break;
 		case Tx_param:
 			if (set_state == SWITCH_ON)
-				current_system_state.fields.Tx = 1;
+				state.fields.Tx = 1;
 			else
-				current_system_state.fields.Tx = 0;
+				state.fields.Tx = 0;
 			break;
 		case ADCS_param:
 			if (set_state == SWITCH_ON)
-				current_system_state.fields.ADCS = 1;
+				state.fields.ADCS = 1;
 			else
-				current_system_state.fields.ADCS = 0;
+				state.fields.ADCS = 0;
 			break;
 		}
 
-		FRAM_write(&current_system_state.raw, STATES_ADDR, 1);
-		check_int("can't read from FRAM in set_system_state", i_error);
+		//the readers see the state before or after the change, the FRAM is written only on a change
+		if (state.raw != SYSTEM_STATE_RAW)
+		{
+			SYSTEM_STATE_RAW = state.raw;
+			i_error = FRAM_write(&state.raw, STATES_ADDR, 1);
+			check_int("can't write to FRAM in set_system_state", i_error);
+		}
 		lu_error = xSemaphoreGive(xCGP_semaphore);
 		check_portBASE_TYPE("can't return xCST_semaphore in set_system_state", lu_error);
 	}
 }
 
+void reset_system_state()
+{
+	byte raw = 0;
+	//before init_GP there's no semaphore, and no other task
+	Boolean locked = xCGP_semaphore != NULL && xSemaphoreTake(xCGP_semaphore, MAX_DELAY) == pdTRUE;
+	SYSTEM_STATE_RAW = raw;
+	int err = FRAM_write(&raw, STATES_ADDR, 1);
+	check_int("reset_system_state, FRAM_write(STATES_ADDR)", err);
+	if (locked)
+	{
+		portBASE_TYPE lu_error = xSemaphoreGive(xCGP_semaphore);
+		check_portBASE_TYPE("can't return xCGP_semaphore in reset_system_state", lu_error);
+	}
+}
+
 //global params set/get
 void get_current_global_param(global_param* param_out)
 {
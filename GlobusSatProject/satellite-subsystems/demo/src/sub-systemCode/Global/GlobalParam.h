@@ -76,8 +76,18 @@ typedef struct __attribute__ ((__packed__))
 
 int init_GP();
 
+/**
+ * @brief		the state of a sub-system, from the RAM copy of the states without a semaphore
+ */
 Boolean get_system_state(systems_state_parameters param);
+/**
+ * @brief		sets the state of a sub-system, the states are written to the FRAM if they changed
+ */
 void set_system_state(systems_state_parameters param, Boolean set_state);
+/**
+ * @brief		switches off every state, in the RAM and in the FRAM
+ */
+void reset_system_state();
 
 // get the whole global structure.
 void get_current_global_param(global_param* param_out);
@@ -6,7 +6,8 @@
  */
 
 
-#include <satellite-subsystems/GomEPS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include <hal/Timing/Time.h>
 #include <hcc/api_fat.h>
 #include <hal/errors.h>
@@ -14,35 +15,222 @@
 #include <string.h>
 #include <hcc/api_mdriver_atmel_mcipdc.h>
 #include <hal/Storage/FRAM.h>
+#include <hal/checksum.h>
 #include <at91/utility/trace.h>
 #include "TLM_management.h"
 #include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <limits.h>
 
-#define SKIP_FILE_TIME_SEC 1000000
 #define _SD_CARD 0
 #define FIRST_TIME -1
 #define FILE_NAME_WITH_INDEX_SIZE MAX_F_FILE_NAME_SIZE+sizeof(int)*2
+#define CURR_FILE_NAME_SIZE (FILE_NAME_WITH_INDEX_SIZE+FS_FILE_ENDING_SIZE+2)
+#define TEMP_FILE_NAME "temp"
+#define COPY_CHUNK_SIZE 512		// one SD sector
 
 //struct for filesystem info
 typedef struct
 {
 	int num_of_files;
+	unsigned int layout;//FS_LAYOUT of the C_FILE table written after it
 } FS;
-//TODO remove all 'PLZNORESTART' from code!!
-#define PLZNORESTART() gom_eps_hk_basic_t myEpsTelemetry_hk_basic;	(GomEpsGetHkData_basic(0, &myEpsTelemetry_hk_basic)); //todo delete
 
+//an append of a flush to a file of a c_file, kept in the FRAM until it is on the SD.
+//a reset in the middle leaves it in the FRAM and InitializeFS cuts it off the file
+typedef struct
+{
+	int file_index;
+	unsigned int offset;//length of the file before the append
+	unsigned int length;//0 when no append is in progress
+	unsigned short crc;//CRC16 of the appended bytes
+} C_FILE_APPEND;
+//time range and size of a file of a c_file
+typedef struct
+{
+	unsigned int first_time;
+	unsigned int last_time;
+	unsigned int size;//bytes on the SD, the deleted bytes at its head included
+} C_FILE_RANGE;
 //struct for chain file info
 typedef struct
 {
 	int size_of_element;
 	char name[FILE_NAME_WITH_INDEX_SIZE];
 	unsigned int creation_time;
+	unsigned char num_of_fields;//0 for raw elements, see c_fileCreateCompressed
+	unsigned char field_sizes[C_FILE_MAX_NUM_OF_FIELDS];
+	unsigned int quota;//max bytes on the SD, 0 for no quota, see c_fileSetQuota
+	unsigned char priority;//c_files with a lower priority lose their oldest files first when the SD is full
+	//the head of the chain, moved by a delete of the oldest elements
+	int head_index;//index of the oldest file of the chain
+	unsigned int head_offset;//bytes of deleted elements at the start of the oldest file
+	C_FILE_RANGE files[C_FILE_MAX_NUM_OF_FILES];//ranges of the files before the last one in a ring, see fileRange
+	//the fields a write changes, next to each other for one FRAM write per flush
+	int tail_index;//index of the last file of the chain, the elements are appended to it
+	C_FILE_RANGE tail;//range of the last file
+	C_FILE_APPEND append;
 	unsigned int last_time_modified;
-	int num_of_files;
-
+	unsigned int unflushed_elements;//elements in the RAM buffer, a reset loses them
 } C_FILE;
+//magic and size of the C_FILE record, a table of another layout is dropped by InitializeFS
+#define FS_LAYOUT_MAGIC 0x43460000
+#define FS_LAYOUT ((unsigned int)(FS_LAYOUT_MAGIC | sizeof(C_FILE)))
 #define C_FILES_BASE_ADDR (FSFRAM+sizeof(FS))
+#define C_FILE_ADDR(handle) (C_FILES_BASE_ADDR+(handle)*sizeof(C_FILE))
+#define C_FILE_FIELD_END(field) (offsetof(C_FILE,field)+sizeof(((C_FILE*)0)->field))
+#define IS_COMPRESSED(c_file) ((c_file)->num_of_fields != 0)
+//worst case of a coded element: the change of its time, the bitmap of the changed fields and 2 bytes for every byte
+#define MAX_CODED_ELEMENT_SIZE(size) (5 + C_FILE_MAX_NUM_OF_FIELDS/8 + 2*(size))
+
+//header of a block of a compressed c_file, "length" bytes of coded elements follow it
+typedef struct __attribute__ ((__packed__))
+{
+	unsigned int first_time;
+	unsigned int last_time;
+	unsigned short num_of_elements;
+	unsigned short length;
+	unsigned short crc;//CRC16 of the header and the coded elements, calculated with crc 0
+} C_FILE_BLOCK_HEADER;
 
+#define C_FILE_HASH_SIZE 32		// power of 2, at least twice MAX_NUM_OF_C_FILES
+#define C_FILE_HASH_EMPTY -1
+
+//RAM copy of the C_FILE table, loaded once on InitializeFS.
+//the FRAM table is only written for the record that changed.
+static C_FILE c_file_dir[MAX_NUM_OF_C_FILES];
+static signed char c_file_hash[C_FILE_HASH_SIZE];	// name hash -> index in c_file_dir
+static int num_of_c_files = 0;
+static xSemaphoreHandle xC_FILE_Semaphore = NULL;	// mutex on the c_file directory and the files of the c_files
+
+//RAM append buffer of a c_file, its elements go to the SD in one write
+typedef struct
+{
+	byte data[C_FILE_WRITE_BUFFER_SIZE];
+	unsigned int length;//number of bytes in data
+	unsigned int first_time;//time of the oldest element in data
+	int file_index;//index of the file of the chain the elements belong to
+	//the block a compressed c_file is coding, its elements are coded against the one before
+	unsigned int last_time;
+	unsigned int last_time_delta;
+	byte last_element[C_FILE_MAX_COMPRESSED_ELEMENT_SIZE];
+} C_FILE_BUFFER;
+static C_FILE_BUFFER c_file_buffers[MAX_NUM_OF_C_FILES];
+static time_unix flush_deadline = C_FILE_DEFAULT_FLUSH_DEADLINE;
+static byte copy_buffer[COPY_CHUNK_SIZE];//elements on their way from a file to its compacted copy
+static C_FILE_CURSOR* open_cursors[MAX_NUM_OF_C_FILE_CURSORS];
+static byte block_data[C_FILE_WRITE_BUFFER_SIZE];//coded elements of the block being read
+static byte decoded_element[C_FILE_MAX_COMPRESSED_ELEMENT_SIZE];
+static unsigned short crc_LUT[256];
+
+static unsigned int hashName(const char* name)
+{
+	unsigned int hash = 5381;
+	int i;
+	for(i = 0; i < MAX_F_FILE_NAME_SIZE && name[i] != '\0'; i++)
+	{
+		hash = ((hash << 5) + hash) + (unsigned char)name[i];
+	}
+	return hash & (C_FILE_HASH_SIZE - 1);
+}
+//open addressing with linear probing. C_FILEs are never removed, so no tombstones are needed
+static void hashInsert(int handle)
+{
+	unsigned int i = hashName(c_file_dir[handle].name);
+	while(c_file_hash[i] != C_FILE_HASH_EMPTY)
+	{
+		i = (i + 1) & (C_FILE_HASH_SIZE - 1);
+	}
+	c_file_hash[i] = handle;
+}
+static int hashLookup(const char* name)
+{
+	unsigned int i = hashName(name);
+	while(c_file_hash[i] != C_FILE_HASH_EMPTY)
+	{
+		if(strncmp(c_file_dir[(int)c_file_hash[i]].name, name, FILE_NAME_WITH_INDEX_SIZE) == 0)
+		{
+			return c_file_hash[i];
+		}
+		i = (i + 1) & (C_FILE_HASH_SIZE - 1);
+	}
+	return C_FILE_INVALID_HANDLE;
+}
+static void rebuildHash()
+{
+	int i;
+	memset(c_file_hash, C_FILE_HASH_EMPTY, sizeof(c_file_hash));
+	for(i = 0; i < num_of_c_files; i++)
+	{
+		hashInsert(i);
+	}
+}
+static Boolean isValidHandle(int handle)
+{
+	return handle >= 0 && handle < num_of_c_files;
+}
+//write a single C_FILE record back to the FRAM table
+static int saveC_FILE(int handle)
+{
+	return FRAM_write((unsigned char*)&c_file_dir[handle], C_FILE_ADDR(handle), sizeof(C_FILE));
+}
+//write only the bytes of a C_FILE record from offset "from" up to offset "to"
+static int saveC_FILE_fields(int handle, unsigned int from, unsigned int to)
+{
+	return FRAM_write((unsigned char*)&c_file_dir[handle] + from, C_FILE_ADDR(handle) + from, to - from);
+}
+//range of a file of the chain, files are numbered from 0 on
+static C_FILE_RANGE* fileRange(C_FILE* c_file, int index)
+{
+	if(index == c_file->tail_index)
+	{
+		return &c_file->tail;
+	}
+	return &c_file->files[index % C_FILE_MAX_NUM_OF_FILES];
+}
+static int saveFileRange(int handle, int index)
+{
+	C_FILE* c_file = &c_file_dir[handle];
+	unsigned int from = (byte*)fileRange(c_file, index) - (byte*)c_file;
+	return saveC_FILE_fields(handle, from, from + sizeof(C_FILE_RANGE));
+}
+//first file that can hold elements at or after "time"
+static int firstFileFrom(C_FILE* c_file, unsigned int time)
+{
+	int i = c_file->head_index;
+	while(i < c_file->tail_index && fileRange(c_file, i)->last_time < time)
+	{
+		i++;
+	}
+	return i;
+}
+//last file that can hold elements at or before "time"
+static int lastFileTo(C_FILE* c_file, unsigned int time)
+{
+	int i = c_file->tail_index;
+	while(i > c_file->head_index && fileRange(c_file, i)->first_time > time)
+	{
+		i--;
+	}
+	return i;
+}
+//take the c_files for one call of the API and register the task with the file system
+static Boolean lockC_FILES()
+{
+	if(xC_FILE_Semaphore == NULL || xSemaphoreTake(xC_FILE_Semaphore, MAX_DELAY) != pdTRUE)
+	{
+		return FALSE;
+	}
+	int error = f_enterFS();
+	check_int("lockC_FILES, f_enterFS", error);
+	return TRUE;
+}
+static void unlockC_FILES()
+{
+	f_releaseFS();
+	xSemaphoreGive(xC_FILE_Semaphore);
+}
 
 void delete_allTMFilesFromSD()
 {
@@ -63,7 +251,7 @@ void delete_allTMFilesFromSD()
 		} while (!f_findnext(&find));
 	}
 }
-// return -1 for FRAM fail
+// return -1 for FRAM fail, -2 for a C_FILE table of another layout
 static int getNumOfFilesInFS()
 {
 	FS fs;
@@ -72,6 +260,10 @@ static int getNumOfFilesInFS()
 	{
 		return -1;
 	}
+	if(fs.layout != FS_LAYOUT)
+	{
+		return -2;
+	}
 	return fs.num_of_files;
 }
 //return -1 on fail
@@ -79,12 +271,145 @@ static int setNumOfFilesInFS(int new_num_of_files)
 {
 	FS fs;
 	fs.num_of_files = new_num_of_files;
+	fs.layout = FS_LAYOUT;
 	if(FRAM_write((unsigned char*)&fs,FSFRAM,sizeof(FS))!=0)
 	{
 		return -1;
 	}
 	return 0;
 }
+//write to curr_file_name
+void get_file_name_by_index(char* c_file_name,int index,char* curr_file_name)
+{
+	sprintf(curr_file_name,"%s%d.%s", c_file_name, index, FS_FILE_ENDING);
+}
+static unsigned short calculateCRC(byte* data, unsigned int length,
+		unsigned short start_remainder, Boolean end_of_data)
+{
+	return checksum_calculateCRC16LUT(data, length, crc_LUT, start_remainder, end_of_data);
+}
+//CRC of the bytes [from_offset, to_offset) of a file, returns -1 if they could not be read
+static int fileRangeCRC(char* file_name, unsigned int from_offset, unsigned int to_offset,
+		unsigned short* crc)
+{
+	F_FILE* file = f_open(file_name, "r");
+	if(file == NULL)
+	{
+		return -1;
+	}
+	*crc = CRC16_DEFAULT_STARTREMAINDER;
+	if(f_seek(file, from_offset, F_SEEK_SET) != F_NO_ERROR)
+	{
+		f_close(file);
+		return -1;
+	}
+	while(from_offset < to_offset)
+	{
+		unsigned int size = to_offset - from_offset;
+		if(size > COPY_CHUNK_SIZE)
+		{
+			size = COPY_CHUNK_SIZE;
+		}
+		if(f_read(copy_buffer, 1, size, file) != (long)size)
+		{
+			f_close(file);
+			return -1;
+		}
+		from_offset += size;
+		*crc = calculateCRC(copy_buffer, size, *crc, from_offset == to_offset);
+	}
+	f_close(file);
+	return 0;
+}
+//cut a file back to "length", the bytes after it are a failed or torn append
+static void truncateFile(char* file_name, unsigned int length)
+{
+	F_FILE* file = f_truncate(file_name, length);
+	if(file != NULL)
+	{
+		f_close(file);
+	}
+}
+//cut the append a reset left half written off its file.
+//only the last append of a c_file can be torn, so only it is checked. returns -1 on FRAM fail
+static int recoverAppend(int handle)
+{
+	C_FILE* c_file = &c_file_dir[handle];
+	C_FILE_APPEND* append = &c_file->append;
+	char curr_file_name[CURR_FILE_NAME_SIZE];
+	unsigned int new_length = append->offset;
+	unsigned short crc;
+	if(append->length == 0)
+	{
+		return 0;
+	}
+	get_file_name_by_index(c_file->name, append->file_index, curr_file_name);
+	long length = f_filelength(curr_file_name);
+	if(length >= (long)(append->offset + append->length)
+			&& fileRangeCRC(curr_file_name, append->offset, append->offset + append->length, &crc) == 0
+			&& crc == append->crc)
+	{
+		new_length = append->offset + append->length;
+	}
+	if(length > (long)new_length)
+	{
+		printf("c_file %s cut %ld bytes of a torn write\n", c_file->name, length - (long)new_length);
+		truncateFile(curr_file_name, new_length);
+	}
+	fileRange(c_file, append->file_index)->size = new_length;
+	append->length = 0;
+	return saveC_FILE_fields(handle, offsetof(C_FILE,tail), C_FILE_FIELD_END(append));
+}
+//load the C_FILE table from the FRAM into the RAM directory in one transaction
+static FileSystemResult loadC_FILE_dir()
+{
+	int num = getNumOfFilesInFS();
+	if(num == -2)
+	{
+		//the records can't be read in this layout, the c_files start over with their files deleted
+		printf("C_FILE table of another layout, the c_files are created again\n");
+		delete_allTMFilesFromSD();
+		if(setNumOfFilesInFS(DEFAULT_NUM_OF_FILES) != 0)
+		{
+			return FS_FRAM_FAIL;
+		}
+		num = DEFAULT_NUM_OF_FILES;
+	}
+	if(num < 0)
+	{
+		return FS_FRAM_FAIL;
+	}
+	if(num > MAX_NUM_OF_C_FILES)
+	{
+		num = 0; // uninitialized table
+	}
+	if(num > 0 && FRAM_read((unsigned char*)c_file_dir, C_FILES_BASE_ADDR, num * sizeof(C_FILE)) != 0)
+	{
+		return FS_FRAM_FAIL;
+	}
+	num_of_c_files = num;
+	rebuildHash();
+	memset(c_file_buffers, 0, sizeof(c_file_buffers));
+	int i;
+	for(i = 0; i < num_of_c_files; i++)
+	{
+		if(recoverAppend(i) != 0)
+		{
+			return FS_FRAM_FAIL;
+		}
+		//the RAM buffers died with the reset, their elements are lost
+		if(c_file_dir[i].unflushed_elements != 0)
+		{
+			printf("c_file %s lost %u elements on the reset\n", c_file_dir[i].name, c_file_dir[i].unflushed_elements);
+			c_file_dir[i].unflushed_elements = 0;
+			if(saveC_FILE_fields(i, offsetof(C_FILE,unflushed_elements), C_FILE_FIELD_END(unflushed_elements)) != 0)
+			{
+				return FS_FRAM_FAIL;
+			}
+		}
+	}
+	return FS_SUCCSESS;
+}
 FileSystemResult InitializeFS(Boolean first_time)
 {
 
@@ -120,12 +445,24 @@ FileSystemResult InitializeFS(Boolean first_time)
 	if(first_time)
 	{
 		delete_allTMFilesFromSD();
-		FS fs = {0};
-		if(FRAM_write((unsigned char*)&fs,FSFRAM,sizeof(FS))!=0)
+		if(setNumOfFilesInFS(DEFAULT_NUM_OF_FILES) != 0)
 		{
 			return FS_FAT_API_FAIL;
 		}
 	}
+	if(xC_FILE_Semaphore == NULL)
+	{
+		vSemaphoreCreateBinary(xC_FILE_Semaphore);
+		if(xC_FILE_Semaphore == NULL)
+		{
+			return FS_ALLOCATION_ERROR;
+		}
+	}
+	checksum_prepareLUTCRC16(CRC16_POLYNOMIAL, crc_LUT);
+	if(loadC_FILE_dir() != FS_SUCCSESS)
+	{
+		return FS_FRAM_FAIL;
+	}
 
 	F_SPACE space;
 	/* get free space on current drive */
@@ -145,42 +482,104 @@ FileSystemResult InitializeFS(Boolean first_time)
 }
 
 //only register the chain, files will create dynamically
-FileSystemResult c_fileCreate(char* c_file_name,
-		int size_of_element)
+static FileSystemResult createC_FILE(char* c_file_name, int size_of_element,
+		const unsigned char* field_sizes, int num_of_fields)
 {
 	if(strlen(c_file_name)>MAX_F_FILE_NAME_SIZE)//check len
 	{
 		return FS_TOO_LONG_NAME;
 	}
-
-	C_FILE c_file; //chain file descriptor
-	strcpy(c_file.name,c_file_name);
-	Time_getUnixEpoch(&c_file.creation_time);//get current time
-	c_file.size_of_element =size_of_element;
-	c_file.last_time_modified = FIRST_TIME;//no written yet
-	int num_of_files_in_FS = getNumOfFilesInFS();
-	if(num_of_files_in_FS == -1)
+	if(size_of_element <= 0 || size_of_element + sizeof(unsigned int) > C_FILE_WRITE_BUFFER_SIZE)
 	{
-		return FS_FRAM_FAIL;
+		return FS_BUFFER_OVERFLOW;
 	}
-	int c_file_address =C_FILES_BASE_ADDR+num_of_files_in_FS*sizeof(C_FILE);
-	if(FRAM_write((unsigned char*)&c_file,
-			c_file_address,sizeof(C_FILE))!=0)//write c_file struct in FRAM
+	if(!lockC_FILES())
 	{
-			return FS_FRAM_FAIL;
+		return FS_LOCKED;
 	}
-	if(setNumOfFilesInFS(num_of_files_in_FS+1)!=0)//TODO change to c_fil
+	FileSystemResult result = FS_SUCCSESS;
+	int handle = hashLookup(c_file_name);
+	if(handle != C_FILE_INVALID_HANDLE)
 	{
-		return FS_FRAM_FAIL;
+		//a c_file without elements, as c_fileReset leaves it, takes the new element and fields
+		C_FILE* c_file = &c_file_dir[handle];
+		if(c_file->last_time_modified != (unsigned int)FIRST_TIME || c_file_buffers[handle].length != 0)
+		{
+			result = FS_DUPLICATED;
+		}
+		else
+		{
+			c_file->size_of_element = size_of_element;
+			c_file->num_of_fields = num_of_fields;
+			memset(c_file->field_sizes, 0, sizeof(c_file->field_sizes));
+			if(num_of_fields > 0)
+			{
+				memcpy(c_file->field_sizes, field_sizes, num_of_fields);
+			}
+			if(saveC_FILE(handle) != 0)
+			{
+				result = FS_FRAM_FAIL;
+			}
+		}
 	}
-
-	return FS_SUCCSESS;
+	else if(num_of_c_files >= MAX_NUM_OF_C_FILES)
+	{
+		result = FS_ALLOCATION_ERROR;
+	}
+	else
+	{
+		handle = num_of_c_files;
+		C_FILE* c_file = &c_file_dir[handle]; //chain file descriptor
+		memset(c_file, 0, sizeof(C_FILE));
+		strcpy(c_file->name,c_file_name);
+		Time_getUnixEpoch(&c_file->creation_time);//get current time
+		c_file->size_of_element = size_of_element;
+		c_file->last_time_modified = FIRST_TIME;//no written yet
+		c_file->num_of_fields = num_of_fields;
+		if(num_of_fields > 0)
+		{
+			memcpy(c_file->field_sizes, field_sizes, num_of_fields);
+		}
+		if(saveC_FILE(handle) != 0 || setNumOfFilesInFS(num_of_c_files + 1) != 0)
+		{
+			result = FS_FRAM_FAIL;
+		}
+		else
+		{
+			num_of_c_files++;
+			hashInsert(handle);
+		}
+	}
+	unlockC_FILES();
+	return result;
+}
+FileSystemResult c_fileCreate(char* c_file_name,
+		int size_of_element)
+{
+	return createC_FILE(c_file_name, size_of_element, NULL, 0);
+}
+FileSystemResult c_fileCreateCompressed(char* c_file_name, int size_of_element,
+		const unsigned char* field_sizes, int num_of_fields)
+{
+	int i, sum = 0;
+	if(num_of_fields <= 0 || num_of_fields > C_FILE_MAX_NUM_OF_FIELDS
+			|| size_of_element > C_FILE_MAX_COMPRESSED_ELEMENT_SIZE)
+	{
+		return FS_FAIL;
+	}
+	for(i = 0; i < num_of_fields; i++)
+	{
+		sum += field_sizes[i];
+	}
+	if(sum != size_of_element)
+	{
+		return FS_FAIL;
+	}
+	return createC_FILE(c_file_name, size_of_element, field_sizes, num_of_fields);
 }
 //write element with timestamp to file
 static void writewithEpochtime(F_FILE* file, byte* data, int size,unsigned int time)
 {
-	PLZNORESTART();
-
 	int number_of_writes;
 	number_of_writes = f_write( &time,sizeof(unsigned int),1, file );
 	number_of_writes += f_write( data, size,1, file );
@@ -192,319 +591,1454 @@ static void writewithEpochtime(F_FILE* file, byte* data, int size,unsigned int t
 	f_flush( file ); /* only after flushing can data be considered safe */
 	f_close( file ); /* data is also considered safe when file is closed */
 }
-// get C_FILE struct from FRAM by name
-static Boolean get_C_FILE_struct(char* name,C_FILE* c_file,unsigned int *address)
+//write element with timestamp to the RAM buffer
+static void bufferWithEpochtime(C_FILE_BUFFER* buf, byte* data, int size,unsigned int time)
 {
-
-	PLZNORESTART();
-
-	int i;
-	unsigned int c_file_address = 0;
-	int err_read=0;
-	int num_of_files_in_FS = getNumOfFilesInFS();
-	for(i =0; i < num_of_files_in_FS; i++)			//search correct c_file struct
-	{
-		c_file_address= C_FILES_BASE_ADDR+sizeof(C_FILE)*(i);
-		err_read = FRAM_read((unsigned char*)c_file,c_file_address,sizeof(C_FILE));
-		if(0 != err_read)
-		{
-			printf("FRAM error in 'get_C_FILE_struct()' error = %d\n",err_read);
-			return FALSE;
-		}
-
-		if(!strcmp(c_file->name,name))
-		{
-			if(address != NULL)
-			{
-				*address = c_file_address;
-			}
-			return TRUE;//stop when found
-		}
-	}
-	return FALSE;
+	memcpy(buf->data + buf->length, &time, sizeof(unsigned int));
+	memcpy(buf->data + buf->length + sizeof(unsigned int), data, size);
+	buf->length += sizeof(unsigned int) + size;
 }
-//calculate index of file in chain file by time
-static int getFileIndex(unsigned int creation_time, unsigned int current_time)
+static unsigned int zigzag(int value)
 {
-	PLZNORESTART();
-	return ((current_time-creation_time)/SKIP_FILE_TIME_SEC);
+	return ((unsigned int)value << 1) ^ (unsigned int)(value >> 31);
 }
-//write to curr_file_name
-void get_file_name_by_index(char* c_file_name,int index,char* curr_file_name)
+static int unzigzag(unsigned int value)
 {
-	PLZNORESTART();
-	sprintf(curr_file_name,"%s%d.%s", c_file_name, index, FS_FILE_ENDING);
+	return (int)(value >> 1) ^ -(int)(value & 1);
 }
-FileSystemResult c_fileReset(char* c_file_name)
+//returns the number of bytes written
+static int putVarint(byte* out, unsigned int value)
 {
-	C_FILE c_file;
-	unsigned int addr;//FRAM ADDRESS
-	//F_FILE *file;
-	char curr_file_name[MAX_F_FILE_NAME_SIZE+sizeof(int)*2];
-	PLZNORESTART();
-	unsigned int curr_time;
-	Time_getUnixEpoch(&curr_time);
-	if(get_C_FILE_struct(c_file_name,&c_file,&addr)!=TRUE)//get c_file
-	{
-		return FS_NOT_EXIST;
-	}
-	for(int i =0; i<c_file.num_of_files;i++)
+	int i = 0;
+	while(value >= 0x80)
 	{
-		get_file_name_by_index(c_file_name,i,curr_file_name);
-		f_delete(c_file_name);
+		out[i++] = (byte)(value | 0x80);
+		value >>= 7;
 	}
-	c_file.last_time_modified=-1;
-	c_file.creation_time =curr_time;
-	return FS_SUCCSESS;
+	out[i++] = (byte)value;
+	return i;
 }
-
-FileSystemResult c_fileWrite(char* c_file_name, void* element)
+//returns the number of bytes used, 0 if the varint runs past "end"
+static int getVarint(const byte* in, const byte* end, unsigned int* value)
 {
-	C_FILE c_file;
-	unsigned int addr;//FRAM ADDRESS
-	F_FILE *file;
-	char curr_file_name[MAX_F_FILE_NAME_SIZE+sizeof(int)*2];
-	PLZNORESTART();
-	unsigned int curr_time;
-	Time_getUnixEpoch(&curr_time);
-	if(get_C_FILE_struct(c_file_name,&c_file,&addr)!=TRUE)//get c_file
+	int i = 0, shift = 0;
+	*value = 0;
+	while(in + i < end && shift < 35)
 	{
-		return FS_NOT_EXIST;
+		*value |= (unsigned int)(in[i] & 0x7F) << shift;
+		if((in[i++] & 0x80) == 0)
+		{
+			return i;
+		}
+		shift += 7;
 	}
-	int index_current = getFileIndex(c_file.creation_time,curr_time);
-	get_file_name_by_index(c_file_name,index_current,curr_file_name);
-	int error = f_enterFS();
-	check_int("c_fileWrite, f_enterFS", error);
-	file = f_open(curr_file_name,"a+");
-	writewithEpochtime(file,element,c_file.size_of_element,curr_time);
-	c_file.last_time_modified= curr_time;
-	if(FRAM_write((unsigned char *)&c_file,addr,sizeof(C_FILE))!=0)//update last written
+	return 0;
+}
+//fields are little endian, wide fields are coded in parts of up to 4 bytes
+static unsigned int getFieldPart(const byte* data, int size)
+{
+	unsigned int value = 0;
+	int i;
+	for(i = size - 1; i >= 0; i--)
 	{
-		return FS_FRAM_FAIL;
+		value = (value << 8) | data[i];
 	}
-	f_close(file);
-	f_releaseFS();
-	return FS_SUCCSESS;
+	return value;
 }
-FileSystemResult fileWrite(char* file_name, void* element,int size)
+static void setFieldPart(byte* data, int size, unsigned int value)
 {
-	F_FILE *file;
-	unsigned int curr_time;
-	Time_getUnixEpoch(&curr_time);
-	file= f_open(file_name,"a+");
-	writewithEpochtime(file,element,size,curr_time);
-	f_flush(file);
-	f_close(file);
-	return FS_SUCCSESS;
+	int i;
+	for(i = 0; i < size; i++)
+	{
+		data[i] = (byte)value;
+		value >>= 8;
+	}
 }
-static FileSystemResult deleteElementsFromFile(char* file_name,unsigned long from_time,
-		unsigned long to_time,int full_element_size)
+//code the fields of "element" that differ from "prev": a bitmap of the changed fields
+//and the zig-zag varint of the change of each. returns the coded size
+static int encodeElement(C_FILE* c_file, const byte* element, const byte* prev, byte* out)
 {
-	F_FILE* file = f_open(file_name,"r");
-	F_FILE* temp_file = f_open("temp","a+");
-	char* buffer = malloc(full_element_size);
-	for(int i = 0; i<f_filelength(file_name); i++)
+	int bitmap_size = (c_file->num_of_fields + 7) / 8;
+	int length = bitmap_size, offset = 0, i, part;
+	memset(out, 0, bitmap_size);
+	for(i = 0; i < c_file->num_of_fields; i++)
 	{
-
-		f_read(buffer,1,full_element_size,file);
-		unsigned int element_time = *((unsigned int*)buffer);
-		if(element_time>=from_time&&element_time<=to_time)
+		int size = c_file->field_sizes[i];
+		if(memcmp(element + offset, prev + offset, size) != 0)
 		{
-			f_write(buffer,1,full_element_size,temp_file);
+			out[i / 8] |= 1 << (i % 8);
+			for(part = 0; part < size; part += 4)
+			{
+				int part_size = size - part < 4 ? size - part : 4;
+				int shift = 32 - 8 * part_size;
+				unsigned int delta = getFieldPart(element + offset + part, part_size)
+						- getFieldPart(prev + offset + part, part_size);
+				//sign extended, a small negative change stays small
+				length += putVarint(out + length, zigzag((int)(delta << shift) >> shift));
+			}
 		}
+		offset += size;
 	}
-	f_close(file);
-	f_close(temp_file);
-	free(buffer);
-	f_delete(file_name);
-	f_rename("temp",file_name);
-	return FS_SUCCSESS;
-
+	return length;
 }
-FileSystemResult c_fileDeleteElements(char* c_file_name, time_unix from_time,
-		time_unix to_time)
+//apply a coded element to the element before it in "element".
+//returns the coded size, 0 if the coded element runs past "end"
+static int decodeElement(C_FILE* c_file, const byte* in, const byte* end, byte* element)
 {
-	C_FILE c_file;
-	unsigned int addr;//FRAM ADDRESS
-	char curr_file_name[MAX_F_FILE_NAME_SIZE+sizeof(int)*2];
-	PLZNORESTART();
-	unsigned int curr_time;
-	Time_getUnixEpoch(&curr_time);
-	if(get_C_FILE_struct(c_file_name,&c_file,&addr)!=TRUE)//get c_file
+	int bitmap_size = (c_file->num_of_fields + 7) / 8;
+	int length = bitmap_size, offset = 0, i, part, used;
+	unsigned int value;
+	if(in + bitmap_size > end)
 	{
-		return FS_NOT_EXIST;
+		return 0;
 	}
-	int first_file_index = getFileIndex(c_file.creation_time,from_time);
-	int last_file_index = getFileIndex(c_file.creation_time,to_time);
-	if(first_file_index+1<last_file_index)//delete all files between first to kast file
+	for(i = 0; i < c_file->num_of_fields; i++)
 	{
-		for(int i =first_file_index+1; i<last_file_index;i++)
+		int size = c_file->field_sizes[i];
+		if(in[i / 8] & (1 << (i % 8)))
 		{
-			get_file_name_by_index(c_file_name,i,curr_file_name);
-			f_delete(curr_file_name);
+			for(part = 0; part < size; part += 4)
+			{
+				int part_size = size - part < 4 ? size - part : 4;
+				used = getVarint(in + length, end, &value);
+				if(used == 0)
+				{
+					return 0;
+				}
+				length += used;
+				setFieldPart(element + offset + part, part_size,
+						getFieldPart(element + offset + part, part_size) + (unsigned int)unzigzag(value));
+			}
 		}
+		offset += size;
 	}
-	get_file_name_by_index(c_file_name,first_file_index,curr_file_name);
-	deleteElementsFromFile(curr_file_name,from_time,to_time,c_file.size_of_element+sizeof(int));
-	if(first_file_index!=last_file_index)
+	return length;
+}
+//code an element into the block in the RAM buffer of a compressed c_file.
+//the first element of a block is coded against zeros and the others against the one before,
+//the time as the change of the gap between elements
+static void appendCompressed(C_FILE* c_file, C_FILE_BUFFER* buf, byte* element, unsigned int time)
+{
+	if(buf->length == 0)
 	{
-		get_file_name_by_index(c_file_name,last_file_index,curr_file_name);
-		deleteElementsFromFile(curr_file_name,from_time,to_time,c_file.size_of_element+sizeof(int));
+		buf->length = sizeof(C_FILE_BLOCK_HEADER);//filled on flush
+		buf->last_time_delta = 0;
+		memset(buf->last_element, 0, c_file->size_of_element);
 	}
-	return FS_SUCCSESS;
+	else
+	{
+		unsigned int delta = time - buf->last_time;
+		buf->length += putVarint(buf->data + buf->length, zigzag((int)(delta - buf->last_time_delta)));
+		buf->last_time_delta = delta;
+	}
+	buf->last_time = time;
+	buf->length += encodeElement(c_file, element, buf->last_element, buf->data + buf->length);
+	memcpy(buf->last_element, element, c_file->size_of_element);
 }
-FileSystemResult fileRead(char* c_file_name,byte* buffer, int size_of_buffer,
-		time_unix from_time, time_unix to_time, int* read, int element_size)
+//room an element may take in the RAM buffer
+static unsigned int bufferedElementSize(C_FILE* c_file)
 {
-	*read=0;
-	F_FILE* current_file= f_open(c_file_name,"r+");
-	int buffer_index = 0;
-	void* element;
-	unsigned int size_elementWithTimeStamp = element_size+sizeof(unsigned int);
-	element = malloc(size_elementWithTimeStamp);//store element and his timestamp
-	unsigned int length =f_filelength(c_file_name)/(size_elementWithTimeStamp);//number of elements in currnet_file
-	int err_fread=0;
-
-	f_seek( current_file, 0L , SEEK_SET );
-	for(unsigned int j=0;j < length;j++)
+	if(IS_COMPRESSED(c_file))
 	{
-		err_fread = f_read(element,(size_t)size_elementWithTimeStamp,(size_t)1,current_file);
-		(void)err_fread;
-		unsigned int element_time = *((unsigned int*)element);
-		printf("read element, time is %u\n",element_time);
-		if(element_time > to_time)
-		{
+		return MAX_CODED_ELEMENT_SIZE(c_file->size_of_element);
+	}
+	return c_file->size_of_element + sizeof(unsigned int);
+}
+int c_fileOpenHandle(char* c_file_name)
+{
+	if(!lockC_FILES())
+	{
+		return C_FILE_INVALID_HANDLE;
+	}
+	int handle = hashLookup(c_file_name);
+	unlockC_FILES();
+	return handle;
+}
+//close the files the cursors keep open on a c_file before it is changed, file_index -1 for all of them.
+//after a write a cursor opens the file again at its position, after a delete it searches by time again
+static void releaseCursorFiles(int handle, int file_index, Boolean positions_changed)
+{
+	int i;
+	for(i = 0; i < MAX_NUM_OF_C_FILE_CURSORS; i++)
+	{
+		C_FILE_CURSOR* cursor = open_cursors[i];
+		if(cursor == NULL || cursor->handle != handle || (file_index != -1 && cursor->file_index != file_index))
+		{
+			continue;
+		}
+		if(cursor->file != NULL)
+		{
+			f_close(cursor->file);
+			cursor->file = NULL;
+		}
+		if(positions_changed)
+		{
+			cursor->position = 0;
+			cursor->end = 0;
+		}
+	}
+}
+//append the RAM buffer of a c_file to its file in one write
+static FileSystemResult flushBuffer(int handle)
+{
+	C_FILE* c_file = &c_file_dir[handle];
+	C_FILE_BUFFER* buf = &c_file_buffers[handle];
+	char curr_file_name[CURR_FILE_NAME_SIZE];
+	FileSystemResult result = FS_SUCCSESS;
+	if(buf->length == 0)
+	{
+		return FS_SUCCSESS;
+	}
+	if(IS_COMPRESSED(c_file))
+	{
+		C_FILE_BLOCK_HEADER header;
+		header.first_time = buf->first_time;
+		header.last_time = buf->last_time;
+		header.num_of_elements = c_file->unflushed_elements;
+		header.length = buf->length - sizeof(C_FILE_BLOCK_HEADER);
+		header.crc = 0;
+		memcpy(buf->data, &header, sizeof(C_FILE_BLOCK_HEADER));
+		header.crc = calculateCRC(buf->data, buf->length, CRC16_DEFAULT_STARTREMAINDER, TRUE);
+		memcpy(buf->data, &header, sizeof(C_FILE_BLOCK_HEADER));
+	}
+	get_file_name_by_index(c_file->name,buf->file_index,curr_file_name);
+	releaseCursorFiles(handle, buf->file_index, FALSE);
+	//the append is recorded before it goes to the SD, InitializeFS cuts it off if a reset tears it
+	long file_length = f_filelength(curr_file_name);
+	c_file->append.file_index = buf->file_index;
+	c_file->append.offset = file_length > 0 ? file_length : 0;
+	c_file->append.length = buf->length;
+	c_file->append.crc = calculateCRC(buf->data, buf->length, CRC16_DEFAULT_STARTREMAINDER, TRUE);
+	if(saveC_FILE_fields(handle, offsetof(C_FILE,append), C_FILE_FIELD_END(append)) != 0)
+	{
+		result = FS_FRAM_FAIL;
+	}
+	F_FILE* file = f_open(curr_file_name,"a+");
+	if(file == NULL)
+	{
+		result = FS_FAT_API_FAIL;
+	}
+	else
+	{
+		if(f_write(buf->data,1,buf->length,file) != (long)buf->length)
+		{
+			result = FS_FAT_API_FAIL;
+		}
+		f_flush(file); /* only after flushing can data be considered safe */
+		f_close(file);
+		if(result == FS_FAT_API_FAIL)
+		{
+			truncateFile(curr_file_name, c_file->append.offset);
+		}
+	}
+	c_file->tail.size = c_file->append.offset;
+	if(result != FS_FAT_API_FAIL)
+	{
+		c_file->tail.size += buf->length;
+		c_file->tail.last_time = c_file->last_time_modified;
+	}
+	//a buffer that failed is dropped as well, else it would block the c_file
+	buf->length = 0;
+	c_file->unflushed_elements = 0;
+	c_file->append.length = 0;
+	if(saveC_FILE_fields(handle, offsetof(C_FILE,tail), C_FILE_FIELD_END(unflushed_elements)) != 0)
+	{
+		return FS_FRAM_FAIL;
+	}
+	return result;
+}
+FileSystemResult c_fileFlushAll()
+{
+	if(!lockC_FILES())
+	{
+		return FS_LOCKED;
+	}
+	FileSystemResult result = FS_SUCCSESS;
+	int i;
+	for(i = 0; i < num_of_c_files; i++)
+	{
+		if(flushBuffer(i) != FS_SUCCSESS)
+		{
+			result = FS_FAIL;
+		}
+	}
+	unlockC_FILES();
+	return result;
+}
+void c_fileFlushExpired()
+{
+	unsigned int curr_time;
+	int i;
+	if(!lockC_FILES())
+	{
+		return;
+	}
+	Time_getUnixEpoch(&curr_time);
+	for(i = 0; i < num_of_c_files; i++)
+	{
+		if(c_file_buffers[i].length > 0 && curr_time - c_file_buffers[i].first_time >= flush_deadline)
+		{
+			flushBuffer(i);
+		}
+	}
+	unlockC_FILES();
+}
+void c_fileSetFlushDeadline(time_unix deadline)
+{
+	flush_deadline = deadline;
+}
+FileSystemResult c_fileReset(char* c_file_name)
+{
+	char curr_file_name[CURR_FILE_NAME_SIZE];
+	if(!lockC_FILES())
+	{
+		return FS_LOCKED;
+	}
+	int handle = hashLookup(c_file_name);
+	if(handle == C_FILE_INVALID_HANDLE)
+	{
+		unlockC_FILES();
+		return FS_NOT_EXIST;
+	}
+	C_FILE* c_file = &c_file_dir[handle];
+	releaseCursorFiles(handle, -1, TRUE);
+	if(c_file->last_time_modified != (unsigned int)FIRST_TIME)
+	{
+		for(int i = c_file->head_index; i <= c_file->tail_index; i++)
+		{
+			get_file_name_by_index(c_file->name,i,curr_file_name);
+			f_delete(curr_file_name);
+		}
+	}
+	c_file->last_time_modified = FIRST_TIME;
+	c_file->unflushed_elements = 0;
+	c_file->head_index = 0;
+	c_file->head_offset = 0;
+	c_file->tail_index = 0;
+	memset(&c_file->tail, 0, sizeof(C_FILE_RANGE));
+	c_file_buffers[handle].length = 0;
+	Time_getUnixEpoch(&c_file->creation_time);
+	FileSystemResult result = saveC_FILE(handle) == 0 ? FS_SUCCSESS : FS_FRAM_FAIL;
+	unlockC_FILES();
+	return result;
+}
+//delete the oldest file of a c_file, the last file is never deleted
+static FileSystemResult deleteOldestFile(int handle)
+{
+	C_FILE* c_file = &c_file_dir[handle];
+	char curr_file_name[CURR_FILE_NAME_SIZE];
+	if(c_file->head_index >= c_file->tail_index)
+	{
+		return FS_NOT_EXIST;
+	}
+	releaseCursorFiles(handle, -1, TRUE);
+	get_file_name_by_index(c_file->name, c_file->head_index, curr_file_name);
+	f_delete(curr_file_name);
+	c_file->head_index++;
+	c_file->head_offset = 0;
+	if(saveC_FILE_fields(handle, offsetof(C_FILE,head_index), C_FILE_FIELD_END(head_offset)) != 0)
+	{
+		return FS_FRAM_FAIL;
+	}
+	return FS_SUCCSESS;
+}
+//close the last file of a c_file and start the next one, the oldest is deleted if there are too many.
+//the range of the closed file goes to the ring in the FRAM
+static FileSystemResult startNextFile(int handle, unsigned int time)
+{
+	C_FILE* c_file = &c_file_dir[handle];
+	if(c_file->tail_index - c_file->head_index + 1 >= C_FILE_MAX_NUM_OF_FILES)
+	{
+		printf("c_file %s has %d files, deleting the oldest\n", c_file->name, C_FILE_MAX_NUM_OF_FILES);
+		deleteOldestFile(handle);
+	}
+	c_file->files[c_file->tail_index % C_FILE_MAX_NUM_OF_FILES] = c_file->tail;
+	c_file->tail_index++;
+	if(saveFileRange(handle, c_file->tail_index - 1) != 0)
+	{
+		return FS_FRAM_FAIL;
+	}
+	c_file->tail.first_time = time;
+	c_file->tail.last_time = time;
+	c_file->tail.size = 0;
+	if(saveC_FILE_fields(handle, offsetof(C_FILE,tail_index), C_FILE_FIELD_END(tail)) != 0)
+	{
+		return FS_FRAM_FAIL;
+	}
+	return FS_SUCCSESS;
+}
+//add an element to the RAM buffer of a c_file, only the count of the buffered elements goes to the FRAM
+static FileSystemResult bufferElement(int handle, void* element, unsigned int time)
+{
+	C_FILE* c_file = &c_file_dir[handle];
+	C_FILE_BUFFER* buf = &c_file_buffers[handle];
+	unsigned int full_element_size = bufferedElementSize(c_file);
+	FileSystemResult result = FS_SUCCSESS;
+	//a new file is started once the last one would pass C_FILE_MAX_FILE_SIZE
+	if(c_file->tail.size + buf->length > 0
+			&& c_file->tail.size + buf->length + full_element_size > C_FILE_MAX_FILE_SIZE)
+	{
+		result = flushBuffer(handle);
+		if(startNextFile(handle, time) != FS_SUCCSESS)
+		{
+			result = FS_FRAM_FAIL;
+		}
+	}
+	if(c_file->last_time_modified == (unsigned int)FIRST_TIME)
+	{
+		c_file->tail.first_time = time;
+	}
+	if(buf->length == 0)
+	{
+		buf->file_index = c_file->tail_index;
+		buf->first_time = time;
+	}
+	if(IS_COMPRESSED(c_file))
+	{
+		appendCompressed(c_file, buf, element, time);
+	}
+	else
+	{
+		bufferWithEpochtime(buf,element,c_file->size_of_element,time);
+	}
+	c_file->last_time_modified = time;
+	c_file->unflushed_elements++;
+	//flush when the next element doesn't fit or the oldest element passed the deadline
+	if(buf->length + full_element_size > C_FILE_WRITE_BUFFER_SIZE || time - buf->first_time >= flush_deadline)
+	{
+		FileSystemResult flush_result = flushBuffer(handle);
+		return result != FS_SUCCSESS ? result : flush_result;
+	}
+	if(saveC_FILE_fields(handle, offsetof(C_FILE,unflushed_elements), C_FILE_FIELD_END(unflushed_elements)) != 0)
+	{
+		return FS_FRAM_FAIL;
+	}
+	return result;
+}
+static FileSystemResult writeElement(int handle, void* element)
+{
+	unsigned int curr_time;
+	Time_getUnixEpoch(&curr_time);
+	return bufferElement(handle, element, curr_time);
+}
+FileSystemResult c_fileWriteByHandle(int handle, void* element)
+{
+	if(!lockC_FILES())
+	{
+		return FS_LOCKED;
+	}
+	FileSystemResult result = FS_NOT_EXIST;
+	if(isValidHandle(handle))
+	{
+		result = writeElement(handle, element);
+	}
+	unlockC_FILES();
+	return result;
+}
+FileSystemResult c_fileWrite(char* c_file_name, void* element)
+{
+	if(!lockC_FILES())
+	{
+		return FS_LOCKED;
+	}
+	FileSystemResult result = FS_NOT_EXIST;
+	int handle = hashLookup(c_file_name);
+	if(handle != C_FILE_INVALID_HANDLE)
+	{
+		result = writeElement(handle, element);
+	}
+	unlockC_FILES();
+	return result;
+}
+static FileSystemResult writeElements(int handle, void* elements, unsigned int* times, int num_of_elements)
+{
+	C_FILE* c_file = &c_file_dir[handle];
+	FileSystemResult result = FS_SUCCSESS;
+	for (int i = 0; i < num_of_elements && result == FS_SUCCSESS; i++)
+	{
+		result = bufferElement(handle, (byte*)elements + i * c_file->size_of_element, times[i]);
+	}
+	return result;
+}
+FileSystemResult c_fileWriteElements(char* c_file_name, void* elements, unsigned int* times, int num_of_elements)
+{
+	if (num_of_elements <= 0)
+	{
+		return FS_SUCCSESS;
+	}
+	if(!lockC_FILES())
+	{
+		return FS_LOCKED;
+	}
+	FileSystemResult result = FS_NOT_EXIST;
+	int handle = hashLookup(c_file_name);
+	if(handle != C_FILE_INVALID_HANDLE)
+	{
+		result = writeElements(handle, elements, times, num_of_elements);
+	}
+	unlockC_FILES();
+	return result;
+}
+FileSystemResult fileWrite(char* file_name, void* element,int size)
+{
+	F_FILE *file;
+	unsigned int curr_time;
+	Time_getUnixEpoch(&curr_time);
+	file= f_open(file_name,"a+");
+	writewithEpochtime(file,element,size,curr_time);
+	f_flush(file);
+	f_close(file);
+	return FS_SUCCSESS;
+}
+//read the time of element number "index" of an open file
+static int readElementTime(F_FILE* file, unsigned int index, int full_element_size, unsigned int* time)
+{
+	if(f_seek(file, (long)index * full_element_size, F_SEEK_SET) != F_NO_ERROR)
+	{
+		return -1;
+	}
+	if(f_read(time, sizeof(unsigned int), 1, file) != 1)
+	{
+		return -1;
+	}
+	return 0;
+}
+//binary search over the elements of a file, their size is fixed and their times only increase.
+//returns the index of the first element from "low" with time >= "time", time > "time" if "after" is set
+static unsigned int findElement(F_FILE* file, unsigned int low, unsigned int high,
+		int full_element_size, unsigned int time, Boolean after)
+{
+	unsigned int mid_time;
+	while(low < high)
+	{
+		unsigned int mid = low + (high - low) / 2;
+		if(readElementTime(file, mid, full_element_size, &mid_time) != 0)
+		{
+			break;
+		}
+		if(mid_time < time || (after && mid_time == time))
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+	return low;
+}
+//open a file and find its elements in [from_time, to_time] as [*first, *last).
+//the elements in the first "head_offset" bytes are deleted and never found.
+//returns NULL if the file doesn't exist
+static F_FILE* openElementRange(char* file_name, time_unix from_time, time_unix to_time,
+		int full_element_size, unsigned int head_offset, unsigned int* first, unsigned int* last)
+{
+	long length = f_filelength(file_name);
+	if(length <= 0)
+	{
+		return NULL;
+	}
+	F_FILE* file = f_open(file_name, "r");
+	if(file == NULL)
+	{
+		return NULL;
+	}
+	unsigned int num_of_elements = length / full_element_size;
+	unsigned int head_element = head_offset / full_element_size;
+	if(head_element > num_of_elements)
+	{
+		head_element = num_of_elements;
+	}
+	*first = findElement(file, head_element, num_of_elements, full_element_size, from_time, FALSE);
+	*last = findElement(file, *first, num_of_elements, full_element_size, to_time, TRUE);
+	return file;
+}
+FileSystemResult fileRead(char* c_file_name,byte* buffer, int size_of_buffer,
+		time_unix from_time, time_unix to_time, int* read, int element_size, unsigned int head_offset)
+{
+	unsigned int first, last;
+	unsigned int size_elementWithTimeStamp = element_size+sizeof(unsigned int);
+	FileSystemResult result = FS_SUCCSESS;
+	*read=0;
+	F_FILE* current_file = openElementRange(c_file_name, from_time, to_time, size_elementWithTimeStamp, head_offset, &first, &last);
+	if(current_file == NULL)
+	{
+		return FS_NOT_EXIST;
+	}
+	unsigned int count = last - first;
+	unsigned int max_count = size_of_buffer / size_elementWithTimeStamp;
+	if(count > max_count)
+	{
+		count = max_count;
+		result = FS_BUFFER_OVERFLOW;
+	}
+	//the elements in range are next to each other, one seek and one read
+	if(count > 0 && (f_seek(current_file, (long)first * size_elementWithTimeStamp, F_SEEK_SET) != F_NO_ERROR
+			|| f_read(buffer, size_elementWithTimeStamp, count, current_file) != (long)count))
+	{
+		result = FS_FAT_API_FAIL;
+		count = 0;
+	}
+	f_close(current_file);
+	*read = count;
+	return result;
+}
+//read the elements in [from_time, to_time] of a compressed file from the block at *offset on.
+//*offset passes every block read to its end, blocks out of the range are only seeked over.
+//returns FS_BUFFER_OVERFLOW if more than max_elements are in the range, FS_FAIL on a bad block.
+//a NULL buffer only counts the elements
+static FileSystemResult readBlocks(C_FILE* c_file, F_FILE* file, unsigned int* offset,
+		unsigned int length, time_unix from_time, time_unix to_time,
+		byte* buffer, int max_elements, int* read)
+{
+	C_FILE_BLOCK_HEADER header;
+	int full_element_size = c_file->size_of_element + sizeof(unsigned int);
+	int used, i;
+	*read = 0;
+	while(*offset < length)
+	{
+		if(f_seek(file, *offset, F_SEEK_SET) != F_NO_ERROR
+				|| f_read(&header, sizeof(C_FILE_BLOCK_HEADER), 1, file) != 1)
+		{
+			return FS_FAT_API_FAIL;
+		}
+		if(header.first_time > to_time)
+		{
+			*offset = length;
 			break;
 		}
-
-		if(element_time >= from_time)
+		unsigned int next = *offset + sizeof(C_FILE_BLOCK_HEADER) + header.length;
+		if(header.last_time < from_time)
+		{
+			*offset = next;
+			continue;
+		}
+		if(buffer == NULL && header.first_time >= from_time && header.last_time <= to_time
+				&& *read + header.num_of_elements <= max_elements)
+		{
+			//a block in the range is counted by its header
+			*read += header.num_of_elements;
+			*offset = next;
+			continue;
+		}
+		if(header.length > sizeof(block_data))
+		{
+			return FS_FAIL;
+		}
+		if(f_read(block_data, 1, header.length, file) != (long)header.length)
+		{
+			return FS_FAT_API_FAIL;
+		}
+		//a bad block is never decoded
+		unsigned short block_crc = header.crc;
+		header.crc = 0;
+		unsigned short crc = calculateCRC((byte*)&header, sizeof(C_FILE_BLOCK_HEADER),
+				CRC16_DEFAULT_STARTREMAINDER, FALSE);
+		if(calculateCRC(block_data, header.length, crc, TRUE) != block_crc)
+		{
+			return FS_FAIL;
+		}
+		const byte* in = block_data;
+		const byte* end = block_data + header.length;
+		unsigned int time = header.first_time, delta = 0, value;
+		memset(decoded_element, 0, c_file->size_of_element);
+		for(i = 0; i < header.num_of_elements; i++)
+		{
+			if(i > 0)
+			{
+				used = getVarint(in, end, &value);
+				if(used == 0)
+				{
+					return FS_FAIL;
+				}
+				in += used;
+				delta += (unsigned int)unzigzag(value);
+				time += delta;
+			}
+			used = decodeElement(c_file, in, end, decoded_element);
+			if(used == 0)
+			{
+				return FS_FAIL;
+			}
+			in += used;
+			if(time < from_time)
+			{
+				continue;
+			}
+			if(time > to_time)
+			{
+				break;
+			}
+			if(*read == max_elements)
+			{
+				return FS_BUFFER_OVERFLOW;//*offset stays on this block
+			}
+			if(buffer != NULL)
+			{
+				memcpy(buffer + *read * full_element_size, &time, sizeof(unsigned int));
+				memcpy(buffer + *read * full_element_size + sizeof(unsigned int), decoded_element, c_file->size_of_element);
+			}
+			(*read)++;
+		}
+		*offset = next;
+	}
+	return FS_SUCCSESS;
+}
+//read the elements in [from_time, to_time] of one compressed file, see readBlocks
+static FileSystemResult compressedFileRead(char* file_name, C_FILE* c_file, unsigned int head_offset,
+		time_unix from_time, time_unix to_time, byte* buffer, int max_elements, int* read)
+{
+	*read = 0;
+	long length = f_filelength(file_name);
+	if(length <= (long)head_offset)
+	{
+		return FS_NOT_EXIST;
+	}
+	F_FILE* file = f_open(file_name, "r");
+	if(file == NULL)
+	{
+		return FS_NOT_EXIST;
+	}
+	FileSystemResult result = readBlocks(c_file, file, &head_offset, length, from_time, to_time,
+			buffer, max_elements, read);
+	f_close(file);
+	return result;
+}
+//clip a time range to the elements of a c_file and get the indexes of the files of the chain it covers.
+//returns FALSE if no element can be in the range
+static Boolean getReadRange(C_FILE* c_file, time_unix* from_time, time_unix* to_time,
+		int* first_index, int* last_index)
+{
+	if(c_file->last_time_modified == (unsigned int)FIRST_TIME)
+	{
+		return FALSE;
+	}
+	if(*to_time == LAST_ELEMENT_IN_C_FILE || *to_time > c_file->last_time_modified)
+	{
+		*to_time = c_file->last_time_modified;
+	}
+	if(*from_time < c_file->creation_time)
+	{
+		*from_time = c_file->creation_time;
+	}
+	if(*from_time > *to_time)
+	{
+		return FALSE;
+	}
+	//files out of the range are skipped by their ranges in the FRAM, without opening them
+	*first_index = firstFileFrom(c_file, *from_time);
+	*last_index = lastFileTo(c_file, *to_time);
+	return *first_index <= *last_index
+			&& fileRange(c_file, *first_index)->first_time <= *to_time
+			&& fileRange(c_file, *last_index)->last_time >= *from_time;
+}
+static int countElements(int handle, time_unix from_time, time_unix to_time)
+{
+	C_FILE* c_file = &c_file_dir[handle];
+	char curr_file_name[CURR_FILE_NAME_SIZE];
+	int first_index, last_index, i;
+	unsigned int first, last;
+	int num_of_elements = 0;
+	flushBuffer(handle);
+	if(!getReadRange(c_file, &from_time, &to_time, &first_index, &last_index))
+	{
+		return 0;
+	}
+	for(i = first_index; i <= last_index; i++)
+	{
+		get_file_name_by_index(c_file->name, i, curr_file_name);
+		if(IS_COMPRESSED(c_file))
+		{
+			int count;
+			compressedFileRead(curr_file_name, c_file, i == c_file->head_index ? c_file->head_offset : 0,
+					from_time, to_time, NULL, INT_MAX, &count);
+			num_of_elements += count;
+			continue;
+		}
+		F_FILE* current_file = openElementRange(curr_file_name, from_time, to_time,
+				c_file->size_of_element + sizeof(unsigned int),
+				i == c_file->head_index ? c_file->head_offset : 0, &first, &last);
+		if(current_file != NULL)
+		{
+			num_of_elements += last - first;
+			f_close(current_file);
+		}
+	}
+	return num_of_elements;
+}
+int c_fileGetNumOfElements(char* c_file_name,time_unix from_time
+		,time_unix to_time)
+{
+	if(!lockC_FILES())
+	{
+		return 0;
+	}
+	int num_of_elements = 0;
+	int handle = hashLookup(c_file_name);
+	if(handle != C_FILE_INVALID_HANDLE)
+	{
+		num_of_elements = countElements(handle, from_time, to_time);
+	}
+	unlockC_FILES();
+	return num_of_elements;
+}
+static FileSystemResult readElements(int handle,byte* buffer, int size_of_buffer,
+		time_unix from_time, time_unix to_time, int* read,time_unix* last_read_time)
+{
+	C_FILE* c_file = &c_file_dir[handle];
+	char curr_file_name[CURR_FILE_NAME_SIZE];
+	int first_index, last_index, i;
+	int buffer_index = 0;
+	unsigned int size_elementWithTimeStamp = c_file->size_of_element+sizeof(unsigned int);
+	FileSystemResult result = FS_SUCCSESS;
+	*read = 0;
+	flushBuffer(handle);
+	if(!getReadRange(c_file, &from_time, &to_time, &first_index, &last_index))
+	{
+		return FS_SUCCSESS;
+	}
+	//a file with no elements in its time is never created, it is skipped
+	for(i = first_index; i <= last_index && result == FS_SUCCSESS; i++)
+	{
+		int read_from_file = 0;
+		unsigned int head_offset = i == c_file->head_index ? c_file->head_offset : 0;
+		get_file_name_by_index(c_file->name, i, curr_file_name);
+		if(IS_COMPRESSED(c_file))
+		{
+			result = compressedFileRead(curr_file_name, c_file, head_offset, from_time, to_time, buffer + buffer_index,
+					(size_of_buffer - buffer_index) / size_elementWithTimeStamp, &read_from_file);
+		}
+		else
+		{
+			result = fileRead(curr_file_name, buffer + buffer_index, size_of_buffer - buffer_index,
+					from_time, to_time, &read_from_file, c_file->size_of_element, head_offset);
+		}
+		if(result == FS_NOT_EXIST)
+		{
+			result = FS_SUCCSESS;
+		}
+		*read += read_from_file;
+		buffer_index += read_from_file * size_elementWithTimeStamp;
+	}
+	if(*read > 0)
+	{
+		memcpy(last_read_time, buffer + buffer_index - size_elementWithTimeStamp, sizeof(unsigned int));
+	}
+	return result;
+}
+FileSystemResult c_fileRead(char* c_file_name,byte* buffer, int size_of_buffer,
+		time_unix from_time, time_unix to_time, int* read,time_unix* last_read_time)
+{
+	if(!lockC_FILES())
+	{
+		return FS_LOCKED;
+	}
+	FileSystemResult result = FS_NOT_EXIST;
+	int handle = hashLookup(c_file_name);
+	if(handle != C_FILE_INVALID_HANDLE)
+	{
+		result = readElements(handle, buffer, size_of_buffer, from_time, to_time, read, last_read_time);
+	}
+	unlockC_FILES();
+	return result;
+}
+FileSystemResult c_fileCursorOpen(char* c_file_name, time_unix from_time,
+		time_unix to_time, C_FILE_CURSOR* cursor)
+{
+	int i, slot = -1;
+	if(!lockC_FILES())
+	{
+		return FS_LOCKED;
+	}
+	int handle = hashLookup(c_file_name);
+	if(handle == C_FILE_INVALID_HANDLE)
+	{
+		unlockC_FILES();
+		return FS_NOT_EXIST;
+	}
+	for(i = 0; i < MAX_NUM_OF_C_FILE_CURSORS && slot == -1; i++)
+	{
+		if(open_cursors[i] == NULL)
+		{
+			slot = i;
+		}
+	}
+	if(slot == -1)
+	{
+		unlockC_FILES();
+		return FS_ALLOCATION_ERROR;
+	}
+	flushBuffer(handle);
+	cursor->handle = handle;
+	cursor->file = NULL;
+	cursor->position = 0;
+	cursor->end = 0;
+	if(!getReadRange(&c_file_dir[handle], &from_time, &to_time, &cursor->file_index, &cursor->last_index))
+	{
+		//an empty cursor
+		cursor->file_index = 0;
+		cursor->last_index = -1;
+	}
+	cursor->from_time = from_time;
+	cursor->to_time = to_time;
+	open_cursors[slot] = cursor;
+	unlockC_FILES();
+	return FS_SUCCSESS;
+}
+//make sure the cursor has an open file with elements left in it.
+//returns FALSE at the end of the cursor
+static Boolean cursorPrepareFile(C_FILE_CURSOR* cursor, Boolean* need_seek)
+{
+	C_FILE* c_file = &c_file_dir[cursor->handle];
+	char curr_file_name[CURR_FILE_NAME_SIZE];
+	int full_element_size = c_file->size_of_element + sizeof(unsigned int);
+	while(cursor->file == NULL && cursor->file_index <= cursor->last_index)
+	{
+		get_file_name_by_index(c_file->name, cursor->file_index, curr_file_name);
+		if(cursor->position < cursor->end)
+		{
+			//a write closed the file under the cursor, it continues where it stopped
+			cursor->file = f_open(curr_file_name, "r");
+		}
+		else if(IS_COMPRESSED(c_file))
 		{
-			if((unsigned int)buffer_index>(unsigned int)size_of_buffer)
+			//the blocks are read from the head of the file and skipped by the times in their headers
+			long length = f_filelength(curr_file_name);
+			cursor->position = cursor->file_index == c_file->head_index ? c_file->head_offset : 0;
+			cursor->end = length > 0 ? length : 0;
+			if(cursor->position < cursor->end)
 			{
-				return FS_BUFFER_OVERFLOW;
+				cursor->file = f_open(curr_file_name, "r");
 			}
-			(*read)++;
-			memcpy(buffer + buffer_index,element,size_elementWithTimeStamp);
-			buffer_index += size_elementWithTimeStamp;
+		}
+		else
+		{
+			cursor->file = openElementRange(curr_file_name, cursor->from_time, cursor->to_time, full_element_size,
+					cursor->file_index == c_file->head_index ? c_file->head_offset : 0,
+					&cursor->position, &cursor->end);
+			if(cursor->file != NULL && cursor->position == cursor->end)
+			{
+				f_close(cursor->file);
+				cursor->file = NULL;
+			}
+		}
+		*need_seek = TRUE;
+		if(cursor->file == NULL)
+		{
+			cursor->file_index++;
+			cursor->position = 0;
+			cursor->end = 0;
 		}
 	}
-	f_close(current_file);
-
-
-	free(element);
-
+	return cursor->file != NULL;
+}
+static FileSystemResult cursorNext(C_FILE_CURSOR* cursor, byte* buffer, int num_of_elements, int* read)
+{
+	C_FILE* c_file = &c_file_dir[cursor->handle];
+	int full_element_size = c_file->size_of_element + sizeof(unsigned int);
+	Boolean need_seek = FALSE;
+	while(*read < num_of_elements && cursorPrepareFile(cursor, &need_seek))
+	{
+		if(IS_COMPRESSED(c_file))
+		{
+			//a block cut by a full buffer is decoded again, from_time skips what was returned
+			int count;
+			FileSystemResult result = readBlocks(c_file, cursor->file, &cursor->position, cursor->end,
+					cursor->from_time, cursor->to_time, buffer + *read * full_element_size, num_of_elements - *read, &count);
+			if(result == FS_FAT_API_FAIL || result == FS_FAIL)
+			{
+				return result;
+			}
+			*read += count;
+		}
+		else
+		{
+			unsigned int count = cursor->end - cursor->position;
+			if(count > (unsigned int)(num_of_elements - *read))
+			{
+				count = num_of_elements - *read;
+			}
+			if(need_seek && f_seek(cursor->file, (long)cursor->position * full_element_size, F_SEEK_SET) != F_NO_ERROR)
+			{
+				return FS_FAT_API_FAIL;
+			}
+			need_seek = FALSE;
+			if(f_read(buffer + *read * full_element_size, full_element_size, count, cursor->file) != (long)count)
+			{
+				return FS_FAT_API_FAIL;
+			}
+			cursor->position += count;
+			*read += count;
+		}
+		if(cursor->position == cursor->end)
+		{
+			f_close(cursor->file);
+			cursor->file = NULL;
+			cursor->file_index++;
+			cursor->position = 0;
+			cursor->end = 0;
+		}
+	}
+	if(*read > 0)
+	{
+		//a cursor that loses its position continues by time
+		unsigned int time;
+		memcpy(&time, buffer + (*read - 1) * full_element_size, sizeof(unsigned int));
+		cursor->from_time = (time_unix)time + 1;
+	}
 	return FS_SUCCSESS;
 }
-FileSystemResult c_fileRead(char* c_file_name,byte* buffer, int size_of_buffer,
-		time_unix from_time, time_unix to_time, int* read,time_unix* last_read_time)
+FileSystemResult c_fileCursorNext(C_FILE_CURSOR* cursor, byte* buffer,
+		int num_of_elements, int* read)
 {
-	C_FILE c_file;
-	unsigned int addr;//FRAM ADDRESS
-	//F_FILE *file;
-	char curr_file_name[MAX_F_FILE_NAME_SIZE+sizeof(int)*2];
-	PLZNORESTART();
-
-	int buffer_index = 0;
-	void* element;
-	if(get_C_FILE_struct(c_file_name,&c_file,&addr)!=TRUE)//get c_file
+	*read = 0;
+	if(!lockC_FILES())
+	{
+		return FS_LOCKED;
+	}
+	FileSystemResult result = cursorNext(cursor, buffer, num_of_elements, read);
+	unlockC_FILES();
+	return result;
+}
+void c_fileCursorClose(C_FILE_CURSOR* cursor)
+{
+	int i;
+	if(!lockC_FILES())
+	{
+		return;
+	}
+	if(cursor->file != NULL)
+	{
+		f_close(cursor->file);
+		cursor->file = NULL;
+	}
+	for(i = 0; i < MAX_NUM_OF_C_FILE_CURSORS; i++)
+	{
+		if(open_cursors[i] == cursor)
+		{
+			open_cursors[i] = NULL;
+		}
+	}
+	unlockC_FILES();
+}
+//copy the bytes [from_offset, to_offset) of an open file to the end of another, a sector at a time
+static int copyFileRange(F_FILE* from_file, unsigned int from_offset, unsigned int to_offset, F_FILE* to_file)
+{
+	if(from_offset < to_offset && f_seek(from_file, from_offset, F_SEEK_SET) != F_NO_ERROR)
+	{
+		return -1;
+	}
+	while(from_offset < to_offset)
+	{
+		long length = to_offset - from_offset > COPY_CHUNK_SIZE ? COPY_CHUNK_SIZE : to_offset - from_offset;
+		if(f_read(copy_buffer, 1, length, from_file) != length
+				|| f_write(copy_buffer, 1, length, to_file) != length)
+		{
+			return -1;
+		}
+		from_offset += length;
+	}
+	return 0;
+}
+//replace a file by its bytes [from_offset, middle_offset) and [middle_offset + cut_length, end)
+static FileSystemResult cutFile(char* file_name, unsigned int from_offset, unsigned int middle_offset, unsigned int cut_length)
+{
+	unsigned int length = f_filelength(file_name);
+	F_FILE* file = f_open(file_name, "r");
+	if(file == NULL)
 	{
 		return FS_NOT_EXIST;
 	}
-	if(from_time<c_file.creation_time)
-	{
-		from_time=c_file.creation_time;
-	}
-	F_FILE* current_file;
-	int index_current = getFileIndex(c_file.creation_time,from_time);
-	get_file_name_by_index(c_file_name,index_current,curr_file_name);
-	unsigned int size_elementWithTimeStamp = c_file.size_of_element+sizeof(unsigned int);
-	element = malloc(size_elementWithTimeStamp);//store element and his timestamp
-	do
-	{
-		get_file_name_by_index(c_file_name,index_current++,curr_file_name);
-		int error = f_enterFS();
-		check_int("c_fileWrite, f_enterFS", error);
-		current_file= f_open(curr_file_name,"r");
-		if (current_file == NULL)
-			return FS_NOT_EXIST;
-		unsigned int length =f_filelength(curr_file_name)/(size_elementWithTimeStamp);//number of elements in currnet_file
-		int err_fread=0;
-		(void)err_fread;
-		f_seek( current_file, 0L , SEEK_SET );
-		for(unsigned int j=0;j < length;j++)
-		{
-			err_fread = f_read(element,(size_t)size_elementWithTimeStamp,(size_t)1,current_file);
-
-			unsigned int element_time = *((unsigned int*)element);
-			//printf("read element, time is %u\n",element_time);
-			if(element_time > to_time)
+	F_FILE* temp_file = f_open(TEMP_FILE_NAME, "w");
+	if(temp_file == NULL)
+	{
+		f_close(file);
+		return FS_FAT_API_FAIL;
+	}
+	int err = copyFileRange(file, from_offset, middle_offset, temp_file);
+	if(err == 0)
+	{
+		err = copyFileRange(file, middle_offset + cut_length, length, temp_file);
+	}
+	f_flush(temp_file);
+	f_close(temp_file);
+	f_close(file);
+	if(err != 0)
+	{
+		f_delete(TEMP_FILE_NAME);
+		return FS_FAT_API_FAIL;
+	}
+	f_delete(file_name);
+	f_rename(TEMP_FILE_NAME, file_name);
+	return FS_SUCCSESS;
+}
+//drop the elements in [from_time, to_time] of one file, from the element at "head_offset" on
+static FileSystemResult deleteElementsFromFile(char* file_name,unsigned long from_time,
+		unsigned long to_time,int full_element_size, unsigned int head_offset)
+{
+	unsigned int first, last;
+	F_FILE* file = openElementRange(file_name, from_time, to_time, full_element_size, head_offset, &first, &last);
+	if(file == NULL)
+	{
+		return FS_SUCCSESS;
+	}
+	f_close(file);
+	if(first == last && head_offset == 0)
+	{
+		return FS_SUCCSESS;
+	}
+	return cutFile(file_name, head_offset, first * full_element_size, (last - first) * full_element_size);
+}
+static Boolean fileHasElements(char* file_name, unsigned int head_offset)
+{
+	return f_filelength(file_name) > (long)head_offset;
+}
+//the elements before "from_time" are all deleted
+static Boolean isPrefix(C_FILE* c_file, time_unix from_time, int first_index)
+{
+	char curr_file_name[CURR_FILE_NAME_SIZE];
+	int full_element_size = c_file->size_of_element + sizeof(unsigned int);
+	unsigned int first, last;
+	int i;
+	for(i = c_file->head_index; i < first_index; i++)
+	{
+		get_file_name_by_index(c_file->name, i, curr_file_name);
+		if(fileHasElements(curr_file_name, i == c_file->head_index ? c_file->head_offset : 0))
+		{
+			return FALSE;
+		}
+	}
+	get_file_name_by_index(c_file->name, first_index, curr_file_name);
+	if(IS_COMPRESSED(c_file))
+	{
+		//room for no element, any element before from_time overflows
+		int count;
+		return from_time == 0 || compressedFileRead(curr_file_name, c_file,
+				first_index == c_file->head_index ? c_file->head_offset : 0,
+				0, from_time - 1, NULL, 0, &count) != FS_BUFFER_OVERFLOW;
+	}
+	F_FILE* file = openElementRange(curr_file_name, from_time, from_time, full_element_size,
+			first_index == c_file->head_index ? c_file->head_offset : 0, &first, &last);
+	if(file == NULL)
+	{
+		return TRUE;
+	}
+	f_close(file);
+	return first * full_element_size <= (first_index == c_file->head_index ? c_file->head_offset : 0);
+}
+//the offset of the first element of a file newer than "to_time".
+//a compressed file keeps every block with an element newer than "to_time".
+//returns FALSE if the file doesn't exist
+static Boolean findNewHead(C_FILE* c_file, char* file_name, unsigned int head_offset,
+		time_unix to_time, unsigned int* new_head)
+{
+	int full_element_size = c_file->size_of_element + sizeof(unsigned int);
+	unsigned int first, last;
+	F_FILE* file;
+	if(IS_COMPRESSED(c_file))
+	{
+		C_FILE_BLOCK_HEADER header;
+		long length = f_filelength(file_name);
+		file = length > 0 ? f_open(file_name, "r") : NULL;
+		if(file == NULL)
+		{
+			return FALSE;
+		}
+		*new_head = head_offset;
+		while(*new_head < (unsigned int)length)
+		{
+			if(f_seek(file, *new_head, F_SEEK_SET) != F_NO_ERROR
+					|| f_read(&header, sizeof(C_FILE_BLOCK_HEADER), 1, file) != 1
+					|| header.last_time > to_time)
 			{
 				break;
 			}
-
-			if(element_time >= from_time)
+			*new_head += sizeof(C_FILE_BLOCK_HEADER) + header.length;
+		}
+		f_close(file);
+		return TRUE;
+	}
+	file = openElementRange(file_name, to_time, to_time, full_element_size, head_offset, &first, &last);
+	if(file == NULL)
+	{
+		return FALSE;
+	}
+	f_close(file);
+	*new_head = last * full_element_size;
+	return TRUE;
+}
+//delete the elements up to "to_time" by moving the head of the chain, whole files are deleted.
+//the head file is compacted only when its deleted bytes pass C_FILE_COMPACT_THRESHOLD
+static FileSystemResult deletePrefix(int handle, time_unix to_time, int last_index)
+{
+	C_FILE* c_file = &c_file_dir[handle];
+	char curr_file_name[CURR_FILE_NAME_SIZE];
+	unsigned int new_head;
+	FileSystemResult result = FS_SUCCSESS;
+	int i;
+	for(i = c_file->head_index; i < last_index; i++)
+	{
+		get_file_name_by_index(c_file->name, i, curr_file_name);
+		f_delete(curr_file_name);
+	}
+	if(c_file->head_index != last_index)
+	{
+		c_file->head_index = last_index;
+		c_file->head_offset = 0;
+	}
+	get_file_name_by_index(c_file->name, last_index, curr_file_name);
+	long length = f_filelength(curr_file_name);
+	if(findNewHead(c_file, curr_file_name, c_file->head_offset, to_time, &new_head))
+	{
+		c_file->head_offset = new_head;
+		//the last file of the chain stays the head, the next write creates it again
+		if((long)c_file->head_offset >= length)
+		{
+			f_delete(curr_file_name);
+			c_file->head_offset = 0;
+			fileRange(c_file, last_index)->size = 0;
+		}
+		else if(c_file->head_offset >= C_FILE_COMPACT_THRESHOLD)
+		{
+			result = cutFile(curr_file_name, c_file->head_offset, c_file->head_offset, 0);
+			if(result == FS_SUCCSESS)
 			{
-				*last_read_time = element_time;
-				if((unsigned int)buffer_index>(unsigned int)size_of_buffer)
-				{
-					free(element);
-					return FS_BUFFER_OVERFLOW;
-				}
-				(*read)++;
-				memcpy(buffer + buffer_index,element,size_elementWithTimeStamp);
-				buffer_index += size_elementWithTimeStamp;
+				fileRange(c_file, last_index)->size -= c_file->head_offset;
+				c_file->head_offset = 0;
 			}
 		}
-		f_close(current_file);
-		f_releaseFS();
-	}while(getFileIndex(c_file.creation_time,c_file.last_time_modified)>=index_current);
-
-
-	free(element);
-
-	return FS_SUCCSESS;
+	}
+	if(saveC_FILE_fields(handle, offsetof(C_FILE,head_index), C_FILE_FIELD_END(head_offset)) != 0
+			|| saveFileRange(handle, last_index) != 0)
+	{
+		return FS_FRAM_FAIL;
+	}
+	return result;
 }
-void print_file(char* c_file_name)
+static FileSystemResult deleteElements(int handle, time_unix from_time,
+		time_unix to_time)
 {
-	C_FILE c_file;
-	F_FILE* current_file;
-	int i = 0;
-	void* element;
-	char curr_file_name[FILE_NAME_WITH_INDEX_SIZE];//store current file's name
-	//int temp[2];//use to append name with index
-	//temp[1] = '\0';
-	if(get_C_FILE_struct(c_file_name,&c_file,NULL)!=TRUE)
+	C_FILE* c_file = &c_file_dir[handle];
+	char curr_file_name[CURR_FILE_NAME_SIZE];
+	int full_element_size = c_file->size_of_element + sizeof(unsigned int);
+	int first_index, last_index, i;
+	FileSystemResult result = FS_SUCCSESS;
+	flushBuffer(handle);
+	releaseCursorFiles(handle, -1, TRUE);
+	if(!getReadRange(c_file, &from_time, &to_time, &first_index, &last_index))
 	{
-		printf("print_file_error\n");
+		return FS_SUCCSESS;
+	}
+	//deleting the oldest elements is the common case, it only moves the head
+	if(isPrefix(c_file, from_time, first_index))
+	{
+		return deletePrefix(handle, to_time, last_index);
+	}
+	//the elements of a block depend on the ones before them, only whole blocks can be deleted
+	if(IS_COMPRESSED(c_file))
+	{
+		return FS_FAIL;
+	}
+	for(i = first_index; i <= last_index && result == FS_SUCCSESS; i++)
+	{
+		C_FILE_RANGE* range = fileRange(c_file, i);
+		get_file_name_by_index(c_file->name, i, curr_file_name);
+		if(from_time <= range->first_time && range->last_time <= to_time)
+		{
+			f_delete(curr_file_name);//all the elements of the file are in the range
+			range->size = 0;
+		}
+		else
+		{
+			result = deleteElementsFromFile(curr_file_name, from_time, to_time, full_element_size,
+					i == c_file->head_index ? c_file->head_offset : 0);
+			long length = f_filelength(curr_file_name);
+			range->size = length > 0 ? length : 0;
+		}
+		if(saveFileRange(handle, i) != 0)
+		{
+			return FS_FRAM_FAIL;
+		}
+		if(result == FS_SUCCSESS && i == c_file->head_index && c_file->head_offset != 0)
+		{
+			c_file->head_offset = 0;
+			if(saveC_FILE_fields(handle, offsetof(C_FILE,head_index), C_FILE_FIELD_END(head_offset)) != 0)
+			{
+				return FS_FRAM_FAIL;
+			}
+		}
+	}
+	return result;
+}
+FileSystemResult c_fileDeleteElements(char* c_file_name, time_unix from_time,
+		time_unix to_time)
+{
+	if(!lockC_FILES())
+	{
+		return FS_LOCKED;
+	}
+	FileSystemResult result = FS_NOT_EXIST;
+	int handle = hashLookup(c_file_name);
+	if(handle != C_FILE_INVALID_HANDLE)
+	{
+		result = deleteElements(handle, from_time, to_time);
+	}
+	unlockC_FILES();
+	return result;
+}
+//bytes a c_file takes on the SD
+static unsigned int getC_FILE_size(C_FILE* c_file)
+{
+	unsigned int size = 0;
+	int i;
+	for(i = c_file->head_index; i <= c_file->tail_index; i++)
+	{
+		size += fileRange(c_file, i)->size;
+	}
+	return size;
+}
+FileSystemResult c_fileSetQuota(char* c_file_name, unsigned int quota, unsigned char priority)
+{
+	if(!lockC_FILES())
+	{
+		return FS_LOCKED;
+	}
+	FileSystemResult result = FS_NOT_EXIST;
+	int handle = hashLookup(c_file_name);
+	if(handle != C_FILE_INVALID_HANDLE)
+	{
+		c_file_dir[handle].quota = quota;
+		c_file_dir[handle].priority = priority;
+		result = saveC_FILE_fields(handle, offsetof(C_FILE,quota), C_FILE_FIELD_END(priority)) == 0 ? FS_SUCCSESS : FS_FRAM_FAIL;
+	}
+	unlockC_FILES();
+	return result;
+}
+unsigned int c_fileGetSize(char* c_file_name)
+{
+	if(!lockC_FILES())
+	{
+		return 0;
+	}
+	unsigned int size = 0;
+	int handle = hashLookup(c_file_name);
+	if(handle != C_FILE_INVALID_HANDLE)
+	{
+		size = getC_FILE_size(&c_file_dir[handle]) + c_file_buffers[handle].length;
+	}
+	unlockC_FILES();
+	return size;
+}
+//the c_file to delete a file of when the SD is full: the lowest priority, then the oldest elements.
+//c_files with a single file are left alone
+static int getEvictionCandidate()
+{
+	int i, candidate = C_FILE_INVALID_HANDLE;
+	for(i = 0; i < num_of_c_files; i++)
+	{
+		C_FILE* c_file = &c_file_dir[i];
+		if(c_file->head_index >= c_file->tail_index)
+		{
+			continue;
+		}
+		if(candidate == C_FILE_INVALID_HANDLE
+				|| c_file->priority < c_file_dir[candidate].priority
+				|| (c_file->priority == c_file_dir[candidate].priority
+						&& fileRange(c_file, c_file->head_index)->first_time
+						< fileRange(&c_file_dir[candidate], c_file_dir[candidate].head_index)->first_time))
+		{
+			candidate = i;
+		}
+	}
+	return candidate;
+}
+void c_fileRetention()
+{
+	static time_unix last_space_check = 0;
+	time_unix curr_time;
+	F_SPACE space;
+	int i;
+	if(!lockC_FILES())
+	{
+		return;
+	}
+	//one file per c_file per call, a big eviction is spread over many calls
+	for(i = 0; i < num_of_c_files; i++)
+	{
+		C_FILE* c_file = &c_file_dir[i];
+		if(c_file->quota != 0 && getC_FILE_size(c_file) > c_file->quota)
+		{
+			deleteOldestFile(i);
+		}
 	}
-	PLZNORESTART();
-	element = malloc(c_file.size_of_element+sizeof(unsigned int));//store element and his timestamp
-	for(i=0;i<c_file.num_of_files;i++)
+	//the FAT counts the free clusters of the whole SD, so the free space is checked rarely
+	Time_getUnixEpoch(&curr_time);
+	if(curr_time - last_space_check >= C_FILE_SPACE_CHECK_PERIOD
+			&& f_getfreespace(f_getdrive(), &space) == F_NO_ERROR)
 	{
-		printf("file %d:\n",i);//print file index
-		get_file_name_by_index(c_file_name,i,curr_file_name);
-		current_file=f_open(curr_file_name,"r");
-		for(int j=0;j<f_filelength(curr_file_name)/((int)c_file.size_of_element+(int)sizeof(unsigned int));j++)
+		last_space_check = curr_time;
+		if(space.free_high == 0 && space.free < C_FILE_MIN_FREE_SPACE)
 		{
-			f_read(element,c_file.size_of_element,(size_t)c_file.size_of_element+sizeof(unsigned int),current_file);
-			printf("time: %d\n data:",*((int*)element));//print element timestamp
-			for(j =0;j<c_file.size_of_element;j++)
+			int handle = getEvictionCandidate();
+			if(handle != C_FILE_INVALID_HANDLE)
 			{
-				printf("%d ",*((byte*)(element+sizeof(int)+j)));//print data
+				printf("SD is full, deleting the oldest file of c_file %s\n", c_file_dir[handle].name);
+				deleteOldestFile(handle);
+				last_space_check = 0;//check again on the next call
 			}
-			printf("\n");
 		}
-		f_close(current_file);
 	}
+	unlockC_FILES();
+}
+void print_file(char* c_file_name)
+{
+	C_FILE_CURSOR cursor;
+	int file_index = -1;
+	int read = 0;
+	int size_of_element;
+	byte* element;
+	int handle = c_fileOpenHandle(c_file_name);
+	if(handle == C_FILE_INVALID_HANDLE)
+	{
+		printf("print_file_error\n");
+		return;
+	}
+	size_of_element = c_file_dir[handle].size_of_element;
+	element = malloc(size_of_element + sizeof(unsigned int));//store element and his timestamp
+	//the cursor reads the files from head_index to tail_index, a compressed c_file decoded
+	if(element == NULL
+			|| c_fileCursorOpen(c_file_name, FIRST_ELEMENT_IN_C_FILE, LAST_ELEMENT_IN_C_FILE, &cursor) != FS_SUCCSESS)
+	{
+		printf("print_file_error\n");
+		free(element);
+		return;
+	}
+	while(c_fileCursorNext(&cursor, element, 1, &read) == FS_SUCCSESS && read == 1)
+	{
+		//the cursor moves to the next file after the last element of a file
+		if((cursor.file != NULL ? cursor.file_index : cursor.file_index - 1) != file_index)
+		{
+			file_index = cursor.file != NULL ? cursor.file_index : cursor.file_index - 1;
+			printf("file %d:\n", file_index);//print file index
+		}
+		printf("time: %u\n data:", *((unsigned int*)element));//print element timestamp
+		for(int j = 0; j < size_of_element; j++)
+		{
+			printf("%d ", element[sizeof(unsigned int) + j]);//print data
+		}
+		printf("\n");
+	}
+	c_fileCursorClose(&cursor);
+	free(element);
 }
 
 void DeInitializeFS( void )
 {
 	printf("deinitializig file system \n");
+	c_fileFlushAll();
 	int err = f_delvolume( _SD_CARD ); /* delete the volID */
 
 	printf("1\n");
-	PLZNORESTART();
 	if(err != 0)
 	{
 		printf("f_delvolume err %d\n", err);
@@ -9,6 +9,7 @@
 #define TM_MANAGMENT_H_
 
 #include <hal/Boolean.h>
+#include <hcc/api_fat.h>
 #include "../Global/Global.h"
 
 #define MAX_F_FILE_NAME_SIZE 7
@@ -16,6 +17,20 @@
 #define LAST_ELEMENT_IN_C_FILE 0
 #define DEFAULT_NUM_OF_FILES 0
 
+#define MAX_NUM_OF_C_FILES 16		// number of c_files the FRAM table can hold
+#define C_FILE_INVALID_HANDLE -1
+
+#define C_FILE_WRITE_BUFFER_SIZE 512		// RAM append buffer of every c_file, one SD sector
+#define C_FILE_DEFAULT_FLUSH_DEADLINE 60	// seconds an element may wait in the RAM buffer
+#define C_FILE_COMPACT_THRESHOLD (64*1024)	// deleted bytes at the head of a file before it is compacted
+#define MAX_NUM_OF_C_FILE_CURSORS 4		// cursors that can be open at the same time
+#define C_FILE_MAX_FILE_SIZE (1024*1024)	// a c_file starts a new file once its last one would pass this size
+#define C_FILE_MAX_NUM_OF_FILES 32		// files of a c_file, the oldest is deleted to start one more
+#define C_FILE_MIN_FREE_SPACE (8*1024*1024)	// c_fileRetention deletes files while the SD has less free bytes
+#define C_FILE_SPACE_CHECK_PERIOD 60		// seconds between free space checks of c_fileRetention
+#define C_FILE_MAX_NUM_OF_FIELDS 32		// fields of an element of a compressed c_file
+#define C_FILE_MAX_COMPRESSED_ELEMENT_SIZE 128	// bytes of an element of a compressed c_file
+
 #define FS_FILE_ENDING	"TLM"
 #define FS_FILE_ENDING_SIZE	3
 
@@ -37,6 +52,19 @@ typedef enum
 	FS_FAIL
 } FileSystemResult;
 
+//read position of a c_file, see c_fileCursorOpen
+typedef struct
+{
+	int handle;
+	time_unix from_time;//time to continue from if the position is lost
+	time_unix to_time;
+	int file_index;//index of the file being read
+	int last_index;//index of the last file in range
+	F_FILE* file;//the open file, NULL between files
+	unsigned int position;//next element in the file
+	unsigned int end;//element after the last one in range in the file
+} C_FILE_CURSOR;
+
 /*
  *
  */
@@ -44,6 +72,12 @@ void delete_allTMFilesFromSD();
 /*!
  * Initializes the file system.
  * @note call once for boot and after DeInitializeFS.
+ * @note the C_FILE table is read from the FRAM once, to a RAM directory hashed by name.
+ * the FRAM is written only for the C_FILE that changed.
+ * @note every flush records its append in the FRAM with a CRC16 before it goes to the SD.
+ * an append a reset tore is cut off its file here, by a check of that append only.
+ * @note a C_FILE table of another layout, left by other software, is dropped and the files
+ * of the c_files are deleted.
  * @return FS_FAIL if Initializing the FS failed,
  * FS_ALLOCATION_ERROR on malloc error,
  * FS_SUCCSESS on success.
@@ -60,14 +94,40 @@ void DeInitializeFS();
  * @param c_file_name the name of the c_file.
  * @param size_of_element size of the structure.
  * DEFAULT_NUM_OF_FILES for default(recommended).
+ * @note a c_file of that name without elements, after c_fileReset, takes the new size of
+ * element and becomes uncompressed, its quota stays.
  * @return FS_TOO_LONG_NAME if c_file_name size is bigger then MAX_F_FILE_NAME_SIZE,
+ * FS_BUFFER_OVERFLOW if an element with its time doesn't fit in C_FILE_WRITE_BUFFER_SIZE,
+ * FS_DUPLICATED if a c_file of that name has elements,
  * FS_FRAM_FAIL,
  * FS_SUCCSESS on success.
  */
 FileSystemResult c_fileCreate(char* c_file_name,
 		int size_of_element);
+/*!
+ * Create new c_file whose elements are compressed in the SD.
+ * @note every flush of the RAM buffer is a block. the first element of a block is kept whole,
+ * every other element as the fields that changed since the element before it, the change of a field as
+ * a zig-zag varint. the time of an element is kept as the change of the gap between the elements.
+ * @note only the oldest elements of a compressed c_file can be deleted, whole blocks at a time.
+ * @param c_file_name the name of the c_file.
+ * @param size_of_element size of the structure, up to C_FILE_MAX_COMPRESSED_ELEMENT_SIZE.
+ * @param field_sizes size of every field of the structure, little endian, in the order of the structure.
+ * @param num_of_fields number of fields, up to C_FILE_MAX_NUM_OF_FIELDS.
+ * @note a c_file of that name without elements takes the new size of element and fields.
+ * @return FS_FAIL if the fields don't add up to size_of_element,
+ * as c_fileCreate otherwise.
+ */
+FileSystemResult c_fileCreateCompressed(char* c_file_name, int size_of_element,
+		const unsigned char* field_sizes, int num_of_fields);
 /*!
  * Write element to c_file.
+ * @note the element goes to the RAM buffer of the c_file, the buffer is written to the SD when it is full,
+ * when its oldest element is older then the flush deadline, or by c_fileFlushAll.
+ * the FRAM keeps the number of buffered elements, a reset loses at most the flush deadline of elements.
+ * @note elements go to files of up to C_FILE_MAX_FILE_SIZE bytes. the FRAM keeps the first and last time
+ * of every file, reads open only the files of their range. a c_file keeps at most C_FILE_MAX_NUM_OF_FILES
+ * files and deletes the oldest to start a new one.
  * @param c_file_name the name of the c_file.
  * @param element the structure of the telemetry/data.
  * @return FS_NOT_EXIST if c_file not exist,
@@ -76,13 +136,102 @@ FileSystemResult c_fileCreate(char* c_file_name,
  */
 FileSystemResult c_fileWrite(char* c_file_name, void* element);
 
+/*!
+ * Get a handle to an existing c_file, to skip the name lookup on every write.
+ * @param c_file_name the name of the c_file.
+ * @return index of the c_file in the c_file table,
+ * C_FILE_INVALID_HANDLE if c_file not exist.
+ * @note handles stay valid until the FRAM table is reset on the first activation.
+ */
+int c_fileOpenHandle(char* c_file_name);
+
+/*!
+ * Write element to c_file using a handle from c_fileOpenHandle.
+ * @param handle the c_file handle.
+ * @param element the structure of the telemetry/data.
+ * @return FS_NOT_EXIST if handle is invalid,
+ * FS_LOCKED if the c_files could not be taken,
+ * FS_FAT_API_FAIL if the file could not be opened,
+ * FS_FRAM_FAIL,
+ * FS_SUCCSESS on success.
+ */
+FileSystemResult c_fileWriteByHandle(int handle, void* element);
+
+/*!
+ * Write elements to c_file through its RAM buffer.
+ * @param c_file_name the name of the c_file.
+ * @param elements num_of_elements structures of the telemetry/data, one after the other.
+ * @param times the time of every element, in the order of the elements.
+ * @param num_of_elements number of elements to write.
+ * @return FS_NOT_EXIST if c_file not exist,
+ * FS_FAT_API_FAIL if a flush of the RAM buffer failed, the elements of the buffer are dropped,
+ * FS_FRAM_FAIL,
+ * FS_SUCCSESS on success.
+ */
+FileSystemResult c_fileWriteElements(char* c_file_name, void* elements, unsigned int* times, int num_of_elements);
+
+/*!
+ * Write the RAM buffers of all c_files to the SD.
+ * @note call before a reset of the OBC.
+ * @return FS_LOCKED if the c_files could not be taken,
+ * FS_FAIL if a buffer could not be written,
+ * FS_SUCCSESS on success.
+ */
+FileSystemResult c_fileFlushAll();
+
+/*!
+ * Write the RAM buffers whose oldest element is older then the flush deadline.
+ * @note call periodically, a c_file that isn't written to is flushed only by this.
+ */
+void c_fileFlushExpired();
+
+/*!
+ * Set the flush deadline of the RAM buffers.
+ * @param deadline seconds an element may wait in a RAM buffer, 0 writes every element.
+ */
+void c_fileSetFlushDeadline(time_unix deadline);
+
+/*!
+ * Set the SD quota of a c_file.
+ * @param c_file_name the name of the c_file.
+ * @param quota max bytes of the c_file on the SD, 0 for no quota.
+ * @param priority c_files with a lower priority lose their oldest files first when the SD is full.
+ * @return FS_NOT_EXIST if c_file not exist,
+ * FS_LOCKED if the c_files could not be taken,
+ * FS_FRAM_FAIL,
+ * FS_SUCCSESS on success.
+ */
+FileSystemResult c_fileSetQuota(char* c_file_name, unsigned int quota, unsigned char priority);
+
+/*!
+ * Get the number of bytes a c_file takes on the SD and in its RAM buffer.
+ * @param c_file_name the name of the c_file.
+ * @note the sizes of the files are kept in the FRAM table, the SD is not read.
+ * @return size in bytes, 0 if c_file not exist.
+ */
+unsigned int c_fileGetSize(char* c_file_name);
+
+/*!
+ * Delete the oldest files of the c_files that are over their quota, and of the lowest
+ * priority c_file while the SD has less than C_FILE_MIN_FREE_SPACE free bytes.
+ * @note call periodically. every call deletes at most one file per c_file and one more for the
+ * free space, which is checked once in C_FILE_SPACE_CHECK_PERIOD. the last file of a c_file is never deleted.
+ */
+void c_fileRetention();
+
 /*!
  * Delete elements from c_file from "from_time" to "to_time".
+ * @note deleting the oldest elements only moves the head of the c_file in the FRAM and deletes the files
+ * it passed, the head file is compacted once C_FILE_COMPACT_THRESHOLD bytes of it are deleted.
+ * a range with elements before it is cut out of its files by copying them.
  * @param c_file_name the name of the c_file.
  * @param from_time time of first element, FIRST_ELEMENT_IN_C_FILE to first element.
  * @param to_time time of last element, LAST_ELEMENT_IN_C_FILE to last element.
  * @return FS_NOT_EXIST if c_file not exist,
  * FS_LOCKED if c_file used by other thread,
+ * FS_FAT_API_FAIL if a file could not be copied,
+ * FS_FAIL if the c_file is compressed and the range has elements before it,
+ * FS_FRAM_FAIL,
  * FS_SUCCSESS on success.
  */
 FileSystemResult c_fileDeleteElements(char* c_file_name, time_unix from_time,
@@ -92,6 +241,7 @@ FileSystemResult c_fileDeleteElements(char* c_file_name, time_unix from_time,
  * @param c_file_name the name of the c_file.
  * @param from_time time of first element, FIRST_ELEMENT_IN_C_FILE to first element.
  * @param to_time time of last element, LAST_ELEMENT_IN_C_FILE to last element.
+ * @note costs two binary searches per file, no element is read.
  * @return num of elements.
  */
 int c_fileGetNumOfElements(char* c_file_name,time_unix from_time
@@ -104,13 +254,56 @@ int c_fileGetNumOfElements(char* c_file_name,time_unix from_time
  * @param read[out] number of elements read.
  * @param from_time time of first element, FIRST_ELEMENT_IN_C_FILE to first element.
  * @param to_time time of last element, LAST_ELEMENT_IN_C_FILE to last element.
- * @return FS_BUFFER_OVERFLOW if size_of_buffer too small,
+ * @param last_read_time[out] time of the last element read, if any.
+ * @note the elements in range are found by a binary search over the times in every file,
+ * then read in one f_read per file.
+ * @return FS_BUFFER_OVERFLOW if size_of_buffer too small, the buffer holds the first elements that fit,
  * @return FS_NOT_EXIST if c_file not exist,
+ * FS_FAT_API_FAIL if a file could not be read,
+ * FS_FAIL if a block of a compressed c_file fails its CRC,
  * FS_SUCCSESS on success.
  */
 FileSystemResult c_fileRead(char* c_file_name, byte* buffer, int size_of_buffer,
 		time_unix from_time, time_unix to_time, int* read,time_unix* last_read_time);
 
+/*!
+ * Open a cursor over the elements of a c_file from "from_time" to "to_time".
+ * @param c_file_name the name of the c_file.
+ * @param from_time time of first element, FIRST_ELEMENT_IN_C_FILE to first element.
+ * @param to_time time of last element, LAST_ELEMENT_IN_C_FILE to last element.
+ * @param cursor[out] the cursor, owned by the caller until c_fileCursorClose.
+ * @note the range is fixed on open, elements written later are not returned.
+ * @return FS_NOT_EXIST if c_file not exist,
+ * FS_LOCKED if the c_files could not be taken,
+ * FS_ALLOCATION_ERROR if MAX_NUM_OF_C_FILE_CURSORS cursors are already open,
+ * FS_SUCCSESS on success.
+ */
+FileSystemResult c_fileCursorOpen(char* c_file_name, time_unix from_time,
+		time_unix to_time, C_FILE_CURSOR* cursor);
+
+/*!
+ * Read the next elements of a cursor to buffer.
+ * @note every element is copied with its 4 byte timestamp before it.
+ * @note the cursor keeps its file open between calls, every element is read once
+ * and a small buffer costs no extra searches.
+ * @param cursor an open cursor.
+ * @param buffer room for num_of_elements elements with their timestamps.
+ * @param num_of_elements max number of elements to read.
+ * @param read[out] number of elements read, less than num_of_elements at the end of the range.
+ * @return FS_FAT_API_FAIL,
+ * FS_FAIL if a block of a compressed c_file fails its CRC,
+ * FS_LOCKED if the c_files could not be taken,
+ * FS_SUCCSESS on success.
+ */
+FileSystemResult c_fileCursorNext(C_FILE_CURSOR* cursor, byte* buffer,
+		int num_of_elements, int* read);
+
+/*!
+ * Close a cursor and the file it keeps open.
+ * @param cursor an open cursor.
+ */
+void c_fileCursorClose(C_FILE_CURSOR* cursor);
+
 //print c_file for testing
 void print_file(char* c_file_name);
 FileSystemResult c_fileReset(char* c_file_name);
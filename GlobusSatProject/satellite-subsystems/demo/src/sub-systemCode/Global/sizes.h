@@ -58,7 +58,7 @@
 #define IMAGE_PACKET_SIZE				IMAGE_DATA_FIELD_PACKET_SIZE + SPL_TM_HEADER_SIZE
 
 #define STACK_DUMP_SIZE 2048//when you create the dump task, size of stack, //need to be tasted...
-#define DUMP_BUFFER_SIZE  40000
+#define DUMP_WINDOW_SIZE  1024//records of the dumped file read at a time, the cursor keeps the place between them
 
 #define EPS_VOLTAGES_SIZE_RAW (EPS_VOLTAGES_SIZE * 2) //!< Size of EPS_VOLTAGES_ADDR
 
@@ -13,6 +13,7 @@
 #include "COMM_CMD.h"
 #include "../../TRXVU.h"
 #include "../../COMM/APRS.h"
+#include "../../COMM/Beacon_scheduler.h"
 
 
 #define create_task(pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask) xTaskCreate( (pvTaskCode) , (pcName) , (usStackDepth) , (pvParameters), (uxPriority), (pxCreatedTask) ); vTaskDelay(10);
@@ -22,18 +23,18 @@ void cmd_error(Ack_type* type, ERR_type* err)
 	*type = ACK_NOTHING;
 	*err = ERR_FAIL;
 }
-void cmd_mute(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_mute(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	//1. send ACK before mutes satellite
 	*type = ACK_MUTE;
 	*err = ERR_ACTIVE;
-	if (cmd.length != 2)
+	if (cmd->length != 2)
 	{
 		*err = ERR_PARAMETERS;
 		return;
 	}
 	//2. mute satellite
-	unsigned short param = 	BigEnE_raw_to_uShort(cmd.data);
+	unsigned short param = 	BigEnE_raw_to_uShort(cmd->data);
 
 	int error = set_mute_time(param);
 	if (error == 666)
@@ -54,10 +55,10 @@ void cmd_unmute(Ack_type* type, ERR_type* err)
 	unmute_Tx();
 	*err = ERR_SUCCESS;
 }
-void cmd_active_trans(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_active_trans(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_TRANSPONDER;
-	if (cmd.length != 1)
+	if (cmd->length != 1)
 	{
 		*err = ERR_PARAMETERS;
 		return;
@@ -65,9 +66,9 @@ void cmd_active_trans(Ack_type* type, ERR_type* err, TC_spl cmd)
 	//1. checks if the transponder is active
 	byte raw[1 + 4];
 	// 2.1. convert command id to raw
-	BigEnE_uInt_to_raw(cmd.id, &raw[0]);
+	BigEnE_uInt_to_raw(cmd->id, &raw[0]);
 	// 2.2. copying data to raw
-	raw[4] = cmd.data[0];
+	raw[4] = cmd->data[0];
 	// 3. activate transponder
 	create_task(Transponder_task, (const signed char * const)"Transponder_Task", 1024, &raw, (unsigned portBASE_TYPE)(configMAX_PRIORITIES - 2), xTransponderHandle);
 	//no ACK
@@ -79,17 +80,17 @@ void cmd_shut_trans(Ack_type* type, ERR_type* err)
 	sendRequestToStop_transponder();
 	*err = ERR_TURNED_OFF;
 }
-void cmd_change_trans_rssi(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_change_trans_rssi(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_UPDATE_TRANS_RSSI;
-	if (cmd.length != 2)
+	if (cmd->length != 2)
 	{
 		*err = ERR_PARAMETERS;
 		return;
 	}
 
-	unsigned short param = cmd.data[1];
-	param += cmd.data[0] << 8;
+	unsigned short param = cmd->data[1];
+	param += cmd->data[0] << 8;
 	if (param > MAX_TRANS_RSSI)
 	{
 		*err = ERR_PARAMETERS;
@@ -97,7 +98,7 @@ void cmd_change_trans_rssi(Ack_type* type, ERR_type* err, TC_spl cmd)
 	}
 
 	*err = ERR_SUCCESS;
-	change_trans_RSSI(cmd.data);
+	change_trans_RSSI(cmd->data);
 }
 void cmd_aprs_dump(Ack_type* type, ERR_type* err)
 {
@@ -119,26 +120,27 @@ void cmd_stop_dump(Ack_type* type, ERR_type* err)
 	sendRequestToStop_dump();
 	*err = ERR_TURNED_OFF;
 }
-void cmd_time_frequency(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_time_frequency(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_UPDATE_BEACON_TIME_DELAY;
-	if (cmd.length != 1)
+	if (cmd->length != 1)
 	{
 		*err = ERR_PARAMETERS;
 		return;
 	}
 	//1. check if parameter in range
-	if (cmd.data[0] < MIN_TIME_DELAY_BEACON || cmd.data[0] > MAX_TIME_DELAY_BEACON)
+	if (cmd->data[0] < MIN_TIME_DELAY_BEACON || cmd->data[0] > MAX_TIME_DELAY_BEACON)
 	{
 		*err = ERR_PARAMETERS;
 	}
 	//2. update time in FRAM
-	else if (!FRAM_writeAndVerify(&cmd.data[0], BEACON_TIME_ADDR, 1))
+	else if (!FRAM_writeAndVerify(&cmd->data[0], BEACON_TIME_ADDR, 1))
 	{
 		*err = ERR_FRAM_WRITE_FAIL;
 	}
 	else
 	{
+		Beacon_params_changed();
 		*err = ERR_SUCCESS;
 	}
 }
@@ -9,11 +9,12 @@
 #include <hal/Storage/FRAM.h>
 
 #include "EPS_CMD.h"
+#include "../../COMM/Beacon_scheduler.h"
 
-void cmd_upload_volt_logic(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_upload_volt_logic(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_UPDATE_EPS_VOLTAGES;
-	if (cmd.length != 8 * 2)
+	if (cmd->length != 8 * 2)
 	{
 		*err = ERR_PARAMETERS;
 		return;
@@ -24,11 +25,11 @@ void cmd_upload_volt_logic(Ack_type* type, ERR_type* err, TC_spl cmd)
 	voltage_t comm_vol[2];
 	for(int i = 0; i < 6; i++)
 	{
-		eps_logic[i] = BigEnE_raw_to_uShort(cmd.data + i*2);
+		eps_logic[i] = BigEnE_raw_to_uShort(cmd->data + i*2);
 	}
 	for(int i = 0; i < 2; i++)
 	{
-		comm_vol[i] = BigEnE_raw_to_uShort(cmd.data + i*2 + 12);
+		comm_vol[i] = BigEnE_raw_to_uShort(cmd->data + i*2 + 12);
 	}
 
 	// check logic
@@ -82,6 +83,7 @@ void cmd_upload_volt_logic(Ack_type* type, ERR_type* err, TC_spl cmd)
 
 	FRAM_err = FRAM_writeAndVerify((byte*)comm_vol, BEACON_LOW_BATTERY_STATE_ADDR, 2);
 	check_int("cmd_upload_volt_logic, FRAM_writeAndVerify(BEACON_LOW_BATTERY_STATE_ADDR)", FRAM_err);
+	Beacon_params_changed();
 	if (FRAM_err)
 	{
 		reset_EPS_voltages();
@@ -103,10 +105,10 @@ void cmd_upload_volt_logic(Ack_type* type, ERR_type* err, TC_spl cmd)
 
 	*err = ERR_SUCCESS;
 }
-void cmd_upload_volt_COMM(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_upload_volt_COMM(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_UPDATE_COMM_VOLTAGES;
-	if (cmd.length != 2 * 2)
+	if (cmd->length != 2 * 2)
 	{
 		*err = ERR_PARAMETERS;
 		return;
@@ -116,7 +118,7 @@ void cmd_upload_volt_COMM(Ack_type* type, ERR_type* err, TC_spl cmd)
 
 	for (int i = 0; i < 2; i++)
 	{
-		comm_vol[i] = BigEnE_raw_to_uShort(cmd.data + i*2);
+		comm_vol[i] = BigEnE_raw_to_uShort(cmd->data + i*2);
 	}
 
 	int i_error = FRAM_read((byte*)eps_logic, EPS_VOLTAGES_ADDR, 12);
@@ -132,23 +134,24 @@ void cmd_upload_volt_COMM(Ack_type* type, ERR_type* err, TC_spl cmd)
 
 	i_error = FRAM_write((byte*)comm_vol, BEACON_LOW_BATTERY_STATE_ADDR, 2);
 	check_int("cmd_upload_volt_COMM, FRAM_write(BEACON_LOW_BATTERY_STATE_ADDR)", i_error);
+	Beacon_params_changed();
 	voltage_t volll = comm_vol[1];
 	i_error = FRAM_write((byte*)&volll, TRANS_LOW_BATTERY_STATE_ADDR, 2);
 	check_int("cmd_upload_volt_COMM, FRAM_write(BEACON_LOW_BATTERY_STATE_ADDR)", i_error);
 }
-void cmd_heater_temp(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_heater_temp(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	// 1. define type for later ACK
 	*type = ACK_UPDATE_EPS_HEATER_VALUES;
-	if (cmd.length != 2)
+	if (cmd->length != 2)
 	{
 		*err = ERR_PARAMETERS;
 		return;
 	}
 	// 2. sets values in eps_config_t
     eps_config_t config_data;
-    config_data.fields.battheater_low = cmd.data[0];
-    config_data.fields.battheater_high = cmd.data[1];
+    config_data.fields.battheater_low = cmd->data[0];
+    config_data.fields.battheater_high = cmd->data[1];
     // 3. sets the new values in the EPS beef(controller)
     int error = GomEpsConfigSet(I2C_BUS_ADDR, &config_data);
     // 4. check for errors
@@ -165,10 +168,10 @@ void cmd_heater_temp(Ack_type* type, ERR_type* err, TC_spl cmd)
 			break;
 	}
 }
-void cmd_SHUT_CAM(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_SHUT_CAM(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_EPS_SHUT_SYSTEM;
-	if (cmd.length != 0)
+	if (cmd->length != 0)
 	{
 		*err = ERR_PARAMETERS;
 		return;
@@ -176,10 +179,10 @@ void cmd_SHUT_CAM(Ack_type* type, ERR_type* err, TC_spl cmd)
 	*err = ERR_SUCCESS;
 	shut_CAM(SWITCH_ON);
 }
-void cmd_SHUT_ADCS(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_SHUT_ADCS(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_EPS_SHUT_SYSTEM;
-	if (cmd.length != 0)
+	if (cmd->length != 0)
 	{
 		*err = ERR_PARAMETERS;
 		return;
@@ -187,10 +190,10 @@ void cmd_SHUT_ADCS(Ack_type* type, ERR_type* err, TC_spl cmd)
 	*err = ERR_SUCCESS;
 	shut_ADCS(SWITCH_ON);
 }
-void cmd_allow_CAM(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_allow_CAM(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_EPS_SHUT_SYSTEM;
-	if (cmd.length != 0)
+	if (cmd->length != 0)
 	{
 		*err = ERR_PARAMETERS;
 		return;
@@ -198,10 +201,10 @@ void cmd_allow_CAM(Ack_type* type, ERR_type* err, TC_spl cmd)
 	*err = ERR_SUCCESS;
 	shut_CAM(SWITCH_OFF);
 }
-void cmd_allow_ADCS(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_allow_ADCS(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_EPS_SHUT_SYSTEM;
-	if (cmd.length != 0)
+	if (cmd->length != 0)
 	{
 		*err = ERR_PARAMETERS;
 		return;
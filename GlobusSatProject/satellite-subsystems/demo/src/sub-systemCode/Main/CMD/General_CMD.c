@@ -15,15 +15,16 @@
 #include "../../Global/TLM_management.h"
 #include "../../Main/HouseKeeping.h"
 #include "../../TRXVU.h"
+#include "../../COMM/Dump_manifest.h"
 #include "../../Ants.h"
 
 #define create_task(pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask) xTaskCreate( (pvTaskCode) , (pcName) , (usStackDepth) , (pvParameters), (uxPriority), (pxCreatedTask) ); vTaskDelay(10);
 
-void cmd_generic_I2C(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_generic_I2C(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_GENERIC_I2C_CMD;
 
-	int error = I2C_write((unsigned int)cmd.data[0], &cmd.data[2] ,cmd.data[1]);
+	int error = I2C_write((unsigned int)cmd->data[0], &cmd->data[2] ,cmd->data[1]);
 
 	if (error == 0)
 		*err = ERR_SUCCESS;
@@ -32,35 +33,52 @@ void cmd_generic_I2C(Ack_type* type, ERR_type* err, TC_spl cmd)
 	if (error > 4)
 		*err = ERR_FAIL;
 }
-void cmd_dump(TC_spl cmd)
+void cmd_dump(TC_spl* cmd)
 {
-	if (cmd.length != 2 * TIME_SIZE + 5 + 1)
+	//the bytes after the dump parameters are optional,
+	//not 0 to pack the records, and the repair frames of every window of frames
+	if (cmd->length < 2 * TIME_SIZE + 5 + 1 || cmd->length > 2 * TIME_SIZE + 5 + 1 + 2)
 	{
 		return;
 	}
 	//1. build combine data with command_id
-	unsigned char raw[2 * TIME_SIZE + 5 + 4 + 1] = {0};
+	unsigned char raw[2 * TIME_SIZE + 5 + 4 + 1 + 2] = {0};
 	// 1.1. copying command id
-	BigEnE_uInt_to_raw(cmd.id, &raw[0]);
+	BigEnE_uInt_to_raw(cmd->id, &raw[0]);
 	// 1.2. copying command data
-	memcpy(raw + 4, cmd.data, 2 * TIME_SIZE + 5 + 1);
+	memcpy(raw + 4, cmd->data, cmd->length);
 	create_task(Dump_task, (const signed char * const)"Dump_Task", (unsigned short)(STACK_DUMP_SIZE), (void*)raw, (unsigned portBASE_TYPE)(configMAX_PRIORITIES - 2), xDumpHandle);
 }
-void cmd_delete_TM(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_dump_resend(TC_spl* cmd)
+{
+	//dump id, the sequence number of the first frame in the bitmap and the bitmap of the missing frames
+	if (cmd->length < 4 + 1 || cmd->length > 4 + DUMP_RESEND_MAX_BITMAP)
+	{
+		save_ACK(ACK_DUMP, ERR_PARAMETERS, cmd->id);
+		return;
+	}
+	//1. build combine data with command_id and the length of the bitmap
+	unsigned char raw[4 + 1 + 4 + DUMP_RESEND_MAX_BITMAP] = {0};
+	BigEnE_uInt_to_raw(cmd->id, &raw[0]);
+	raw[4] = (unsigned char)(cmd->length - 4);
+	memcpy(raw + 5, cmd->data, cmd->length);
+	create_task(Dump_resend_task, (const signed char * const)"Dump_Resend_Task", (unsigned short)(STACK_DUMP_SIZE), (void*)raw, (unsigned portBASE_TYPE)(configMAX_PRIORITIES - 2), xDumpHandle);
+}
+void cmd_delete_TM(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_MEMORY;
-	if (cmd.length != 13)
+	if (cmd->length != 13)
 	{
 		*err = ERR_PARAMETERS;
 		return;
 	}
 
-	time_unix start_time = BigEnE_raw_to_uInt(&cmd.data[0]);
-	time_unix end_time = BigEnE_raw_to_uInt(&cmd.data[4]);
+	time_unix start_time = BigEnE_raw_to_uInt(&cmd->data[0]);
+	time_unix end_time = BigEnE_raw_to_uInt(&cmd->data[4]);
 	HK_types files[5];
 	for (int i = 0; i < 5; i++)
 	{
-		files[i] = (HK_types)cmd.data[8 + i];
+		files[i] = (HK_types)cmd->data[8 + i];
 	}
 
 	if (start_time > end_time)
@@ -77,8 +95,7 @@ void cmd_delete_TM(Ack_type* type, ERR_type* err, TC_spl cmd)
 		if (files[i] != this_is_not_the_file_you_are_looking_for)
 		{
 			find_fileName(files[i], file_name);
-			//todo: find the function for delete elements
-			//result = c_fileDeleteElements(file_name, start_time, end_time);
+			result = c_fileDeleteElements(file_name, start_time, end_time);
 			if (result != FS_SUCCSESS)
 			{
 				errorRes = FS_FAIL;
@@ -102,11 +119,11 @@ void cmd_delete_TM(Ack_type* type, ERR_type* err, TC_spl cmd)
 		break;
 	}
 }
-void cmd_reset_file(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_reset_file(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_RESET_FILE;
 	*err = ERR_SUCCESS;
-	if (cmd.length != NUM_FILES_IN_DUMP)
+	if (cmd->length != NUM_FILES_IN_DUMP)
 	{
 		*err = ERR_PARAMETERS;
 		return;
@@ -116,10 +133,10 @@ void cmd_reset_file(Ack_type* type, ERR_type* err, TC_spl cmd)
 	FileSystemResult reslt;
 	for (int i = 0; i < NUM_FILES_IN_DUMP; i++)
 	{
-		if ((HK_types)cmd.data[i] == this_is_not_the_file_you_are_looking_for)
+		if ((HK_types)cmd->data[i] == this_is_not_the_file_you_are_looking_for)
 			continue;
 
-		if (find_fileName((HK_types)cmd.data[i], file_name) == 0)
+		if (find_fileName((HK_types)cmd->data[i], file_name) == 0)
 			reslt = c_fileReset(file_name);
 
 		if (reslt != FS_SUCCSESS)
@@ -133,15 +150,15 @@ void cmd_dummy_func(Ack_type* type, ERR_type* err)
 	*err = ERR_SUCCESS;
 }
 
-void cmd_soft_reset_cmponent(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_soft_reset_cmponent(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_SOFT_RESTART;
-	if (cmd.length != 1)
+	if (cmd->length != 1)
 	{
 		*err = ERR_PARAMETERS;
 		return;
 	}
-	int error = soft_reset_subsystem((subSystem_indx)cmd.data);
+	int error = soft_reset_subsystem((subSystem_indx)cmd->data);
 	switch (error)
 	{
 	case 0:
@@ -155,15 +172,15 @@ void cmd_soft_reset_cmponent(Ack_type* type, ERR_type* err, TC_spl cmd)
 		break;
 	}
 }
-void cmd_hard_reset_cmponent(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_hard_reset_cmponent(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_SOFT_RESTART;
-	if (cmd.length != 1)
+	if (cmd->length != 1)
 	{
 		*err = ERR_PARAMETERS;
 		return;
 	}
-	int error = soft_reset_subsystem((subSystem_indx)cmd.data);
+	int error = soft_reset_subsystem((subSystem_indx)cmd->data);
 	switch (error)
 	{
 	case 0:
@@ -211,16 +228,16 @@ void cmd_gracefull_reset_satellite(Ack_type* type, ERR_type* err)
 		break;
 	}
 }
-void cmd_upload_time(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_upload_time(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_UPDATE_TIME;
-	if (cmd.length != TIME_SIZE)
+	if (cmd->length != TIME_SIZE)
 	{
 		*err = ERR_PARAMETERS;
 		return;
 	}
 	// 1. converting to time_unix
-	time_unix new_time = BigEnE_raw_to_uInt(&cmd.data[0]);
+	time_unix new_time = BigEnE_raw_to_uInt(&cmd->data[0]);
 	// 2. update time on satellite
 	if (Time_setUnixEpoch(new_time))
 	{
@@ -234,17 +251,17 @@ void cmd_upload_time(Ack_type* type, ERR_type* err, TC_spl cmd)
 	}
 }
 
-void cmd_ARM_DIARM(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_ARM_DIARM(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_ARM_DISARM;
-	if (cmd.length != 1)
+	if (cmd->length != 1)
 	{
 		*err = ERR_PARAMETERS;
 		return;
 	}
 	int error;
 
-	switch (cmd.data[0])
+	switch (cmd->data[0])
 	{
 	case ARM_ANTS:
 		error = ARM_ants();
@@ -28,16 +28,16 @@ void cmd_reset_APRS_list(Ack_type* type, ERR_type* err)
 	reset_APRS_list(FALSE);
 	*err = ERR_SUCCESS;
 }
-void cmd_reset_FRAM(Ack_type* type, ERR_type* err, TC_spl cmd)
+void cmd_reset_FRAM(Ack_type* type, ERR_type* err, TC_spl* cmd)
 {
 	*type = ACK_FRAM_RESET;
-	if (cmd.length != 1)
+	if (cmd->length != 1)
 	{
 		*err = ERR_PARAMETERS;
 		return;
 	}
 	*err = ERR_SUCCESS;
-	subSystem_indx sub = (subSystem_indx)cmd.data[0];
+	subSystem_indx sub = (subSystem_indx)cmd->data[0];
 	switch (sub)
 	{
 		case EPS:
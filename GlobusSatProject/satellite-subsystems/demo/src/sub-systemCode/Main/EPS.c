@@ -30,6 +30,7 @@
 #include "../Global/Global.h"
 #include "../Global/GlobalParam.h"
 #include "../EPS.h"
+#include "../COMM/Beacon_scheduler.h"
 
 #define CAM_STATE	 0x0F
 #define ADCS_STATE	 0xF0
@@ -179,6 +180,7 @@ void reset_EPS_voltages()
 
 	i_error = FRAM_write((byte*)&comm_voltage, BEACON_LOW_BATTERY_STATE_ADDR, 2);
 	check_int("reset_FRAM_EPS, FRAM_read", i_error);
+	Beacon_params_changed();
 
 	i_error = FRAM_write((byte*)&comm_voltage, TRANS_LOW_BATTERY_STATE_ADDR, 2);
 	check_int("reset_FRAM_EPS, FRAM_read", i_error);
@@ -38,13 +38,32 @@
 #include "HouseKeeping.h"
 
 #include "../COMM/splTypes.h"
+#include "../COMM/Ack_pipeline.h"
 #include "../Global/Global.h"
 #include "../Global/sizes.h"
 #include "../Global/FRAMadress.h"
 #include "../Global/GlobalParam.h"
 #include "../ADCS.h"
 
+//handles of the HK c_files, looked up on their first write
+static int SP_HK_file = C_FILE_INVALID_HANDLE;
+static int EPS_HK_file = C_FILE_INVALID_HANDLE;
+static int CAM_HK_file = C_FILE_INVALID_HANDLE;
+static int COMM_HK_file = C_FILE_INVALID_HANDLE;
+static int ADCS_HK_file = C_FILE_INVALID_HANDLE;
 
+//sizes of the fields of the HK structures, the c_files keep only the fields that changed
+static const unsigned char EPS_HK_fields[] = {2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2, 4,1,1,1};
+static const unsigned char CAM_HK_fields[] = {2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2, 4,4,4,4,4};
+static const unsigned char COMM_HK_fields[] = {2,2,2,2,2,2};
+
+//writes hk to its c_file by handle, without a lookup of the name on every write
+static FileSystemResult write_HK(int *handle, char *c_file_name, void *hk)
+{
+	if (*handle == C_FILE_INVALID_HANDLE)
+		*handle = c_fileOpenHandle(c_file_name);
+	return c_fileWriteByHandle(*handle, hk);
+}
 
 int find_fileName(HK_types type, char *fileName)
 {
@@ -161,13 +180,18 @@ int size_of_element(HK_types type)
 
 int save_ACK(Ack_type type, ERR_type err, command_id ACKcommandId)
 {
-	byte raw_ACK[ACK_DATA_LENGTH];
-	build_data_field_ACK(type, err, ACKcommandId, raw_ACK);
-	FileSystemResult error = c_fileWrite(ACK_FILE_NAME, raw_ACK);
-	if (error != FS_SUCCSESS)
+	//the ACK task saves it with the ACKs posted with it
+	if (post_ACK(type, err, ACKcommandId, ACK_SAVE) != 0)
 	{
-		printf("could not save ACK, error %d", error);
-		//if theres errors
+		//no ACK task or its queue is full, saved here
+		byte raw_ACK[ACK_DATA_LENGTH];
+		build_data_field_ACK(type, err, ACKcommandId, raw_ACK);
+		FileSystemResult error = c_fileWrite(ACK_FILE_NAME, raw_ACK);
+		if (error != FS_SUCCSESS)
+		{
+			printf("could not save ACK, error %d", error);
+			//if theres errors
+		}
 	}
 
 #ifdef TESTING
@@ -324,12 +348,15 @@ int COMM_create_file()
 {
 	int er = c_fileReset(COMM_HK_FILE_NAME);
 	check_int("delete_comm_file, f_delete", er);
-	FileSystemResult error = c_fileCreate(COMM_HK_FILE_NAME, COMM_HK_SIZE);
+	FileSystemResult error = c_fileCreateCompressed(COMM_HK_FILE_NAME, COMM_HK_SIZE,
+			COMM_HK_fields, sizeof(COMM_HK_fields));
 	if (error != FS_SUCCSESS)
 	{
 		printf("ERROR IN CREATING ACK FILE %d\n", error);
 		//error
 	}
+	error = c_fileSetQuota(COMM_HK_FILE_NAME, COMM_HK_QUOTA, COMM_HK_PRIORITY);
+	check_int("COMM_create_file, c_fileSetQuota", error);
 	return 0;
 }
 int ACK_create_file()
@@ -342,29 +369,37 @@ int ACK_create_file()
 		printf("ERROR IN CREATING ACK FILE %d\n", error);
 		//error
 	}
+	error = c_fileSetQuota(ACK_FILE_NAME, ACK_HK_QUOTA, ACK_HK_PRIORITY);
+	check_int("ACK_create_file, c_fileSetQuota", error);
 	return 0;
 }
 int EPS_create_file()
 {
 	int er = c_fileReset(EPS_HK_FILE_NAME);
 	check_int("delete_eps_file, f_delete", er);
-	FileSystemResult error = c_fileCreate(EPS_HK_FILE_NAME, EPS_HK_SIZE);
+	FileSystemResult error = c_fileCreateCompressed(EPS_HK_FILE_NAME, EPS_HK_SIZE,
+			EPS_HK_fields, sizeof(EPS_HK_fields));
 	if (error != FS_SUCCSESS)
 	{
 		printf("ERROR IN CREATING EPS FILE %d\n", error);
 		//error
 	}
+	error = c_fileSetQuota(EPS_HK_FILE_NAME, EPS_HK_QUOTA, EPS_HK_PRIORITY);
+	check_int("EPS_create_file, c_fileSetQuota", error);
 	return 0;
 }
 int CAM_create_file()
 {
 	int er = c_fileReset(CAM_HK_FILE_NAME);
 	check_int("delete_comm_file, f_delete", er);
-	FileSystemResult error = c_fileCreate(CAM_HK_FILE_NAME, CAM_HK_SIZE);
+	FileSystemResult error = c_fileCreateCompressed(CAM_HK_FILE_NAME, CAM_HK_SIZE,
+			CAM_HK_fields, sizeof(CAM_HK_fields));
 	if (error != FS_SUCCSESS)
 	{
 		//error
 	}
+	error = c_fileSetQuota(CAM_HK_FILE_NAME, CAM_HK_QUOTA, CAM_HK_PRIORITY);
+	check_int("CAM_create_file, c_fileSetQuota", error);
 	return 0;
 }
 int ADCS_create_file()
@@ -376,17 +411,24 @@ int ADCS_create_file()
 	{
 		//error
 	}
+	error = c_fileSetQuota(ADCS_HK_FILE_NAME, ADCS_HK_QUOTA, ADCS_HK_PRIORITY);
+	check_int("ADCS_create_file, c_fileSetQuota", error);
 	return 0;
 }
 int SP_create_file()
 {
+	unsigned char SP_HK_fields[NUMBER_OF_SOLAR_PANNELS];
+	memset(SP_HK_fields, FLOAT_SIZE, sizeof(SP_HK_fields));
 	int er = c_fileReset(SP_HK_FILE_NAME);
 	check_int("delete_comm_file, f_delete", er);
-	FileSystemResult error = c_fileCreate(SP_HK_FILE_NAME, SP_HK_SIZE);
+	FileSystemResult error = c_fileCreateCompressed(SP_HK_FILE_NAME, SP_HK_SIZE,
+			SP_HK_fields, sizeof(SP_HK_fields));
 	if (error != FS_SUCCSESS)
 	{
 		//error
 	}
+	error = c_fileSetQuota(SP_HK_FILE_NAME, SP_HK_QUOTA, SP_HK_PRIORITY);
+	check_int("SP_create_file, c_fileSetQuota", error);
 	return 0;
 }
 
@@ -413,11 +455,11 @@ void save_SP_HK()
 	if (error == 0)
 	{
 		// 1.2. save hk in filesystem
-		error = c_fileWrite(SP_HK_FILE_NAME, (void*)(&eps_hk));
+		error = write_HK(&SP_HK_file, SP_HK_FILE_NAME, (void*)(&eps_hk));
 		if (error == FS_NOT_EXIST)
 		{
 			// 1.3. create file if not exist
-			EPS_create_file();
+			SP_create_file();
 		}
 	}
 	else
@@ -435,7 +477,7 @@ void save_EPS_HK()
 	if (error == 0)
 	{
 		// 1.2. save hk in filesystem
-		error = c_fileWrite(EPS_HK_FILE_NAME, (void*)(&eps_hk));
+		error = write_HK(&EPS_HK_file, EPS_HK_FILE_NAME, (void*)(&eps_hk));
 		if (error == FS_NOT_EXIST)
 		{
 			// 1.3. create file if not exist
@@ -459,7 +501,7 @@ void save_CAM_HK()
 		if (error == 0)
 		{
 			// 2.2. save hk in filesystem
-			error = c_fileWrite(CAM_HK_FILE_NAME, (void*)(&cam_hk));
+			error = write_HK(&CAM_HK_file, CAM_HK_FILE_NAME, (void*)(&cam_hk));
 			if (error == FS_NOT_EXIST)
 			{
 				// 2.3. create file if not exist
@@ -482,7 +524,7 @@ void save_COMM_HK()
 	if (error == 0)
 	{
 		// 3.2. save hk in filesystem
-		error = c_fileWrite(COMM_HK_FILE_NAME, (void*)(&comm_hk));
+		error = write_HK(&COMM_HK_file, COMM_HK_FILE_NAME, (void*)(&comm_hk));
 		if (error == FS_NOT_EXIST)
 		{
 			// 3.3. create file if not exist
@@ -506,7 +548,7 @@ void save_ADCS_HK()
 		if (error == 0)
 		{
 			// 3.2. save hk in filesystem
-			error = c_fileWrite(ADCS_HK_FILE_NAME, (void*)(&adcs_hk));
+			error = write_HK(&ADCS_HK_file, ADCS_HK_FILE_NAME, (void*)(&adcs_hk));
 			if (error == FS_NOT_EXIST)
 			{
 				// 3.3. create file if not exist
@@ -619,201 +661,145 @@ int ADCS_SC_raw_BigEnE(byte* raw_in, byte* raw_out)
 }
 
 
-int build_HK_spl_packet(HK_types type, byte *raw_data, TM_spl *packet)
+int build_HK_spl_header(HK_types type, byte *raw_data, TM_spl_header *header)
 {
-	time_unix data_time;
-	memcpy(&data_time, raw_data, sizeof(time_unix));
+	memcpy(&header->time, raw_data, sizeof(time_unix));
 	switch(type)
 	{
 	case ACK_T:
-		packet->type = ACK_TYPE;
-		packet->subType = ACK_ST;
-		packet->length = ACK_DATA_LENGTH;
-		packet->time = data_time;
-		memcpy(packet->data, raw_data + TIME_SIZE, ACK_DATA_LENGTH);
-
+		header->type = ACK_TYPE;
+		header->subType = ACK_ST;
+		header->length = ACK_DATA_LENGTH;
 		break;
 	case EPS_HK_T:
-		packet->type = DUMP_T;
-		packet->subType = EPS_DUMP_ST;
-		packet->length = EPS_HK_SIZE;
-		packet->time = data_time;
-		EPS_HK_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = DUMP_T;
+		header->subType = EPS_DUMP_ST;
+		header->length = EPS_HK_SIZE;
 		break;
 	case CAMERA_HK_T:
-		packet->type = DUMP_T;
-		packet->subType = CAM_DUMP_ST;
-		packet->length = CAM_HK_SIZE;
-		packet->time = data_time;
-		CAM_HK_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = DUMP_T;
+		header->subType = CAM_DUMP_ST;
+		header->length = CAM_HK_SIZE;
 		break;
 	case COMM_HK_T:
-		packet->type = DUMP_T;
-		packet->subType = COMM_DUMP_ST;
-		packet->length = COMM_HK_SIZE;
-		packet->time = data_time;
-		COMM_HK_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = DUMP_T;
+		header->subType = COMM_DUMP_ST;
+		header->length = COMM_HK_SIZE;
 		break;
 	case ADCS_HK_T:
-		packet->type = DUMP_T;
-		packet->subType = ADCS_DUMP_ST;
-		packet->length = ADCS_HK_SIZE;
-		packet->time = data_time;
-		ADCS_HK_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = DUMP_T;
+		header->subType = ADCS_DUMP_ST;
+		header->length = ADCS_HK_SIZE;
 		break;
 	case SP_HK_T:
-		packet->type = DUMP_T;
-		packet->subType = SP_DUMP_ST;
-		packet->length = SP_HK_SIZE;
-		packet->time = data_time;
-		ADCS_HK_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = DUMP_T;
+		header->subType = SP_DUMP_ST;
+		header->length = SP_HK_SIZE;
 		break;
 	case ADCS_CSS_DATA_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_CSS_DATA_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_CSS_DATA_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_Magnetic_filed_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_MAGNETIC_FILED_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_MAGNETIC_FILED_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_CSS_sun_vector_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_CSS_SUN_VECTOR_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_CSS_SUN_VECTOR_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_wheel_speed_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_WHEEL_SPEED_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_WHEEL_SPEED_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_sensore_rate_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_SENSORE_RATE_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_SENSORE_RATE_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_MAG_CMD_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_MAG_CMD_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_MAG_CMD_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_wheel_CMD_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_WHEEL_CMD_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_WHEEL_CMD_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_Mag_raw_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_MAG_RAW_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_MAG_RAW_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_IGRF_MODEL_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_IGRF_MODEL_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_IGRF_MODEL_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_Gyro_BIAS_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_GYRO_BIAS_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_GYRO_BIAS_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_Inno_Vextor_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_INNO_VEXTOR_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_INNO_VEXTOR_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_Error_Vec_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_ERROR_VEC_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_ERROR_VEC_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_QUATERNION_COVARIANCE_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_QUATERNION_COVARIANCE_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_QUATERNION_COVARIANCE_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_ANGULAR_RATE_COVARIANCE_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_ANGULAR_RATE_COVARIANCE_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_ANGULAR_RATE_COVARIANCE_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_ESTIMATED_ANGLES_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_ESTIMATED_ANGLES_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_ESTIMATED_ANGLES_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_Estimated_AR_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_ESTIMATED_AR_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_ESTIMATED_AR_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_ECI_POS_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_ECI_POS_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_ECI_POS_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_SAV_Vel_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_SAV_VEL_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_SAV_VEL_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_ECEF_POS_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_ECEF_POS_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_ECEF_POS_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_LLH_POS_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_LLH_POS_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_LLH_POS_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	case ADCS_EST_QUATERNION_T:
-		packet->type = ADCS_SC_ST;
-		packet->subType = ADCS_EST_QUATERNION_ST;
-		packet->length = ADCS_SC_SIZE;
-		packet->time = data_time;
-		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), packet->data);
+		header->type = ADCS_SC_ST;
+		header->subType = ADCS_EST_QUATERNION_ST;
+		header->length = ADCS_SC_SIZE;
 		break;
 	default:
 		return -1;
@@ -822,6 +808,68 @@ int build_HK_spl_packet(HK_types type, byte *raw_data, TM_spl *packet)
 	return 0;
 }
 
+int build_HK_spl_data(HK_types type, byte *raw_data, byte *data_out)
+{
+	switch(type)
+	{
+	case ACK_T:
+		memcpy(data_out, raw_data + TIME_SIZE, ACK_DATA_LENGTH);
+		break;
+	case EPS_HK_T:
+		EPS_HK_raw_BigEnE((raw_data + TIME_SIZE), data_out);
+		break;
+	case CAMERA_HK_T:
+		CAM_HK_raw_BigEnE((raw_data + TIME_SIZE), data_out);
+		break;
+	case COMM_HK_T:
+		COMM_HK_raw_BigEnE((raw_data + TIME_SIZE), data_out);
+		break;
+	case ADCS_HK_T:
+	case SP_HK_T:
+		ADCS_HK_raw_BigEnE((raw_data + TIME_SIZE), data_out);
+		break;
+	case ADCS_CSS_DATA_T:
+	case ADCS_Magnetic_filed_T:
+	case ADCS_CSS_sun_vector_T:
+	case ADCS_wheel_speed_T:
+	case ADCS_sensore_rate_T:
+	case ADCS_MAG_CMD_T:
+	case ADCS_wheel_CMD_T:
+	case ADCS_Mag_raw_T:
+	case ADCS_IGRF_MODEL_T:
+	case ADCS_Gyro_BIAS_T:
+	case ADCS_Inno_Vextor_T:
+	case ADCS_Error_Vec_T:
+	case ADCS_QUATERNION_COVARIANCE_T:
+	case ADCS_ANGULAR_RATE_COVARIANCE_T:
+	case ADCS_ESTIMATED_ANGLES_T:
+	case ADCS_Estimated_AR_T:
+	case ADCS_ECI_POS_T:
+	case ADCS_SAV_Vel_T:
+	case ADCS_ECEF_POS_T:
+	case ADCS_LLH_POS_T:
+	case ADCS_EST_QUATERNION_T:
+		ADCS_SC_raw_BigEnE((raw_data + TIME_SIZE), data_out);
+		break;
+	default:
+		return -1;
+		break;
+	}
+	return 0;
+}
+
+int build_HK_spl_packet(HK_types type, byte *raw_data, TM_spl *packet)
+{
+	TM_spl_header header;
+	if (build_HK_spl_header(type, raw_data, &header) != 0)
+		return -1;
+	packet->type = header.type;
+	packet->subType = header.subType;
+	packet->length = header.length;
+	packet->time = header.time;
+	return build_HK_spl_data(type, raw_data, packet->data);
+}
+
 
 void HouseKeeping_highRate_Task()
 {
@@ -841,6 +889,7 @@ void HouseKeeping_highRate_Task()
 
 			//save_ADCS_HK();
 		}
+		c_fileFlushExpired();
 
 		vTaskDelayUntil(&xLastWakeTime, xFrequency);
 	}
@@ -857,6 +906,8 @@ void HouseKeeping_lowRate_Task()
 		{
 			save_SP_HK();
 		}
+		//deletes at most a file per c_file, the SD never fills under the writes
+		c_fileRetention();
 
 		vTaskDelayUntil(&xLastWakeTime, xFrequency);
 	}
@@ -26,6 +26,21 @@
 #define COMM_HK_SIZE 12
 #define ADCS_HK_SIZE 34
 
+//SD quotas of the HK c_files, a c_file can't pass C_FILE_MAX_NUM_OF_FILES * C_FILE_MAX_FILE_SIZE anyway
+#define ACK_HK_QUOTA	(4*1024*1024)
+#define EPS_HK_QUOTA	(24*1024*1024)
+#define SP_HK_QUOTA		(8*1024*1024)
+#define CAM_HK_QUOTA	(8*1024*1024)
+#define COMM_HK_QUOTA	(8*1024*1024)
+#define ADCS_HK_QUOTA	(24*1024*1024)
+//c_files with a lower priority lose their oldest files first when the SD is full
+#define ACK_HK_PRIORITY		1
+#define EPS_HK_PRIORITY		3
+#define SP_HK_PRIORITY		1
+#define CAM_HK_PRIORITY		2
+#define COMM_HK_PRIORITY	2
+#define ADCS_HK_PRIORITY	3
+
 #define ADCS_SC_SIZE 6
 
 #define ACK_FILE_NAME "ACKf"
@@ -160,6 +175,26 @@ int save_HK();
 
 int build_HK_spl_packet(HK_types type, byte *raw_data, TM_spl *packet);
 
+/**
+ * @brief		the spl header of an HK element, without converting its data
+ * @param[in]	raw_data the element as saved in its file, time first
+ * @return		0 on success, -1 unknown type
+ */
+int build_HK_spl_header(HK_types type, byte *raw_data, TM_spl_header *header);
+
+/**
+ * @brief		converts the data of an HK element to the spl data, straight into data_out
+ * @param[in]	raw_data the element as saved in its file, time first
+ * @param[out]	data_out the data of the packet, SPL_TM_DATA of a frame
+ * @return		0 on success, -1 unknown type
+ */
+int build_HK_spl_data(HK_types type, byte *raw_data, byte *data_out);
+
+/**
+ * @brief		saves an ACK to ACK_FILE_NAME
+ * @note		posted to the ACK task, saved before returning only if the ACK task can't take it
+ * @return		0
+ */
 int save_ACK(Ack_type type, ERR_type err, command_id ACKcommandId);
 
 int find_fileName(HK_types type, char *fileName);
@@ -56,109 +56,65 @@
  * 3. change the way commands pass throw tasks
  */
 
-xSemaphoreHandle xCTE = NULL;
+//single core, the slot is written before the index that hands it over moves
+#define COMMAND_BARRIER() __asm__ __volatile__("" ::: "memory")
 
-TC_spl command_to_execute[COMMAND_LIST_SIZE];
-int place_in_list = 0;
+//a ring of commands to execute, the TRXVU task adds them and the main task executes them.
+//each index is moved by one task only, so no semaphore. the indices run over twice the size,
+//a full ring and an empty one are told apart
+static TC_spl command_to_execute[COMMAND_LIST_SIZE];
+static volatile unsigned int command_head = 0;//the next command to execute, moved by the main task
+static volatile unsigned int command_tail = 0;//the next free slot, moved by the TRXVU task
 
-
-void copy_command(TC_spl source, TC_spl* to)
-{
-	// copy command from source to to
-	to->id = source.id;
-	to->type = source.type;
-	to->subType = source.subType;
-	to->length = source.length;
-	to->time = source.time;
-	memcpy(to->data, source.data, (int)source.length);
-}
-void reset_command(TC_spl *command)
+static unsigned int number_commands()
 {
-	// set to 0 all parameters of command
-	memset((void*)command, 0, SIZE_OF_COMMAND);
+	return (command_tail + 2 * COMMAND_LIST_SIZE - command_head) % (2 * COMMAND_LIST_SIZE);
 }
 
 //todo: change name to more sugnifficent
 int init_command()
 {
-	if (xCTE != NULL)
-		return 1;
-	// 1. create semaphore
-	vSemaphoreCreateBinary(xCTE);
-	// 2. set place in list to 0
-	place_in_list = 0;
-	// 3. allocate memory for data in command
-	int i;
-	for (i = 0; i < COMMAND_LIST_SIZE; i++)
-	{
-		reset_command(&command_to_execute[i]);
-	}
+	command_head = 0;
+	command_tail = 0;
 	return 0;
 }
-int add_command(TC_spl command)
+
+TC_spl* reserve_command()
 {
-	portBASE_TYPE error;
-	// 1. try to take semaphore
-	if (xSemaphoreTake(xCTE, MAX_DELAY) == pdTRUE)
-	{
-		// 2. if queue full
-		if (place_in_list == COMMAND_LIST_SIZE)
-		{
-			error = xSemaphoreGive(xCTE);
-			check_portBASE_TYPE("could not return xCTE in add_command", error);
-			return 1;
-		}
-		// 3. copy command to list
-		copy_command(command, &command_to_execute[place_in_list]);
-		// 4. moving forward current place in command queue
-		place_in_list++;
-		// 5. return semaphore
-		error = xSemaphoreGive(xCTE);
-		check_portBASE_TYPE("cold not return xCTE in add_command", error);
-	}
+	if (number_commands() == COMMAND_LIST_SIZE)
+		return NULL;
+	return &command_to_execute[command_tail % COMMAND_LIST_SIZE];
+}
 
-	return 0;
+void commit_command()
+{
+	COMMAND_BARRIER();
+	command_tail = (command_tail + 1) % (2 * COMMAND_LIST_SIZE);
 }
-int get_command(TC_spl* command)
+
+TC_spl* peek_command()
 {
-	portBASE_TYPE error;
-	// 1. try to take semaphore
-	if (xSemaphoreTake(xCTE, MAX_DELAY) == pdTRUE)
-	{
-		// 2. check if there's commands in list
-		if (place_in_list == 0)
-		{
-			error = xSemaphoreGive(xCTE);
-			check_portBASE_TYPE("get_command, xSemaphoreGive(xCTE)", error);
-			return 1;
-		}
-		// 3. copy first in command to TC_spl* command
-		copy_command(command_to_execute[0], command);
-		int i;
-		// 4. move every command forward in queue
-		for (i = 0; i < place_in_list - 1; i++)
-		{
-			reset_command(&command_to_execute[i]);
-			copy_command(command_to_execute[i + 1], &command_to_execute[i]);
-		}
-		// 5. reset the last place for command
-		reset_command(&command_to_execute[i]);
-		place_in_list--;
-		// 6. return semaphore
-		error = xSemaphoreGive(xCTE);
-		check_portBASE_TYPE("get_command, xSemaphoreGive(xCTE)", error);
-	}
-	return 0;
+	if (number_commands() == 0)
+		return NULL;
+	COMMAND_BARRIER();
+	return &command_to_execute[command_head % COMMAND_LIST_SIZE];
+}
+
+void release_command()
+{
+	COMMAND_BARRIER();
+	command_head = (command_head + 1) % (2 * COMMAND_LIST_SIZE);
 }
+
 int check_number_commands()
 {
-	return place_in_list;
+	return (int)number_commands();
 }
 
-void act_upon_command(TC_spl decode)
+void act_upon_command(TC_spl* decode)
 {
 	//later use in ACK
-	switch (decode.type)
+	switch (decode->type)
 	{
 	case (COMM_T):
 		AUC_COMM(decode);
@@ -185,17 +141,17 @@ void act_upon_command(TC_spl decode)
 		AUC_special_operation(decode);
 		break;
 	default:
-		printf("wrong type: %d\n", decode.type);
+		printf("wrong type: %d\n", decode->type);
 		break;
 	}
 }
 
 
-void AUC_COMM(TC_spl decode)
+void AUC_COMM(TC_spl* decode)
 {
 	Ack_type type;
 	ERR_type err;
-	switch (decode.subType)
+	switch (decode->subType)
 	{
 	case (MUTE_ST):
 		cmd_mute(&type, &err, decode);
@@ -228,16 +184,16 @@ void AUC_COMM(TC_spl decode)
 	}
 	//Builds ACK
 #ifndef NOT_USE_ACK_HK
-	save_ACK(type, err, decode.id);
+	save_ACK(type, err, decode->id);
 #endif
 }
 
-void AUC_general(TC_spl decode)
+void AUC_general(TC_spl* decode)
 {
 	Ack_type type;
 	ERR_type err;
 
-	switch (decode.subType)
+	switch (decode->subType)
 	{
 	case (SOFT_RESET_ST):
 		cmd_soft_reset_cmponent(&type, &err, decode);
@@ -260,16 +216,16 @@ void AUC_general(TC_spl decode)
 	}
 	//Builds ACK
 #ifndef NOT_USE_ACK_HK
-	save_ACK(type, err, decode.id);
+	save_ACK(type, err, decode->id);
 #endif
 }
 
-void AUC_payload(TC_spl decode)
+void AUC_payload(TC_spl* decode)
 {
 	Ack_type type;
 	ERR_type err;
 
-	switch (decode.subType)
+	switch (decode->subType)
 	{
 	case (SEND_PIC_CHUNCK_ST):
 		break;
@@ -303,16 +259,16 @@ void AUC_payload(TC_spl decode)
 	}
 	//Builds ACK
 #ifndef NOT_USE_ACK_HK
-	save_ACK(type, err, decode.id);
+	save_ACK(type, err, decode->id);
 #endif
 }
 
-void AUC_EPS(TC_spl decode)
+void AUC_EPS(TC_spl* decode)
 {
 	Ack_type type;
 	ERR_type err;
 
-	switch (decode.subType)
+	switch (decode->subType)
 	{
 	case (UPD_LOGIC_VOLT_ST):
 		cmd_upload_volt_logic(&type, &err, decode);
@@ -341,16 +297,16 @@ void AUC_EPS(TC_spl decode)
 	}
 	//Builds ACK
 #ifndef NOT_USE_ACK_HK
-	save_ACK(type, err, decode.id);
+	save_ACK(type, err, decode->id);
 #endif
 }
 
-void AUC_ADCS(TC_spl decode)
+void AUC_ADCS(TC_spl* decode)
 {
 	Ack_type type;
 	ERR_type err;
 
-	switch (decode.subType)
+	switch (decode->subType)
 	{
 	default:
 		cmd_error(&type, &err);
@@ -358,16 +314,16 @@ void AUC_ADCS(TC_spl decode)
 	}
 	//Builds ACK
 #ifndef NOT_USE_ACK_HK
-	save_ACK(type, err, decode.id);
+	save_ACK(type, err, decode->id);
 #endif
 }
 
-void AUC_GS(TC_spl decode)
+void AUC_GS(TC_spl* decode)
 {
 	Ack_type type;
 	ERR_type err;
 
-	switch (decode.subType)
+	switch (decode->subType)
 	{
 	case (GENERIC_I2C_ST):
 		cmd_generic_I2C(&type, &err, decode);
@@ -376,6 +332,10 @@ void AUC_GS(TC_spl decode)
 		cmd_dump(decode);
 		return;
 		break;
+	case (DUMP_RESEND_ST):
+		cmd_dump_resend(decode);
+		return;
+		break;
 	case (DELETE_PACKETS_ST):
 		cmd_delete_TM(&type, &err, decode);
 		break;
@@ -399,16 +359,16 @@ void AUC_GS(TC_spl decode)
 	}
 	//Builds ACK
 #ifndef NOT_USE_ACK_HK
-	save_ACK(type, err, decode.id);
+	save_ACK(type, err, decode->id);
 #endif
 }
 
-void AUC_SW(TC_spl decode)
+void AUC_SW(TC_spl* decode)
 {
 	Ack_type type;
 	ERR_type err;
 
-	switch (decode.subType)
+	switch (decode->subType)
 	{
 	case (RESET_APRS_LIST_ST):
 		cmd_reset_APRS_list(&type, &err);
@@ -425,16 +385,16 @@ void AUC_SW(TC_spl decode)
 	}
 	//Builds ACK
 #ifndef NOT_USE_ACK_HK
-	save_ACK(type, err, decode.id);
+	save_ACK(type, err, decode->id);
 #endif
 }
 
-void AUC_special_operation(TC_spl decode)
+void AUC_special_operation(TC_spl* decode)
 {
 	Ack_type type;
 	ERR_type err;
 
-	switch (decode.subType)
+	switch (decode->subType)
 	{
 	case DELETE_UNF_CUF_ST:
 		break;
@@ -454,17 +414,17 @@ void AUC_special_operation(TC_spl decode)
 	}
 	//Builds ACK
 #ifndef NOT_USE_ACK_HK
-	save_ACK(type, err, decode.id);
+	save_ACK(type, err, decode->id);
 #endif
 }
 
 #ifdef TESTING
-void AUC_test(TC_spl decode)
+void AUC_test(TC_spl* decode)
 {
 	Ack_type type;
 	ERR_type err;
 
-	switch (decode.subType)
+	switch (decode->subType)
 	{
 	case IMAGE_DUMP_ST:
 
@@ -475,7 +435,7 @@ void AUC_test(TC_spl decode)
 	}
 	//Builds ACK
 #ifndef NOT_USE_ACK_HK
-	save_ACK(type, err, decode.id);
+	save_ACK(type, err, decode->id);
 #endif
 }
 #endif
@@ -32,29 +32,60 @@
 #define COMMAND_LIST_SIZE 20
 
 /**
- *@
+ * @brief		empties the queue of the commands to execute
  */
 int init_command();
-int add_command(TC_spl command);
-int get_command(TC_spl* command);
 
-void act_upon_command(TC_spl decode);
+/**
+ * @brief		the free slot at the end of the command queue, to decode a command into
+ * @note		the TRXVU task adds the commands, the slot joins the queue with commit_command
+ * @return		the slot, NULL if the queue is full
+ */
+TC_spl* reserve_command();
+
+/**
+ * @brief		adds the slot of reserve_command to the end of the command queue
+ */
+void commit_command();
+
+/**
+ * @brief		the first command in the queue, it stays in its slot until release_command
+ * @note		the main task executes the commands
+ * @return		the command, NULL if the queue is empty
+ */
+TC_spl* peek_command();
+
+/**
+ * @brief		takes the command of peek_command out of the queue, its slot is free again
+ */
+void release_command();
+
+/**
+ * @return		the number of commands in the queue
+ */
+int check_number_commands();
+
+/**
+ * @brief		executes a command and saves its ACK
+ * @param[in]	decode the command, in its slot of the queue until release_command
+ */
+void act_upon_command(TC_spl* decode);
 
 
-void AUC_COMM(TC_spl decode);
+void AUC_COMM(TC_spl* decode);
 
-void AUC_general(TC_spl decode);
+void AUC_general(TC_spl* decode);
 
-void AUC_payload(TC_spl decode);
+void AUC_payload(TC_spl* decode);
 
-void AUC_EPS(TC_spl decode);
+void AUC_EPS(TC_spl* decode);
 
-void AUC_ADCS(TC_spl decode);
+void AUC_ADCS(TC_spl* decode);
 
-void AUC_GS(TC_spl decode);
+void AUC_GS(TC_spl* decode);
 
-void AUC_SW(TC_spl decode);
+void AUC_SW(TC_spl* decode);
 
-void AUC_special_operation(TC_spl decode);
+void AUC_special_operation(TC_spl* decode);
 
 #endif /* COMMANDS_H_ */
@@ -17,12 +17,14 @@
 
 #include "Global/Global.h"
 #include "COMM/GSC.h"
+#include "COMM/Tx_scheduler.h"
 #define APRS_ON
 
 #define TRXVU_TO_CALSIGN "GS1"
 #define TRXVU_FROM_CALSIGN "4x4HSL1"
 
 #define VALUE_TX_BUFFER_FULL 0xff
+#define CHECK_TRANSMIT_ABILITY	(get_system_state(Tx_param) && !get_system_state(mute_param) && !get_system_state(transponder_active_param))
 #define NUM_FILES_IN_DUMP	5
 
 #define NOMINAL_MODE TRUE
@@ -43,10 +45,6 @@
 #define MIN_TIME_DELAY_BEACON	1
 #define MAX_TIME_DELAY_BEACON 	40
 
-#define TRANSMMIT_DELAY_9600(length) (length - length)
-//(portTickType)((length + 30) * (5 / 6) + 30)
-#define TRANSMMIT_DELAY_1200(length) (portTickType)(20 * 100)
-
 #define GROUND_PASSING_TIME	(60*10)//todo: find real values
 
 //todo: find real values
@@ -83,6 +81,7 @@ xQueueHandle xDumpQueue;
 xQueueHandle xTransponderQueue;//
 xTaskHandle xDumpHandle;//task handle for dump task
 xTaskHandle xTransponderHandle;//task handle for transponder task
+extern xSemaphoreHandle xIsTransmitting;//mutex on transmission
 
 extern time_unix allow_transponder;
 
@@ -110,10 +109,20 @@ void TRXVU_task();
 
 /**
  * 	@brief 		task function for dump
- * 	@param[in] 	need to be an unsigned char* (size 9 bytes), data of dump command (packet.data)
+ * 	@param[in] 	need to be an unsigned char* (size 20 bytes), id of the dump command and its data (packet.data),
+ * 				byte 18 not 0 to pack the records in PACKED_DUMP_ST packets,
+ * 				byte 19 the repair frames after every FEC_WINDOW_SIZE frames, 0 for none
  */
 void Dump_task(void *arg);
 
+/**
+ * 	@brief 		task function for the resend of the missing frames of the last dump
+ * 	@param[in] 	need to be an unsigned char*, id of the command (4 bytes), length of the bitmap,
+ * 				dump id (2 bytes), sequence number of the first frame in the bitmap (2 bytes) and
+ * 				the bitmap of the missing frames, up to DUMP_RESEND_MAX_BITMAP bytes
+ */
+void Dump_resend_task(void *arg);
+
 
 /**
  * 	@brief		task function for transponde mode
@@ -163,11 +172,13 @@ void lookForRequestToDelete_dump(command_id cmdID);
 void lookForRequestToDelete_transponder(command_id cmdID);
 
 /**
- * @brief		sends data as an AX.25 frame
+ * @brief		sends data as an AX.25 frame, with the frames waiting in the Tx queue
  * @param[in]	data to send, can't be over
  * @param[in]	length of data to send as an AX.25 frame
+ * @param[in]	priority the queue of the frame, its deadline is the deadline of the queue
+ * @return		0 on success, the errors of Tx_schedule_frame and Tx_flush_frames otherwise
  */
-int TRX_sendFrame(byte* data, uint8_t length, ISIStrxvuBitrate bitRate);
+int TRX_sendFrame(byte* data, uint8_t length, ISIStrxvuBitrate bitRate, tx_priority priority);
 
 /**
  * @brief		gets data from Rx buffer